@@ -0,0 +1,186 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// Decides whether a conversation belongs to a conversation list.
+///
+/// The predicates used by the conversation list directory are fixed, so instead of evaluating
+/// them through KVC for every change we compile them into closures reading the properties directly.
+/// The `predicate` is kept around for debug descriptions and must stay in sync with the closure.
+
+@objcMembers
+public final class ConversationListFilter: NSObject {
+
+    public let predicate: NSPredicate
+    private let matcher: (ZMConversation) -> Bool
+
+    init(predicate: NSPredicate, matcher: @escaping (ZMConversation) -> Bool) {
+        self.predicate = predicate
+        self.matcher = matcher
+        super.init()
+    }
+
+    /// Creates a filter which evaluates the given predicate, use this for predicates which have no compiled equivalent.
+    public convenience init(predicate: NSPredicate) {
+        self.init(predicate: predicate, matcher: { predicate.evaluate(with: $0) })
+    }
+
+    public func matches(_ conversation: ZMConversation) -> Bool {
+        return matcher(conversation)
+    }
+
+    public func filter(_ conversations: [ZMConversation]) -> [ZMConversation] {
+        return conversations.filter(matcher)
+    }
+
+    public override var description: String {
+        return predicate.description
+    }
+
+}
+
+// MARK: - Directory filters
+
+extension ConversationListFilter {
+
+    public static func conversationsExcludingArchived() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForConversationsExcludingArchived(),
+                                      matcher: { $0.isIncludedExcludingArchived })
+    }
+
+    public static func archivedConversations() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForArchivedConversations(),
+                                      matcher: { $0.isIncludedIncludingArchived && $0.internalIsArchived })
+    }
+
+    public static func conversationsIncludingArchived() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForConversationsIncludingArchived(),
+                                      matcher: { $0.isIncludedIncludingArchived })
+    }
+
+    public static func pendingConversations() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForPendingConversations(), matcher: { conversation in
+            let conversationType = conversation.conversationType
+            return conversationType.isListable &&
+                   conversationType == .connection &&
+                   conversation.connection?.status == .pending
+        })
+    }
+
+    public static func clearedConversations() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForClearedConversations(), matcher: { conversation in
+            return conversation.clearedTimeStamp != nil &&
+                   conversation.internalIsArchived &&
+                   conversation.isValidForConversationList(conversation.conversationType)
+        })
+    }
+
+    public static func oneToOneConversations() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForOneToOneConversations(), matcher: { conversation in
+            let conversationType = conversation.conversationType
+            let isOneToOne = conversationType == .oneOnOne ||
+                             conversationType == .connection ||
+                             conversation.isTeamOneToOne(conversationType)
+
+            return isOneToOne &&
+                   !conversation.isInFolder &&
+                   conversation.isIncludedExcludingArchived
+        })
+    }
+
+    public static func groupConversations() -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForGroupConversations(), matcher: { conversation in
+            let conversationType = conversation.conversationType
+
+            return conversationType == .group &&
+                   !conversation.isInFolder &&
+                   !conversation.isTeamOneToOne(conversationType) &&
+                   conversation.isIncludedExcludingArchived
+        })
+    }
+
+    @objc(labeledConversations:)
+    public static func labeledConversations(_ label: Label) -> ConversationListFilter {
+        return ConversationListFilter(predicate: ZMConversation.predicateForLabeledConversations(label), matcher: { conversation in
+            return conversation.labels.contains(label) && conversation.isIncludedExcludingArchived
+        })
+    }
+
+}
+
+// MARK: - Compiled predicates
+
+// Each of the following mirrors the predicate of the same name in `ZMConversation+Predicates.swift`.
+
+private extension ZMConversationType {
+
+    /// `predicateForFilteringResults`
+    var isListable: Bool {
+        return self != .invalid && self != ZMConversationType(rawValue: 1)!
+    }
+
+}
+
+private extension ZMConversation {
+
+    /// `predicateForConversationsExcludingArchived`
+    var isIncludedExcludingArchived: Bool {
+        return !internalIsArchived && isIncludedIncludingArchived
+    }
+
+    /// `predicateForConversationsIncludingArchived`
+    var isIncludedIncludingArchived: Bool {
+        let isNotCleared: Bool
+
+        if let clearedTimeStamp = clearedTimeStamp, let lastServerTimeStamp = lastServerTimeStamp {
+            isNotCleared = lastServerTimeStamp > clearedTimeStamp || (lastServerTimeStamp == clearedTimeStamp && !internalIsArchived)
+        } else {
+            isNotCleared = clearedTimeStamp == nil
+        }
+
+        return isNotCleared && isValidForConversationList(conversationType)
+    }
+
+    /// `predicateForValidConversations`
+    func isValidForConversationList(_ conversationType: ZMConversationType) -> Bool {
+        guard conversationType.isListable else { return false }
+
+        guard let status = connection?.status else { return true }
+
+        if conversationType == .connection && [.pending, .ignored, .cancelled].contains(status) {
+            return false
+        }
+
+        return status != .blocked && status != .blockedMissingLegalholdConsent
+    }
+
+    /// `predicateForConversationsInFolders`
+    var isInFolder: Bool {
+        return labels.contains { $0.type == Label.Kind.folder.rawValue }
+    }
+
+    /// `predicateForTeamOneToOneConversation`
+    func isTeamOneToOne(_ conversationType: ZMConversationType) -> Bool {
+        return conversationType == .group &&
+               team != nil &&
+               userDefinedName == nil &&
+               participantRoles.count == 2
+    }
+
+}
@@ -0,0 +1,205 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+private let zmLog = ZMSLog(tag: "ConversationListWarmStart")
+
+/// A compact copy of the first conversations of each list in the conversation list directory,
+/// with just enough information to render them.
+///
+/// The snapshot is persisted after the lists change and read back at launch, so the conversation
+/// list can be displayed before the directory has fetched and faulted all conversations.
+
+public struct ConversationListWarmStartSnapshot: Codable, Equatable {
+
+    public struct Conversation: Codable, Equatable {
+        /// The URI representation of the conversation's object ID.
+        public let objectIDURI: String
+        public let displayName: String
+        public let conversationListIndicator: Int16
+        public let mutedMessageTypes: Int32
+        public let estimatedUnreadCount: Int
+        public let estimatedUnreadSelfMentionCount: Int
+        public let estimatedUnreadSelfReplyCount: Int
+    }
+
+    /// The number of conversations kept per list, enough to fill the first screens of the list.
+    public static let maximumConversationsPerList = 100
+
+    /// Conversations referenced by the lists, each conversation is only stored once.
+    public let conversations: [Conversation]
+
+    /// Ordered indices into `conversations` by `ZMConversationList.identifier`.
+    public let lists: [String: [Int]]
+
+    /// Returns the conversations of the list with the given identifier, in list order.
+    public func conversations(inList identifier: String) -> [Conversation] {
+        return lists[identifier]?.compactMap { conversations.indices.contains($0) ? conversations[$0] : nil } ?? []
+    }
+
+}
+
+extension ConversationListWarmStartSnapshot {
+
+    init(directory: ZMConversationListDirectory, maximumConversationsPerList: Int = ConversationListWarmStartSnapshot.maximumConversationsPerList) {
+        var conversations: [Conversation] = []
+        var indexByObjectID: [NSManagedObjectID: Int] = [:]
+        var lists: [String: [Int]] = [:]
+
+        let allLists = directory.allConversationLists() + Array(directory.listsByFolder.values)
+
+        for list in allLists {
+            lists[list.identifier] = (list as Array).prefix(maximumConversationsPerList).compactMap { element in
+                guard let conversation = element as? ZMConversation, !conversation.objectID.isTemporaryID else { return nil }
+
+                if let index = indexByObjectID[conversation.objectID] {
+                    return index
+                }
+
+                let index = conversations.count
+                conversations.append(Conversation(conversation))
+                indexByObjectID[conversation.objectID] = index
+                return index
+            }
+        }
+
+        self.init(conversations: conversations, lists: lists)
+    }
+
+    static func read(from url: URL) -> ConversationListWarmStartSnapshot? {
+        guard FileManager.default.fileExists(atPath: url.path) else { return nil }
+
+        do {
+            let data = try Data(contentsOf: url)
+            return try PropertyListDecoder().decode(ConversationListWarmStartSnapshot.self, from: data)
+        } catch {
+            zmLog.warn("Failed to read conversation list snapshot: \(error)")
+            return nil
+        }
+    }
+
+    func write(to url: URL) throws {
+        let encoder = PropertyListEncoder()
+        encoder.outputFormat = .binary
+        let data = try encoder.encode(self)
+        try data.write(to: url, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+    }
+
+}
+
+private extension ConversationListWarmStartSnapshot.Conversation {
+
+    init(_ conversation: ZMConversation) {
+        self.init(objectIDURI: conversation.objectID.uriRepresentation().absoluteString,
+                  displayName: conversation.displayName,
+                  conversationListIndicator: conversation.conversationListIndicator.rawValue,
+                  mutedMessageTypes: conversation.mutedMessageTypes.rawValue,
+                  estimatedUnreadCount: Int(conversation.estimatedUnreadCount),
+                  estimatedUnreadSelfMentionCount: Int(conversation.estimatedUnreadSelfMentionCount),
+                  estimatedUnreadSelfReplyCount: Int(conversation.estimatedUnreadSelfReplyCount))
+    }
+
+}
+
+// MARK: - Store
+
+extension NSManagedObjectContext {
+
+    static let ConversationListWarmStartStoreKey = "ConversationListWarmStartStoreKey"
+
+    /// The warm-start store of the conversation lists, only set up for the UI context of a persistent store.
+    public var conversationListWarmStartStore: ConversationListWarmStartStore? {
+        return userInfo[NSManagedObjectContext.ConversationListWarmStartStoreKey] as? ConversationListWarmStartStore
+    }
+
+    func setupConversationListWarmStart(accountDirectory: URL) {
+        let fileURL = accountDirectory.appendingPathComponent("conversation-lists.snapshot")
+        userInfo[NSManagedObjectContext.ConversationListWarmStartStoreKey] = ConversationListWarmStartStore(fileURL: fileURL, managedObjectContext: self)
+    }
+
+}
+
+/// Loads the persisted conversation list snapshot at launch and keeps it up to date afterwards.
+///
+/// Until `reconcile()` has built the live conversation lists, `snapshot` is the one persisted by the
+/// previous session. After that it's replaced by a snapshot of the live lists when they change, at most
+/// once per `writeDelay`. Only the snapshot is taken on the context's queue, it's encoded and written on
+/// `writeQueue`.
+
+public final class ConversationListWarmStartStore: NSObject {
+
+    public let fileURL: URL
+    public private(set) var snapshot: ConversationListWarmStartSnapshot?
+    public private(set) var isReconciled = false
+
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var isWriteScheduled = false
+
+    /// How long the changes of the lists are collected before a new snapshot is written.
+    var writeDelay: TimeInterval = 2
+    let writeQueue = DispatchQueue(label: "ConversationListWarmStartStore", qos: .utility)
+
+    init(fileURL: URL, managedObjectContext: NSManagedObjectContext) {
+        self.fileURL = fileURL
+        self.managedObjectContext = managedObjectContext
+        self.snapshot = ConversationListWarmStartSnapshot.read(from: fileURL)
+        super.init()
+    }
+
+    /// Builds the live conversation lists and replaces the persisted snapshot with them.
+    public func reconcile() {
+        guard let moc = managedObjectContext else { return }
+
+        _ = moc.conversationListDirectory()
+        isReconciled = true
+        write()
+    }
+
+    /// Writes a new snapshot after `writeDelay`, the calls made in the meantime are coalesced.
+    func setNeedsWrite() {
+        guard isReconciled, !isWriteScheduled, managedObjectContext != nil else { return }
+
+        isWriteScheduled = true
+        writeQueue.asyncAfter(deadline: .now() + writeDelay) { [weak self] in
+            self?.managedObjectContext?.performGroupedBlock {
+                self?.isWriteScheduled = false
+                self?.write()
+            }
+        }
+    }
+
+    private func write() {
+        guard let moc = managedObjectContext else { return }
+
+        let snapshot = ConversationListWarmStartSnapshot(directory: moc.conversationListDirectory())
+        guard snapshot != self.snapshot else { return }
+
+        self.snapshot = snapshot
+        let fileURL = self.fileURL
+
+        writeQueue.async {
+            do {
+                try snapshot.write(to: fileURL)
+            } catch {
+                zmLog.warn("Failed to write conversation list snapshot: \(error)")
+            }
+        }
+    }
+
+}
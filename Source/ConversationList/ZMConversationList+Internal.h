@@ -23,6 +23,7 @@
 @class NSManagedObjectContext;
 @class NSFetchRequest;
 @class ZMConversation;
+@class ConversationListFilter;
 
 
 @interface ZMConversationList ()
@@ -37,6 +38,17 @@
 - (instancetype)initWithAllConversations:(NSArray *)conversations
                       filteringPredicate:(NSPredicate *)filteringPredicate
                                      moc:(NSManagedObjectContext *)moc
+                             description:(NSString *)description
+                                   label:(Label *)label;
+
+- (instancetype)initWithAllConversations:(NSArray *)conversations
+                                  filter:(ConversationListFilter *)filter
+                                     moc:(NSManagedObjectContext *)moc
+                             description:(NSString *)description;
+
+- (instancetype)initWithAllConversations:(NSArray *)conversations
+                                  filter:(ConversationListFilter *)filter
+                                     moc:(NSManagedObjectContext *)moc
                              description:(NSString *)description
                                    label:(Label *)label NS_DESIGNATED_INITIALIZER;
 
@@ -31,7 +31,7 @@
 @property (nonatomic, weak) NSManagedObjectContext* moc;
 @property (nonatomic) NSMutableArray *backingList;
 @property (nonatomic, readonly) NSSet *conversationKeysAffectingSorting;
-@property (nonatomic) NSPredicate *filteringPredicate;
+@property (nonatomic) ConversationListFilter *filter;
 @property (nonatomic) NSArray *sortDescriptors;
 @property (nonatomic, copy) NSString *customDebugDescription;
 @property (nonatomic) Label *label;
@@ -80,6 +80,27 @@
                                      moc:(NSManagedObjectContext *)moc
                              description:(NSString *)description
                                    label:(Label *)label
+{
+    return [self initWithAllConversations:conversations
+                                   filter:[[ConversationListFilter alloc] initWithPredicate:filteringPredicate]
+                                      moc:moc
+                              description:description
+                                    label:label];
+}
+
+- (instancetype)initWithAllConversations:(NSArray *)conversations
+                                  filter:(ConversationListFilter *)filter
+                                     moc:(NSManagedObjectContext *)moc
+                             description:(NSString *)description
+{
+    return [self initWithAllConversations:conversations filter:filter moc:moc description:description label:NULL];
+}
+
+- (instancetype)initWithAllConversations:(NSArray *)conversations
+                                  filter:(ConversationListFilter *)filter
+                                     moc:(NSManagedObjectContext *)moc
+                             description:(NSString *)description
+                                   label:(Label *)label
 {
     self = [super init];
     if (self) {
@@ -87,7 +108,7 @@
         _label = label;
         _identifier = description;
         self.customDebugDescription = self.identifier;
-        self.filteringPredicate = filteringPredicate;
+        self.filter = filter;
         self.sortDescriptors = [ZMConversation defaultSortDescriptors];
         [self calculateKeysAffectingPredicateAndSort];
         [self createBackingList:conversations];
@@ -121,7 +142,7 @@
 
 - (void)createBackingList:(NSArray *)conversations
 {
-    NSArray *filtered = [conversations filteredArrayUsingPredicate:self.filteringPredicate];
+    NSArray *filtered = [self.filter filter:conversations];
     self.backingList = [[filtered sortedArrayUsingDescriptors:[ZMConversation defaultSortDescriptors]] mutableCopy];
 }
 
@@ -175,7 +196,7 @@
 
 - (NSString *)shortDescription
 {
-    return [NSString stringWithFormat:@"<%@: %p> %@ (predicate: %@)", self.class, self, self.customDebugDescription, self.filteringPredicate];
+    return [NSString stringWithFormat:@"<%@: %p> %@ (predicate: %@)", self.class, self, self.customDebugDescription, self.filter.predicate];
 }
 
 - (NSString *)description
@@ -196,7 +217,7 @@
 
 - (BOOL)predicateMatchesConversation:(ZMConversation *)conversation;
 {
-    return [self.filteringPredicate evaluateWithObject:conversation];
+    return [self.filter matches:conversation];
 }
 
 - (BOOL)sortingIsAffectedByConversationKeys:(NSSet *)conversationKeys
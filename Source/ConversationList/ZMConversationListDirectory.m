@@ -66,38 +66,38 @@ static NSString * const PendingKey = @"Pending";
         self.listsByFolder = [self createListsFromFolders:allFolders allConversations:allConversations];
 
         self.unarchivedConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                         filteringPredicate:ZMConversation.predicateForConversationsExcludingArchived
+                                                                                     filter:ConversationListFilter.conversationsExcludingArchived
                                                                                         moc:moc
                                                                                 description:@"unarchivedConversations"];
         self.archivedConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                       filteringPredicate:ZMConversation.predicateForArchivedConversations
+                                                                                   filter:ConversationListFilter.archivedConversations
                                                                                       moc:moc
                                                                               description:@"archivedConversations"];
         self.conversationsIncludingArchived = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                                filteringPredicate:ZMConversation.predicateForConversationsIncludingArchived
+                                                                                            filter:ConversationListFilter.conversationsIncludingArchived
                                                                                                moc:moc
                                                                                        description:@"conversationsIncludingArchived"];
         self.pendingConnectionConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                                filteringPredicate:ZMConversation.predicateForPendingConversations
+                                                                                            filter:ConversationListFilter.pendingConversations
                                                                                                moc:moc
                                                                                   description:@"pendingConnectionConversations"];
         self.clearedConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                      filteringPredicate:ZMConversation.predicateForClearedConversations
+                                                                                  filter:ConversationListFilter.clearedConversations
                                                                                      moc:moc
                                                                              description:@"clearedConversations"];
         
         self.oneToOneConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                       filteringPredicate:ZMConversation.predicateForOneToOneConversations
+                                                                                   filter:ConversationListFilter.oneToOneConversations
                                                                                       moc:moc
                                                                               description:@"oneToOneConversations"];
         
         self.groupConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                    filteringPredicate:ZMConversation.predicateForGroupConversations
+                                                                                filter:ConversationListFilter.groupConversations
                                                                                    moc:moc
                                                                            description:@"groupConversations"];
         
         self.favoriteConversations = [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                                                       filteringPredicate:[ZMConversation predicateForLabeledConversations:[Label fetchFavoriteLabelIn:moc]]
+                                                                                   filter:[ConversationListFilter labeledConversations:[Label fetchFavoriteLabelIn:moc]]
                                                                                       moc:moc description:@"favorites"];
     }
     return self;
@@ -136,7 +136,7 @@ static NSString * const PendingKey = @"Pending";
 - (ZMConversationList *)createListForFolder:(Label *)folder allConversations:(NSArray<ZMConversation *> *)allConversations
 {
     return [[ZMConversationList alloc] initWithAllConversations:allConversations
-                                             filteringPredicate:[ZMConversation predicateForLabeledConversations:folder]
+                                                         filter:[ConversationListFilter labeledConversations:folder]
                                                             moc:self.managedObjectContext
                                                     description:folder.objectIDURLString
                                                           label:folder];
@@ -108,6 +108,7 @@ public class CoreDataStack: NSObject, ContextProvider {
     let messagesContainer: PersistentContainer
     let eventsContainer: PersistentContainer
     let dispatchGroup: ZMSDispatchGroup?
+    let isInMemoryStore: Bool
 
     public init(account: Account,
                 applicationContainer: URL,
@@ -121,6 +122,7 @@ public class CoreDataStack: NSObject, ContextProvider {
         self.applicationContainer = applicationContainer
         self.account = account
         self.dispatchGroup = dispatchGroup
+        self.isInMemoryStore = inMemoryStore
 
         let accountDirectory = Self.accountDataFolder(accountIdentifier: account.userIdentifier,
                                                       applicationContainer: applicationContainer)
@@ -284,6 +286,15 @@ public class CoreDataStack: NSObject, ContextProvider {
         context.mergePolicy = NSMergePolicy(merge: .rollbackMergePolicyType)
         ZMUser.selfUser(in: context)
         Label.fetchOrCreateFavoriteLabel(in: context, create: true)
+
+        guard !isInMemoryStore else { return }
+
+        // The UI can render the snapshot persisted by the previous session while
+        // the conversation lists are being built on the next turn of the run loop.
+        context.setupConversationListWarmStart(accountDirectory: accountContainer)
+        context.performGroupedBlock {
+            context.conversationListWarmStartStore?.reconcile()
+        }
     }
 
     func configureContextReferences() {
@@ -305,14 +316,13 @@ public class CoreDataStack: NSObject, ContextProvider {
                                       applicationContainer: applicationContainer)
             context.undoManager = nil
             context.mergePolicy = NSMergePolicy(merge: .mergeByPropertyObjectTrumpMergePolicyType)
-
-            FeatureService(context: context).createDefaultConfigsIfNeeded()
         }
 
         // this will be done async, not to block the UI thread, but
         // enqueued on the syncMOC anyway, so it will execute before
         // any other block of code has a chance to use it
         context.performGroupedBlock {
+            FeatureService(context: context).createDefaultConfigsIfNeeded()
             context.applyPersistedDataPatchesForCurrentVersion()
         }
     }
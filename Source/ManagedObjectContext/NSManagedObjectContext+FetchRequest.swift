@@ -23,7 +23,14 @@ public extension NSManagedObjectContext {
     /// Executes a fetch request and asserts in case of error
     func fetchOrAssert<T>(request: NSFetchRequest<T>) -> [T] {
         do {
+            let start = Instrumentation.timestamp()
             let result = try fetch(request)
+            if Instrumentation.isEnabled {
+                let entityName = request.entityName ?? request.entity?.name
+                Instrumentation.record(.fetch, entity: entityName, since: start)
+                Instrumentation.increment(.fetches, entity: entityName)
+                Instrumentation.increment(.rowsReturned, entity: entityName, by: result.count)
+            }
             return result
         } catch let error {
             fatal("Error in fetching \(error.localizedDescription)")
@@ -0,0 +1,174 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let SideStateKey = "ZMContextSideState"
+
+    /// The state of this context which isn't persisted, e.g. the call states of conversations.
+    var sideState: ContextSideState {
+        if let sideState = userInfo[NSManagedObjectContext.SideStateKey] as? ContextSideState {
+            return sideState
+        }
+
+        let sideState = ContextSideState(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.SideStateKey] = sideState
+        return sideState
+    }
+
+}
+
+/// The latest values of the keys changed in one context which still need to be applied to another context.
+///
+/// Only the newest value of a key is kept, so the journal holds at most one entry per key. It's written
+/// on the queue of the context recording the changes and drained on the queue of the context applying them.
+
+final class SideStateJournal<Key: Hashable, Value> {
+
+    private let lock = NSLock()
+    private var changes: [Key: Value?] = [:]
+
+    /// Records the new value of a key, `nil` meaning the key was removed. Returns true if the journal was empty.
+    @discardableResult
+    func record(_ value: Value?, for key: Key) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let wasEmpty = changes.isEmpty
+        changes[key] = .some(value)
+        return wasEmpty
+    }
+
+    /// Returns the recorded changes and empties the journal.
+    func drain() -> [Key: Value?] {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let drained = changes
+        changes = [:]
+        return drained
+    }
+
+}
+
+/// State kept alongside the objects of a context without being persisted.
+///
+/// The state is mutated in place. Changes which need to reach the other context are recorded in a journal,
+/// call states going from the UI context to the sync context and the messages which degraded the security
+/// level of conversations going the other way. The other context pulls the journal in a block scheduled
+/// when the first change is recorded, or right away when merging the user info, so side state changes
+/// don't need a save to be propagated.
+
+final class ContextSideState: NSObject {
+
+    struct CallStateValues {
+        let isCallDeviceActive: Bool
+        let isIgnoringCall: Bool
+    }
+
+    private(set) var callState = ZMCallState()
+    let callStateJournal = SideStateJournal<NSManagedObjectID, CallStateValues>()
+
+    private(set) var degradingMessagesByConversation: [NSManagedObjectID: Set<NSManagedObjectID>] = [:]
+    let degradingMessagesJournal = SideStateJournal<NSManagedObjectID, Set<NSManagedObjectID>>()
+
+    private weak var managedObjectContext: NSManagedObjectContext?
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        super.init()
+    }
+
+    // MARK: - Call state
+
+    /// Records the call state of a conversation for the sync context, the UI context is authoritative.
+    func callStateDidChange(for conversation: NSManagedObjectID) {
+        guard let context = managedObjectContext, context.zm_isUserInterfaceContext else { return }
+
+        let state = callState.stateForConversationID(conversation)
+        let values = CallStateValues(isCallDeviceActive: state.isCallDeviceActive, isIgnoringCall: state.isIgnoringCall)
+
+        if callStateJournal.record(values, for: conversation) {
+            schedulePull(into: context.zm_sync) { $0.applyCallStateChanges(from: $1) }
+        }
+    }
+
+    func applyCallStateChanges(from source: ContextSideState) {
+        for (conversation, values) in source.callStateJournal.drain() {
+            guard let values = values else { continue }
+
+            let state = callState.stateForConversationID(conversation)
+            state.isCallDeviceActive = values.isCallDeviceActive
+            state.isIgnoringCall = values.isIgnoringCall
+        }
+    }
+
+    func resetCallState() {
+        callState = ZMCallState()
+    }
+
+    // MARK: - Security level degradation
+
+    func setMessage(_ message: NSManagedObjectID, causedSecurityLevelDegradation: Bool, in conversation: NSManagedObjectID) {
+        if causedSecurityLevelDegradation {
+            guard degradingMessagesByConversation[conversation, default: []].insert(message).inserted else { return }
+        } else {
+            guard degradingMessagesByConversation[conversation]?.remove(message) != nil else { return }
+
+            if degradingMessagesByConversation[conversation]?.isEmpty == true {
+                degradingMessagesByConversation.removeValue(forKey: conversation)
+            }
+        }
+
+        degradingMessagesDidChange(in: conversation)
+    }
+
+    func clearDegradingMessages(in conversation: NSManagedObjectID) {
+        guard degradingMessagesByConversation.removeValue(forKey: conversation) != nil else { return }
+        degradingMessagesDidChange(in: conversation)
+    }
+
+    /// Records the degrading messages of a conversation for the UI context, the sync context is authoritative.
+    private func degradingMessagesDidChange(in conversation: NSManagedObjectID) {
+        guard let context = managedObjectContext, context.zm_isSyncContext else { return }
+
+        if degradingMessagesJournal.record(degradingMessagesByConversation[conversation], for: conversation) {
+            schedulePull(into: context.zm_userInterface) { $0.applyDegradingMessagesChanges(from: $1) }
+        }
+    }
+
+    func applyDegradingMessagesChanges(from source: ContextSideState) {
+        for (conversation, messages) in source.degradingMessagesJournal.drain() {
+            degradingMessagesByConversation[conversation] = messages
+        }
+    }
+
+    // MARK: - Propagation
+
+    private func schedulePull(into destination: NSManagedObjectContext?, apply: @escaping (ContextSideState, ContextSideState) -> Void) {
+        guard let destination = destination else { return }
+
+        destination.performGroupedBlock { [weak self] in
+            guard let source = self else { return }
+            apply(destination.sideState, source)
+        }
+    }
+
+}
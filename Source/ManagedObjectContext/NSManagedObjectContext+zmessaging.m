@@ -265,14 +265,17 @@ static NSString* ZMLogTag ZM_UNUSED = @"NSManagedObjectContext";
         return NO;
     }
     
-    // We need to save even if hasChanges is NO as long as the callState changes. An empty save will result in an empty did-save notification.
-    // That notification in turn will result in a merge, even if it is empty, and thus merge the call state.
+    // We need to save even if hasChanges is NO as long as there are user info changes. An empty save will result in an empty did-save notification.
+    // That notification in turn will result in a merge, even if it is empty, and thus merge the user info.
     if (self.zm_hasChanges || shouldIgnoreChanges || hasMetadataChanges) {
         NSError *error;
         ZMLogDebug(@"Saving <%@: %p>.", self.class, self);
         self.timeOfLastSave = [NSDate date];
         ZMSTimePoint *tp = [ZMSTimePoint timePointWithInterval:10 label:[NSString stringWithFormat:@"Saving context %@", self.zm_isSyncContext ? @"sync": @"ui"]];
-        if (! [self save:&error]) {
+        uint64_t saveStart = [Instrumentation timestamp];
+        BOOL saved = [self save:&error];
+        [Instrumentation recordPhase:InstrumentationPhaseSave entity:nil since:saveStart];
+        if (! saved) {
             ZMLogError(@"Failed to save: %@", error);
             [self reportSaveErrorWithError:error];
             [self rollbackWithOldMetadata:oldMetadata];
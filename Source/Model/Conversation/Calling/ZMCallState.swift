@@ -22,24 +22,16 @@ import WireSystem
 
 private let zmLog = ZMSLog(tag: "CallState")
 
-private let UserInfoCallStateKey = "ZMCallState"
 private let UserInfoHasChangesKey = "zm_userInfoHasChanges"
 
 extension NSManagedObjectContext {
 
     @objc public var zm_callState: ZMCallState {
-        let oldState = self.userInfo[UserInfoCallStateKey] as? ZMCallState
-        return oldState ?? { () -> ZMCallState in
-            let state = ZMCallState()
-            self.userInfo[UserInfoCallStateKey] = state
-            return state
-        }()
+        return sideState.callState
     }
 
     @objc public func zm_tearDownCallState() {
-        if (self.userInfo[UserInfoCallStateKey] as? ZMCallState) != nil {
-            self.userInfo.removeObject(forKey: UserInfoCallStateKey)
-        }
+        (userInfo[NSManagedObjectContext.SideStateKey] as? ContextSideState)?.resetCallState()
     }
 
     /// True if the context has some changes in the user info that should cause a save
@@ -52,18 +44,20 @@ extension NSManagedObjectContext {
         }
     }
 
-    /// Checks hasChanges and callStateHasChanges.
+    /// Checks hasChanges and zm_hasUserInfoChanges.
     ///
-    /// The call state changes do not dirty the context's objects, hence need to be tracked / checked seperately.
+    /// The user info changes do not dirty the context's objects, hence need to be tracked / checked seperately.
+    /// Side state, e.g. the call state, is propagated without a save and doesn't set zm_hasUserInfoChanges.
     @objc public var zm_hasChanges: Bool {
         return hasChanges || self.zm_hasUserInfoChanges
     }
 
+    /// Applies the call state changes recorded by the context with the given user info which weren't pulled yet.
     @objc public func mergeCallStateChanges(fromUserInfo userInfo: [String: Any]) {
         guard self.zm_isSyncContext else { return } // we don't merge anything to UI, UI is autoritative
 
-        if let callState = self.userInfo[UserInfoCallStateKey] as? ZMCallState {
-            _ = callState.mergeChangesFromState(userInfo[UserInfoCallStateKey] as? ZMCallState)
+        if let source = userInfo[NSManagedObjectContext.SideStateKey] as? ContextSideState, source !== sideState {
+            sideState.applyCallStateChanges(from: source)
         }
     }
 }
@@ -83,7 +77,7 @@ extension ZMConversation {
         set {
             if callState.isIgnoringCall != newValue {
                 callState.isIgnoringCall = newValue
-                managedObjectContext?.zm_hasUserInfoChanges = true
+                managedObjectContext?.sideState.callStateDidChange(for: objectID)
             }
         }
     }
@@ -95,7 +89,7 @@ extension ZMConversation {
         set {
             if callState.isCallDeviceActive != newValue {
                 callState.isCallDeviceActive = newValue
-                managedObjectContext?.zm_hasUserInfoChanges = true
+                managedObjectContext?.sideState.callStateDidChange(for: objectID)
             }
         }
     }
@@ -0,0 +1,392 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+private let zmLog = ZMSLog(tag: "ConversationLastMessageCache")
+
+extension NSManagedObjectContext {
+
+    static let ConversationLastMessageCacheKey = "ConversationLastMessageCacheKey"
+
+    var conversationLastMessageCache: ConversationLastMessageCache {
+        if let cache = userInfo[NSManagedObjectContext.ConversationLastMessageCacheKey] as? ConversationLastMessageCache {
+            return cache
+        }
+
+        let cache = ConversationLastMessageCache(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.ConversationLastMessageCacheKey] = cache
+        return cache
+    }
+
+}
+
+/// Keeps the last visible message of conversations, and the last message of a few senders per conversation,
+/// so reading them doesn't fetch.
+///
+/// An entry is fetched the first time it's read and then updated in place when messages are appended to
+/// the conversation or their server timestamp changes. When the cached message leaves the conversation,
+/// e.g. it's deleted or hidden, or when the order of two messages can't be told, the entry is dropped and
+/// fetched again on the next read. Clearing the conversation drops its entries as well.
+///
+/// Entries only keep the object IDs of the messages, so the cache doesn't keep messages registered in the
+/// context. Temporary IDs of unsaved objects are replaced with their permanent IDs when the context saves.
+/// The cache holds at most `maximumEntryCount` conversations, the least recently read are evicted beyond that.
+
+final class ConversationLastMessageCache: NSObject, TearDownCapable {
+
+    private final class Entry {
+        /// The last message, `.some(nil)` if the conversation has no messages and `nil` if it's not fetched yet.
+        var lastMessage: NSManagedObjectID??
+        var lastMessageBySender: [NSManagedObjectID: NSManagedObjectID?] = [:]
+        var senderOrder: [NSManagedObjectID] = []
+        var lastUse: UInt64 = 0
+    }
+
+    private enum Candidate {
+        case replace
+        case keep
+        case unknown
+    }
+
+    /// The number of senders whose last message is kept per conversation.
+    static let maximumSendersPerConversation = 8
+
+    static let maximumEntryCount = 1_000
+
+    let maximumEntryCount: Int
+
+    /// Cross-checks every read against a fetch, for tests. Mismatches are recorded and the fetched
+    /// message is returned.
+    var isVerifying = false
+    private(set) var mismatches: [NSManagedObjectID] = []
+
+    private var entries: [NSManagedObjectID: Entry] = [:]
+    private var useCounter: UInt64 = 0
+    private var hasTemporaryIDs = false
+    private var objectsToRekey: [NSManagedObjectID: NSManagedObject] = [:]
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    var entryCount: Int {
+        return entries.count
+    }
+
+    init(managedObjectContext: NSManagedObjectContext, maximumEntryCount: Int = ConversationLastMessageCache.maximumEntryCount) {
+        self.managedObjectContext = managedObjectContext
+        self.maximumEntryCount = maximumEntryCount
+        super.init()
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextWillSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] _ in
+                self?.contextWillSave()
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] _ in
+                self?.contextDidSave()
+            }
+        ]
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach { NotificationCenter.default.removeObserver($0) }
+        observerTokens = []
+        invalidateAll()
+    }
+
+    // MARK: - Lookup
+
+    func lastMessage(in conversation: ZMConversation) -> ZMMessage? {
+        let entry = self.entry(for: conversation)
+
+        if let cached = resolve(entry.lastMessage, in: conversation, sender: nil) {
+            return verified(cached, in: conversation, sender: nil)
+        }
+
+        let message = conversation.fetchLastMessage(sentBy: nil)
+        entry.lastMessage = .some(message.map(objectID(of:)))
+        return message
+    }
+
+    func lastMessage(sentBy sender: ZMUser, in conversation: ZMConversation) -> ZMMessage? {
+        let entry = self.entry(for: conversation)
+
+        if let cached = resolve(entry.lastMessageBySender[sender.objectID], in: conversation, sender: sender) {
+            return verified(cached, in: conversation, sender: sender)
+        }
+
+        let message = conversation.fetchLastMessage(sentBy: sender)
+        store(message.map(objectID(of:)), for: objectID(of: sender), in: entry)
+        return message
+    }
+
+    private func entry(for conversation: ZMConversation) -> Entry {
+        if let entry = entries[conversation.objectID] {
+            touch(entry)
+            return entry
+        }
+
+        let entry = Entry()
+        touch(entry)
+        entries[objectID(of: conversation)] = entry
+        evictIfNeeded()
+        return entry
+    }
+
+    /// Returns the cached message, `.some(nil)` if the conversation has none and `nil` if it has to be
+    /// fetched again.
+    private func resolve(_ cached: NSManagedObjectID??, in conversation: ZMConversation, sender: ZMUser?) -> ZMMessage?? {
+        guard let cached = cached else { return nil }
+        guard let messageID = cached else { return .some(nil) }
+
+        guard
+            let message = self.message(with: messageID),
+            isValid(message, in: conversation),
+            sender.map({ message.sender == $0 }) ?? true
+        else { return nil }
+
+        return .some(message)
+    }
+
+    private func message(with objectID: NSManagedObjectID) -> ZMMessage? {
+        return (try? managedObjectContext?.existingObject(with: objectID)) as? ZMMessage
+    }
+
+    /// Notes temporary IDs, they are replaced when the context saves.
+    private func objectID(of object: NSManagedObject) -> NSManagedObjectID {
+        hasTemporaryIDs = hasTemporaryIDs || object.objectID.isTemporaryID
+        return object.objectID
+    }
+
+    private func isValid(_ message: ZMMessage, in conversation: ZMConversation) -> Bool {
+        return message.managedObjectContext != nil && !message.isDeleted && message.visibleInConversation == conversation
+    }
+
+    private func store(_ messageID: NSManagedObjectID?, for senderID: NSManagedObjectID, in entry: Entry) {
+        if entry.lastMessageBySender.updateValue(messageID, forKey: senderID) == nil {
+            entry.senderOrder.append(senderID)
+        }
+
+        if entry.senderOrder.count > ConversationLastMessageCache.maximumSendersPerConversation {
+            entry.lastMessageBySender.removeValue(forKey: entry.senderOrder.removeFirst())
+        }
+    }
+
+    private func touch(_ entry: Entry) {
+        useCounter += 1
+        entry.lastUse = useCounter
+    }
+
+    /// Drops the least recently read conversations until the cache is back to three quarters of its limit,
+    /// so evictions are amortized over many reads.
+    private func evictIfNeeded() {
+        guard entries.count > maximumEntryCount else { return }
+
+        let leastRecentlyUsedFirst = entries.sorted { $0.value.lastUse < $1.value.lastUse }
+
+        for (conversationID, _) in leastRecentlyUsedFirst {
+            guard entries.count > maximumEntryCount / 4 * 3 else { break }
+            entries.removeValue(forKey: conversationID)
+        }
+    }
+
+    private func verified(_ message: ZMMessage?, in conversation: ZMConversation, sender: ZMUser?) -> ZMMessage? {
+        guard isVerifying else { return message }
+
+        let fetched = conversation.fetchLastMessage(sentBy: sender)
+
+        guard fetched == message || fetched?.serverTimestamp == message?.serverTimestamp else {
+            zmLog.error("Cached last message of \(conversation.objectID) doesn't match the fetched one")
+            mismatches.append(conversation.objectID)
+            return fetched
+        }
+
+        return message
+    }
+
+    // MARK: - Updates
+
+    /// Updates the entries of the message's conversation after it was appended or its timestamp changed.
+    func messageDidChange(_ message: ZMMessage) {
+        guard
+            !entries.isEmpty,
+            !message.isDeleted,
+            let conversation = message.visibleInConversation,
+            let entry = entries[conversation.objectID]
+        else { return }
+
+        if let cached = entry.lastMessage {
+            switch candidate(message, over: cached) {
+            case .replace:
+                entry.lastMessage = .some(objectID(of: message))
+            case .keep:
+                break
+            case .unknown:
+                entry.lastMessage = nil
+            }
+        }
+
+        guard let senderID = message.sender?.objectID, let cached = entry.lastMessageBySender[senderID] else { return }
+
+        switch candidate(message, over: cached) {
+        case .replace:
+            entry.lastMessageBySender[senderID] = .some(objectID(of: message))
+        case .keep:
+            break
+        case .unknown:
+            entry.lastMessageBySender.removeValue(forKey: senderID)
+            entry.senderOrder.removeAll { $0 == senderID }
+        }
+    }
+
+    /// Drops the entries of the message's conversation if the message is one of its cached messages and is
+    /// about to move, get another sender or timestamp.
+    func messageWillChange(_ message: ZMMessage) {
+        guard
+            !entries.isEmpty,
+            let conversation = message.visibleInConversation,
+            let entry = entries[conversation.objectID]
+        else { return }
+
+        if entry.lastMessage == .some(message.objectID) || entry.lastMessageBySender.values.contains(message.objectID) {
+            invalidate(conversation)
+        }
+    }
+
+    func invalidate(_ conversation: ZMConversation) {
+        entries.removeValue(forKey: conversation.objectID)
+    }
+
+    func invalidateAll() {
+        entries = [:]
+        hasTemporaryIDs = false
+        objectsToRekey = [:]
+    }
+
+    // MARK: - Saving
+
+    /// Keeps the objects behind the temporary IDs of the entries, their permanent IDs are read once saved.
+    private func contextWillSave() {
+        guard hasTemporaryIDs, let context = managedObjectContext else { return }
+
+        var temporaryIDs = Set<NSManagedObjectID>()
+
+        for (conversationID, entry) in entries {
+            temporaryIDs.insert(conversationID)
+            temporaryIDs.formUnion(entry.senderOrder)
+
+            if let messageID = entry.lastMessage ?? nil {
+                temporaryIDs.insert(messageID)
+            }
+            temporaryIDs.formUnion(entry.lastMessageBySender.values.compactMap { $0 })
+        }
+
+        for objectID in temporaryIDs where objectID.isTemporaryID {
+            objectsToRekey[objectID] = context.registeredObject(for: objectID)
+        }
+    }
+
+    /// Replaces the temporary IDs of the saved objects with their permanent IDs.
+    private func contextDidSave() {
+        hasTemporaryIDs = false
+
+        guard !objectsToRekey.isEmpty else { return }
+
+        let permanentIDs = objectsToRekey.compactMapValues { $0.objectID.isTemporaryID ? nil : $0.objectID }
+        objectsToRekey = [:]
+
+        func rekeyed(_ objectID: NSManagedObjectID) -> NSManagedObjectID {
+            return permanentIDs[objectID] ?? objectID
+        }
+
+        var rekeyedEntries: [NSManagedObjectID: Entry] = [:]
+
+        for (conversationID, entry) in entries {
+            entry.lastMessage = entry.lastMessage.map { $0.map(rekeyed) }
+            entry.lastMessageBySender = Dictionary(entry.lastMessageBySender.map { (rekeyed($0), $1.map(rekeyed)) },
+                                                   uniquingKeysWith: { first, _ in first })
+            entry.senderOrder = entry.senderOrder.map(rekeyed)
+            rekeyedEntries[rekeyed(conversationID)] = entry
+        }
+
+        entries = rekeyedEntries
+    }
+
+    /// Messages are ordered by server timestamp, messages without one come last.
+    private func candidate(_ message: ZMMessage, over cachedID: NSManagedObjectID?) -> Candidate {
+        guard let cachedID = cachedID else { return .replace }
+        guard cachedID != message.objectID else { return .keep }
+        guard let cached = self.message(with: cachedID) else { return .unknown }
+
+        switch (message.serverTimestamp, cached.serverTimestamp) {
+        case let (timestamp?, cachedTimestamp?):
+            if timestamp == cachedTimestamp {
+                return .unknown
+            }
+            return timestamp > cachedTimestamp ? .replace : .keep
+        case (.some, nil):
+            return .replace
+        case (nil, .some):
+            return .keep
+        case (nil, nil):
+            return .unknown
+        }
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard !entries.isEmpty else { return }
+
+        // Changes merged from other contexts don't go through the model hooks
+        for key in [NSInsertedObjectsKey, NSUpdatedObjectsKey, NSRefreshedObjectsKey] {
+            guard let objects = userInfo[key] as? Set<NSManagedObject> else { continue }
+
+            for message in objects.lazy.compactMap({ $0 as? ZMMessage }) {
+                if key == NSRefreshedObjectsKey {
+                    messageWillChange(message)
+                }
+                messageDidChange(message)
+            }
+        }
+
+        let deleted = (userInfo[NSDeletedObjectsKey] as? Set<NSManagedObject>) ?? []
+        for message in deleted.lazy.compactMap({ $0 as? ZMMessage }) {
+            let committed = message.committedValues(forKeys: [ZMMessageConversationKey])
+            (committed[ZMMessageConversationKey] as? ZMConversation).map(invalidate)
+        }
+    }
+
+}
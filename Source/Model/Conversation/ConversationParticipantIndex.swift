@@ -0,0 +1,419 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let ConversationParticipantIndexKey = "ConversationParticipantIndexKey"
+
+    var conversationParticipantIndex: ConversationParticipantIndex {
+        if let index = userInfo[NSManagedObjectContext.ConversationParticipantIndexKey] as? ConversationParticipantIndex {
+            return index
+        }
+
+        let index = ConversationParticipantIndex(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.ConversationParticipantIndexKey] = index
+        return index
+    }
+
+}
+
+/// Keeps the participants of conversations indexed, so reading them doesn't walk the participant roles.
+///
+/// An entry is built the first time a conversation's participants are read. It's then updated in place
+/// when participants are added or removed and when their names change. Changes the index can't apply
+/// in place, e.g. the participant roles of a conversation being replaced, drop the entry instead.
+///
+/// The changes are reported by the model hooks, see `ZMManagedObject+ChangeHooks.swift`, and checked
+/// again when the context processes its pending changes.
+///
+/// The index holds at most `maximumEntryCount` conversations, the least recently read are evicted beyond
+/// that. Entries of unsaved conversations are moved to their permanent IDs when the context saves.
+
+final class ConversationParticipantIndex: NSObject, TearDownCapable {
+
+    final class Entry {
+
+        /// The participants of the conversation.
+        fileprivate(set) var members: Set<ZMUser>
+
+        /// The participants sorted by `normalizedName`, in the same order as an `NSSortDescriptor` would.
+        fileprivate(set) var roster: [ZMUser]
+
+        fileprivate(set) var containsSelfUser: Bool
+
+        /// The names of the participants other than the self user, sorted and joined. Computed on first use.
+        fileprivate var memoizedGroupName: String??
+
+        fileprivate var lastUse: UInt64 = 0
+
+        fileprivate init(members: Set<ZMUser>, selfUser: ZMUser?) {
+            self.members = members
+            self.roster = members.sorted(by: Entry.isOrderedBefore)
+            self.containsSelfUser = selfUser.map(members.contains) ?? false
+        }
+
+        fileprivate func insert(_ user: ZMUser, isSelfUser: Bool) {
+            guard members.insert(user).inserted else { return }
+
+            roster.insert(user, at: insertionIndex(of: user))
+            containsSelfUser = containsSelfUser || isSelfUser
+            memoizedGroupName = nil
+        }
+
+        fileprivate func remove(_ user: ZMUser, isSelfUser: Bool) {
+            guard members.remove(user) != nil else { return }
+
+            roster.removeAll { $0 == user }
+            containsSelfUser = containsSelfUser && !isSelfUser
+            memoizedGroupName = nil
+        }
+
+        fileprivate func nameDidChange(of user: ZMUser) {
+            guard members.contains(user) else { return }
+
+            memoizedGroupName = nil
+
+            // Refreshed users are reported for any change, most of them keep their place in the roster
+            guard let index = roster.firstIndex(of: user), !isInOrder(at: index) else { return }
+
+            roster.remove(at: index)
+            roster.insert(user, at: insertionIndex(of: user))
+        }
+
+        private func isInOrder(at index: Int) -> Bool {
+            let user = roster[index]
+            let isAfterPrevious = index == roster.startIndex || !Entry.isOrderedBefore(user, roster[index - 1])
+            let isBeforeNext = index == roster.endIndex - 1 || !Entry.isOrderedBefore(roster[index + 1], user)
+            return isAfterPrevious && isBeforeNext
+        }
+
+        private func insertionIndex(of user: ZMUser) -> Int {
+            var low = 0
+            var high = roster.count
+
+            while low < high {
+                let mid = (low + high) / 2
+                if Entry.isOrderedBefore(roster[mid], user) {
+                    low = mid + 1
+                } else {
+                    high = mid
+                }
+            }
+
+            return low
+        }
+
+        private static func isOrderedBefore(_ lhs: ZMUser, _ rhs: ZMUser) -> Bool {
+            switch (lhs.normalizedName, rhs.normalizedName) {
+            case let (lhsName?, rhsName?):
+                return (lhsName as NSString).compare(rhsName) == .orderedAscending
+            case (nil, .some):
+                return true
+            default:
+                return false
+            }
+        }
+
+    }
+
+    static let maximumEntryCount = 1_000
+
+    let maximumEntryCount: Int
+
+    private var entries: [NSManagedObjectID: Entry] = [:]
+    /// The conversations with an entry each indexed user is a participant of.
+    private var conversationsByUser: [ZMUser: Set<NSManagedObjectID>] = [:]
+    private var useCounter: UInt64 = 0
+    private var incrementalUpdateDepth = 0
+    private var hasTemporaryIDs = false
+    private var conversationsToRekey: [NSManagedObjectID: NSManagedObject] = [:]
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    var entryCount: Int {
+        return entries.count
+    }
+
+    init(managedObjectContext: NSManagedObjectContext, maximumEntryCount: Int = ConversationParticipantIndex.maximumEntryCount) {
+        self.managedObjectContext = managedObjectContext
+        self.maximumEntryCount = maximumEntryCount
+        super.init()
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextWillSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] _ in
+                self?.contextWillSave()
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] _ in
+                self?.contextDidSave()
+            }
+        ]
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach { NotificationCenter.default.removeObserver($0) }
+        observerTokens = []
+        invalidateAll()
+    }
+
+    private var selfUser: ZMUser? {
+        return managedObjectContext.map(ZMUser.selfUser)
+    }
+
+    // MARK: - Lookup
+
+    func entry(for conversation: ZMConversation) -> Entry {
+        if let entry = entries[conversation.objectID] {
+            touch(entry)
+            return entry
+        }
+
+        let conversationID = conversation.objectID
+        let entry = Entry(members: Set(conversation.participantRoles.compactMap(\.user)), selfUser: selfUser)
+        touch(entry)
+        entries[conversationID] = entry
+        entry.members.forEach { conversationsByUser[$0, default: []].insert(conversationID) }
+        hasTemporaryIDs = hasTemporaryIDs || conversationID.isTemporaryID
+        evictIfNeeded()
+        return entry
+    }
+
+    private func touch(_ entry: Entry) {
+        useCounter += 1
+        entry.lastUse = useCounter
+    }
+
+    /// Drops the least recently read conversations until the index is back to three quarters of its limit,
+    /// so evictions are amortized over many reads.
+    private func evictIfNeeded() {
+        guard entries.count > maximumEntryCount else { return }
+
+        let leastRecentlyUsedFirst = entries.sorted { $0.value.lastUse < $1.value.lastUse }
+
+        for (conversationID, _) in leastRecentlyUsedFirst {
+            guard entries.count > maximumEntryCount / 4 * 3 else { break }
+            removeEntry(for: conversationID)
+        }
+    }
+
+    /// Returns the memoized group name of a conversation, computing it with the given block if needed.
+    func groupName(for conversation: ZMConversation, compute: (Entry) -> String?) -> String? {
+        let entry = self.entry(for: conversation)
+
+        if let name = entry.memoizedGroupName {
+            return name
+        }
+
+        let name = compute(entry)
+        entry.memoizedGroupName = .some(name)
+        return name
+    }
+
+    // MARK: - Updates
+
+    /// Runs a block which updates the participant roles of conversations while keeping the index up to date
+    /// itself, the relationship changes made by the block don't drop index entries.
+    func performIncrementalUpdate(_ block: () -> Void) {
+        incrementalUpdateDepth += 1
+        defer { incrementalUpdateDepth -= 1 }
+        block()
+    }
+
+    func insert<S: Sequence>(_ users: S, into conversation: ZMConversation) where S.Element == ZMUser {
+        let conversationID = conversation.objectID
+        guard let entry = entries[conversationID] else { return }
+        let selfUser = self.selfUser
+
+        for user in users {
+            entry.insert(user, isSelfUser: user == selfUser)
+            conversationsByUser[user, default: []].insert(conversationID)
+        }
+    }
+
+    func remove<S: Sequence>(_ users: S, from conversation: ZMConversation) where S.Element == ZMUser {
+        let conversationID = conversation.objectID
+        guard let entry = entries[conversationID] else { return }
+        let selfUser = self.selfUser
+
+        for user in users {
+            entry.remove(user, isSelfUser: user == selfUser)
+            removeConversation(with: conversationID, of: user)
+        }
+    }
+
+    func nameDidChange(of user: ZMUser) {
+        guard let conversationIDs = conversationsByUser[user] else { return }
+
+        for conversationID in conversationIDs {
+            entries[conversationID]?.nameDidChange(of: user)
+        }
+    }
+
+    func participantRolesDidChange(in conversation: ZMConversation) {
+        guard incrementalUpdateDepth == 0 else { return }
+        invalidate(conversation)
+    }
+
+    /// Drops the entries of the conversations the user was or is now a participant of.
+    func participantRolesDidChange(of user: ZMUser) {
+        guard incrementalUpdateDepth == 0, !entries.isEmpty else { return }
+
+        var conversationIDs = conversationsByUser[user] ?? []
+        conversationIDs.formUnion(user.participantRoles.lazy.compactMap { $0.conversation?.objectID })
+        conversationIDs.forEach(removeEntry)
+    }
+
+    func invalidate(_ conversation: ZMConversation) {
+        removeEntry(for: conversation.objectID)
+    }
+
+    func invalidateAll() {
+        entries = [:]
+        conversationsByUser = [:]
+        hasTemporaryIDs = false
+        conversationsToRekey = [:]
+    }
+
+    private func removeEntry(for conversationID: NSManagedObjectID) {
+        guard let entry = entries.removeValue(forKey: conversationID) else { return }
+        entry.members.forEach { removeConversation(with: conversationID, of: $0) }
+    }
+
+    private func removeConversation(with conversationID: NSManagedObjectID, of user: ZMUser) {
+        conversationsByUser[user]?.remove(conversationID)
+
+        if conversationsByUser[user]?.isEmpty == true {
+            conversationsByUser.removeValue(forKey: user)
+        }
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard !entries.isEmpty else { return }
+
+        if let refreshed = userInfo[NSRefreshedObjectsKey] as? Set<NSManagedObject> {
+            for object in refreshed {
+                switch object {
+                case let conversation as ZMConversation:
+                    invalidate(conversation)
+                case let user as ZMUser:
+                    nameDidChange(of: user)
+                case let participantRole as ParticipantRole:
+                    participantRole.conversation.map(invalidate)
+                default:
+                    break
+                }
+            }
+        }
+
+        // Changes of the participant roles which didn't reach the model hooks leave the entry out of date.
+        let updated = (userInfo[NSUpdatedObjectsKey] as? Set<NSManagedObject>) ?? []
+        for conversation in updated.lazy.compactMap({ $0 as? ZMConversation }) {
+            guard
+                let entry = entries[conversation.objectID],
+                conversation.changedValuesForCurrentEvent()[#keyPath(ZMConversation.participantRoles)] != nil
+            else { continue }
+
+            let members = Set(conversation.participantRoles.lazy.filter { !$0.isDeleted }.compactMap(\.user))
+            if entry.members != members {
+                invalidate(conversation)
+            }
+        }
+
+        // Participant roles inserted or deleted by the participant operations are already applied,
+        // anything else means the index is out of date.
+        let inserted = (userInfo[NSInsertedObjectsKey] as? Set<NSManagedObject>) ?? []
+        for participantRole in inserted.lazy.compactMap({ $0 as? ParticipantRole }) {
+            guard let conversation = participantRole.conversation, let user = participantRole.user else { continue }
+
+            if entries[conversation.objectID]?.members.contains(user) == false {
+                invalidate(conversation)
+            }
+        }
+
+        let deleted = (userInfo[NSDeletedObjectsKey] as? Set<NSManagedObject>) ?? []
+        for participantRole in deleted.lazy.compactMap({ $0 as? ParticipantRole }) {
+            let committed = participantRole.committedValues(forKeys: [#keyPath(ParticipantRole.conversation), #keyPath(ParticipantRole.user)])
+            guard
+                let conversation = committed[#keyPath(ParticipantRole.conversation)] as? ZMConversation,
+                let user = committed[#keyPath(ParticipantRole.user)] as? ZMUser
+            else { continue }
+
+            if entries[conversation.objectID]?.members.contains(user) == true,
+               !conversation.participantRoles.contains(where: { $0.user == user && !$0.isDeleted }) {
+                invalidate(conversation)
+            }
+        }
+    }
+
+    // MARK: - Saving
+
+    /// Keeps the conversations behind the temporary IDs of the entries, their permanent IDs are read once saved.
+    private func contextWillSave() {
+        guard hasTemporaryIDs, let context = managedObjectContext else { return }
+
+        for conversationID in entries.keys where conversationID.isTemporaryID {
+            conversationsToRekey[conversationID] = context.registeredObject(for: conversationID)
+        }
+    }
+
+    /// Moves the entries of the saved conversations to their permanent IDs.
+    private func contextDidSave() {
+        hasTemporaryIDs = false
+
+        guard !conversationsToRekey.isEmpty else { return }
+
+        let permanentIDs = conversationsToRekey.compactMapValues { $0.objectID.isTemporaryID ? nil : $0.objectID }
+        conversationsToRekey = [:]
+
+        for (temporaryID, permanentID) in permanentIDs {
+            guard let entry = entries.removeValue(forKey: temporaryID) else { continue }
+
+            entries[permanentID] = entry
+
+            for user in entry.members {
+                conversationsByUser[user]?.remove(temporaryID)
+                conversationsByUser[user, default: []].insert(permanentID)
+            }
+        }
+
+        // Conversations which weren't saved, e.g. deleted ones, keep their temporary IDs
+        hasTemporaryIDs = entries.keys.contains { $0.isTemporaryID }
+    }
+
+}
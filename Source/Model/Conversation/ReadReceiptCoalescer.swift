@@ -0,0 +1,219 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let ReadReceiptCoalescerKey = "ReadReceiptCoalescerKey"
+
+    var readReceiptCoalescer: ReadReceiptCoalescer {
+        if let coalescer = userInfo[NSManagedObjectContext.ReadReceiptCoalescerKey] as? ReadReceiptCoalescer {
+            return coalescer
+        }
+
+        let coalescer = ReadReceiptCoalescer(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.ReadReceiptCoalescerKey] = coalescer
+        return coalescer
+    }
+
+}
+
+/// Collects the read confirmations of messages read in quick succession, so they're sent together.
+///
+/// Messages marked as read are grouped by conversation and sender until `flushDelay` has passed since
+/// the first of them was enqueued. A flush then appends one confirmation message per conversation and
+/// sender and saves once. It appends at most `maximumConfirmationsPerFlush` confirmation messages, the
+/// remaining groups are flushed right after.
+///
+/// The last read timestamp of a conversation with pending confirmations is deferred as well and only updated
+/// by the flush appending its last confirmation, so both are saved together. Other saves of the context in
+/// between save neither; if the confirmations are lost, e.g. the app is killed, the messages stay unread.
+
+final class ReadReceiptCoalescer: NSObject, TearDownCapable {
+
+    struct Metrics: Equatable {
+        /// The number of confirmation messages which would have been sent without coalescing.
+        var requestedConfirmations = 0
+
+        /// The number of requested confirmations merged into one which was already pending.
+        var coalescedConfirmations = 0
+
+        /// The number of confirmation messages appended.
+        var sentConfirmations = 0
+
+        /// The number of messages confirmed by the appended confirmation messages.
+        var confirmedMessages = 0
+    }
+
+    private struct Key: Hashable {
+        let conversation: ZMConversation
+        let sender: ZMUser?
+    }
+
+    private struct Batch {
+        var messages: [ZMMessage] = []
+        var members: Set<ZMMessage> = []
+
+        mutating func append(_ message: ZMMessage) {
+            guard members.insert(message).inserted else { return }
+            messages.append(message)
+        }
+    }
+
+    static let defaultFlushDelay: TimeInterval = 1
+    static let defaultMaximumConfirmationsPerFlush = 20
+
+    var flushDelay = ReadReceiptCoalescer.defaultFlushDelay
+    var maximumConfirmationsPerFlush = ReadReceiptCoalescer.defaultMaximumConfirmationsPerFlush
+
+    private(set) var metrics = Metrics()
+
+    private var batches: [Key: Batch] = [:]
+    private var order: [Key] = []
+    private var pendingLastRead: [ZMConversation: Date] = [:]
+    private var isFlushScheduled = false
+    private var isTornDown = false
+    private weak var managedObjectContext: NSManagedObjectContext?
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        super.init()
+    }
+
+    func tearDown() {
+        isTornDown = true
+        batches = [:]
+        order = []
+        pendingLastRead = [:]
+    }
+
+    var hasPendingConfirmations: Bool {
+        return !batches.isEmpty
+    }
+
+    func hasPendingConfirmations(in conversation: ZMConversation) -> Bool {
+        return order.contains { $0.conversation == conversation }
+    }
+
+    // MARK: - Enqueueing
+
+    /// Enqueues the messages received in the given range which need a read confirmation.
+    func enqueueUnreadMessages(of conversation: ZMConversation, in range: ClosedRange<Date>) {
+        enqueue(conversation.unreadMessages(in: range).filter(\.needsReadConfirmation), in: conversation)
+    }
+
+    func enqueue(_ messages: [ZMMessage], in conversation: ZMConversation) {
+        guard !isTornDown, !messages.isEmpty else { return }
+
+        for (sender, messagesOfSender) in messages.partition(by: \.sender) {
+            let key = Key(conversation: conversation, sender: sender)
+            metrics.requestedConfirmations += 1
+
+            if batches[key] == nil {
+                order.append(key)
+            } else {
+                metrics.coalescedConfirmations += 1
+            }
+
+            messagesOfSender.forEach { batches[key, default: Batch()].append($0) }
+        }
+
+        scheduleFlush(after: flushDelay)
+    }
+
+    /// Defers updating the last read timestamp of the conversation until its pending confirmations are appended.
+    func enqueueLastRead(_ timestamp: Date, of conversation: ZMConversation) {
+        guard !isTornDown else { return }
+
+        guard hasPendingConfirmations(in: conversation) else {
+            conversation.updateLastRead(timestamp, synchronize: true)
+            return
+        }
+
+        pendingLastRead[conversation] = max(timestamp, pendingLastRead[conversation] ?? timestamp)
+    }
+
+    // MARK: - Flushing
+
+    /// The groups of the context are only entered once the flush is enqueued on the context, waiting for them
+    /// doesn't wait for the delay.
+    private func scheduleFlush(after delay: TimeInterval) {
+        guard !isFlushScheduled, let managedObjectContext = managedObjectContext else { return }
+
+        isFlushScheduled = true
+
+        guard delay > 0 else {
+            managedObjectContext.performGroupedBlock { [weak self] in
+                self?.flush()
+            }
+            return
+        }
+
+        DispatchQueue.global(qos: .utility).asyncAfter(deadline: .now() + delay) { [weak self, weak managedObjectContext] in
+            managedObjectContext?.performGroupedBlock {
+                self?.flush()
+            }
+        }
+    }
+
+    /// Appends the pending confirmation messages, up to `maximumConfirmationsPerFlush` of them, and saves them
+    /// together with the deferred last read timestamps of their conversations.
+    @discardableResult
+    func flush() -> [ZMClientMessage] {
+        isFlushScheduled = false
+        guard !isTornDown, hasPendingConfirmations else { return [] }
+
+        var confirmationMessages: [ZMClientMessage] = []
+        var flushedConversations = Set<ZMConversation>()
+
+        while confirmationMessages.count < maximumConfirmationsPerFlush, !order.isEmpty {
+            let key = order.removeFirst()
+            flushedConversations.insert(key.conversation)
+            guard let batch = batches.removeValue(forKey: key), !key.conversation.isZombieObject else { continue }
+
+            // Messages can be deleted while they're waiting
+            let nonces = batch.messages.filter { !$0.isZombieObject && $0.needsReadConfirmation }.compactMap(\.nonce)
+            guard let confirmation = Confirmation(messageIds: nonces, type: .read) else { continue }
+
+            do {
+                let confirmationMessage = try key.conversation.appendClientMessage(with: GenericMessage(content: confirmation), expires: false, hidden: true)
+                confirmationMessages.append(confirmationMessage)
+                metrics.sentConfirmations += 1
+                metrics.confirmedMessages += nonces.count
+            } catch {
+                Logging.messageProcessing.warn("Failed to append confirmation. Reason: \(error.localizedDescription)")
+            }
+        }
+
+        for conversation in flushedConversations where !hasPendingConfirmations(in: conversation) {
+            guard let timestamp = pendingLastRead.removeValue(forKey: conversation), !conversation.isZombieObject else { continue }
+            conversation.updateLastRead(timestamp, synchronize: true)
+        }
+
+        // The remaining confirmations have waited for the delay already
+        if hasPendingConfirmations {
+            scheduleFlush(after: 0)
+        }
+
+        managedObjectContext?.saveOrRollback()
+
+        return confirmationMessages
+    }
+
+}
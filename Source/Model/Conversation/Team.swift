@@ -94,15 +94,26 @@ public class Team: ZMManagedObject, TeamType {
 
 extension Team {
 
+    /// Returns the members whose user matches the query, sorted by name. The self user is not included.
     public func members(matchingQuery query: String) -> [Member] {
-        let searchPredicate = ZMUser.predicateForAllUsers(withSearch: query)
-
-        return members.filter({ member in
-            guard let user = member.user else { return false }
-            return !user.isSelfUser && searchPredicate.evaluate(with: user)
-        }).sorted(by: { (first, second) -> Bool in
-            return first.user?.normalizedName < second.user?.normalizedName
-        })
+        return members(matchingQuery: query, offset: 0, limit: .max)
+    }
+
+    /// Returns a page of the members whose user matches the query, sorted by name. The self user is not included.
+    ///
+    /// - Parameters:
+    ///   - query: search string matched against the name and handle of the users
+    ///   - offset: the number of matching members to skip
+    ///   - limit: the maximum number of members to return
+    public func members(matchingQuery query: String, offset: Int, limit: Int) -> [Member] {
+        guard let context = managedObjectContext else { return [] }
+        return context.teamMemberDirectory.members(of: self, matching: query, offset: offset, limit: limit)
+    }
+
+    /// Returns the number of members whose user matches the query. The self user is not included.
+    public func numberOfMembers(matchingQuery query: String) -> Int {
+        guard let context = managedObjectContext else { return 0 }
+        return context.teamMemberDirectory.numberOfMembers(of: self, matching: query)
     }
 }
 
@@ -119,6 +130,8 @@ extension Team {
 
         set {
             defer {
+                managedObjectContext?.assetDownloadWorkIndex.update(self, kind: .teamLogo)
+
                 if let uiContext = managedObjectContext?.zm_userInterface {
                     // Notify about a non core data change since the image is persisted in the file cache
                     NotificationDispatcher.notifyNonCoreDataChanges(objectID: objectID, changedKeys: [#keyPath(Team.imageData)], uiContext: uiContext)
@@ -143,12 +156,7 @@ extension Team {
     }
 
     public static var imageDownloadFilter: NSPredicate {
-        let assetIdExists = NSPredicate(format: "(%K != nil)", Team.pictureAssetIdKey)
-        let notCached = NSPredicate { (team, _) -> Bool in
-            guard let team = team as? Team else { return false }
-            return team.imageData == nil
-        }
-        return NSCompoundPredicate(andPredicateWithSubpredicates: [assetIdExists, notCached])
+        return AssetDownloadKind.teamLogo.downloadFilter
     }
 
 }
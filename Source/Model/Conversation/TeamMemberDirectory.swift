@@ -0,0 +1,408 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let TeamMemberDirectoryKey = "TeamMemberDirectoryKey"
+
+    var teamMemberDirectory: TeamMemberDirectory {
+        if let directory = userInfo[NSManagedObjectContext.TeamMemberDirectoryKey] as? TeamMemberDirectory {
+            return directory
+        }
+
+        let directory = TeamMemberDirectory(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.TeamMemberDirectoryKey] = directory
+        return directory
+    }
+
+}
+
+/// Keeps the members of teams sorted by name, so searching them doesn't fault and sort the whole team.
+///
+/// The roster of a team only holds the object IDs of its members and users and the names of the users. It's
+/// fetched as dictionaries the first time the team is searched and then updated in place when members are
+/// added or removed and when users are renamed. Queries are matched with the search name index and only the
+/// members of the requested page are fetched. The matches of the last query are kept until the context
+/// changes, so reading the following pages or counting the matches doesn't match the roster again.
+
+final class TeamMemberDirectory: NSObject, TearDownCapable {
+
+    private struct Row {
+        let memberID: NSManagedObjectID
+        let userID: NSManagedObjectID
+        let normalizedName: String?
+    }
+
+    private final class Roster {
+
+        private(set) var rows: [Row]
+
+        /// Rows of unsaved members or users, their IDs change when the context saves them.
+        private(set) var hasTemporaryIDs: Bool
+
+        init(rows: [Row]) {
+            self.rows = rows.sorted { Roster.isOrderedBefore($0.normalizedName, $1.normalizedName) }
+            self.hasTemporaryIDs = rows.contains(where: Roster.containsTemporaryIDs)
+        }
+
+        func insert(_ row: Row) {
+            rows.insert(row, at: upperBound(of: row.normalizedName))
+            hasTemporaryIDs = hasTemporaryIDs || Roster.containsTemporaryIDs(row)
+        }
+
+        func remove(_ memberID: NSManagedObjectID, normalizedName: String?) {
+            var index = lowerBound(of: normalizedName)
+
+            while index < rows.count, !Roster.isOrderedBefore(normalizedName, rows[index].normalizedName) {
+                if rows[index].memberID == memberID {
+                    rows.remove(at: index)
+                    return
+                }
+                index += 1
+            }
+        }
+
+        private static func containsTemporaryIDs(_ row: Row) -> Bool {
+            return row.memberID.isTemporaryID || row.userID.isTemporaryID
+        }
+
+        private func lowerBound(of name: String?) -> Int {
+            return partitioningIndex { !Roster.isOrderedBefore($0, name) }
+        }
+
+        private func upperBound(of name: String?) -> Int {
+            return partitioningIndex { Roster.isOrderedBefore(name, $0) }
+        }
+
+        private func partitioningIndex(where belongsToSecondPartition: (String?) -> Bool) -> Int {
+            var low = 0
+            var high = rows.count
+
+            while low < high {
+                let mid = (low + high) / 2
+                if belongsToSecondPartition(rows[mid].normalizedName) {
+                    high = mid
+                } else {
+                    low = mid + 1
+                }
+            }
+
+            return low
+        }
+
+        /// Users without a name come first, like they did when the members were sorted on every search.
+        /// Names are compared like the `NSSortDescriptor` on `normalizedName` compares them, which doesn't
+        /// always agree with `String`'s own ordering.
+        private static func isOrderedBefore(_ lhs: String?, _ rhs: String?) -> Bool {
+            switch (lhs, rhs) {
+            case let (lhs?, rhs?):
+                return (lhs as NSString).compare(rhs) == .orderedAscending
+            case (nil, .some):
+                return true
+            default:
+                return false
+            }
+        }
+
+    }
+
+    private struct Placement {
+        let teamID: NSManagedObjectID
+        let userID: NSManagedObjectID
+        let normalizedName: String?
+    }
+
+    private struct Matches {
+        let teamID: NSManagedObjectID
+        let query: String
+        let memberIDs: [NSManagedObjectID]
+    }
+
+    private var rosters: [NSManagedObjectID: Roster] = [:]
+    private var placements: [NSManagedObjectID: Placement] = [:]
+    private var lastMatches: Matches?
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        super.init()
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] _ in
+                self?.contextDidSave()
+            }
+        ]
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach { NotificationCenter.default.removeObserver($0) }
+        observerTokens = []
+        invalidateAll()
+    }
+
+    // MARK: - Queries
+
+    /// Returns the members of the team whose user matches the query, sorted by name and without the self user.
+    ///
+    /// - Parameters:
+    ///   - offset: the number of matching members to skip
+    ///   - limit: the maximum number of members to return
+    func members(of team: Team, matching query: String, offset: Int = 0, limit: Int = .max) -> [Member] {
+        guard limit > 0, offset >= 0 else { return [] }
+
+        let page = matchingMemberIDs(of: team, query: query).dropFirst(offset).prefix(limit)
+        return fetchMembers(with: Array(page))
+    }
+
+    /// Returns the number of members of the team whose user matches the query, without the self user.
+    func numberOfMembers(of team: Team, matching query: String) -> Int {
+        return matchingMemberIDs(of: team, query: query).count
+    }
+
+    private func matchingMemberIDs(of team: Team, query: String) -> [NSManagedObjectID] {
+        if let matches = lastMatches, matches.teamID == team.objectID, matches.query == query {
+            return matches.memberIDs
+        }
+
+        let isMatch = matcher(for: query)
+        let memberIDs = roster(for: team).rows.lazy.filter { isMatch($0.userID) }.map(\.memberID)
+        let matches = Matches(teamID: team.objectID, query: query, memberIDs: Array(memberIDs))
+        lastMatches = matches
+        return matches.memberIDs
+    }
+
+    /// Matches users like `ZMUser.predicateForAllUsers(withSearch:)`, using the search name index for saved users.
+    private func matcher(for query: String) -> (NSManagedObjectID) -> Bool {
+        let selfUserID = managedObjectContext.map(ZMUser.selfUser)?.objectID
+
+        guard !query.isEmpty, let context = managedObjectContext else {
+            return { $0 != selfUserID }
+        }
+
+        let index = context.searchNameIndex
+        var matches = index.objectIDs(matching: query, in: [.userName])
+        matches.formUnion(index.objectIDs(withTokenPrefix: query.strippingLeadingAtSign(), in: .userHandle))
+
+        // Users which aren't saved yet aren't in the search name index
+        let predicate = ZMUser.predicateForAllUsers(withSearch: query)
+
+        return { userID in
+            guard userID != selfUserID else { return false }
+            guard userID.isTemporaryID else { return matches.contains(userID) }
+            return context.registeredObject(for: userID).map { predicate.evaluate(with: $0) } ?? false
+        }
+    }
+
+    /// Returns the members in the order of the IDs, fetching the ones which aren't loaded in one request.
+    private func fetchMembers(with memberIDs: [NSManagedObjectID]) -> [Member] {
+        guard let context = managedObjectContext, !memberIDs.isEmpty else { return [] }
+
+        var membersByID: [NSManagedObjectID: Member] = [:]
+        var missing: [NSManagedObjectID] = []
+
+        for memberID in memberIDs {
+            if let member = context.registeredObject(for: memberID) as? Member, !member.isFault {
+                membersByID[memberID] = member
+            } else {
+                missing.append(memberID)
+            }
+        }
+
+        if !missing.isEmpty {
+            let request = NSFetchRequest<Member>(entityName: Member.entityName())
+            request.predicate = NSPredicate(format: "SELF IN %@", missing)
+            request.returnsObjectsAsFaults = false
+            request.relationshipKeyPathsForPrefetching = [#keyPath(Member.user)]
+
+            context.fetchOrAssert(request: request).forEach { membersByID[$0.objectID] = $0 }
+        }
+
+        return memberIDs.compactMap { membersByID[$0] }
+    }
+
+    private func roster(for team: Team) -> Roster {
+        if let roster = rosters[team.objectID] {
+            return roster
+        }
+
+        let rows = fetchRows(of: team)
+        rows.forEach { placements[$0.memberID] = Placement(teamID: team.objectID, userID: $0.userID, normalizedName: $0.normalizedName) }
+
+        let roster = Roster(rows: rows)
+        rosters[team.objectID] = roster
+        return roster
+    }
+
+    /// Fetches the saved members of the team as dictionaries, members and users with unsaved changes are read
+    /// from the context instead.
+    private func fetchRows(of team: Team) -> [Row] {
+        guard let context = managedObjectContext else { return [] }
+
+        let objectIDExpression = NSExpressionDescription()
+        objectIDExpression.name = "objectID"
+        objectIDExpression.expression = NSExpression.expressionForEvaluatedObject()
+        objectIDExpression.expressionResultType = .objectIDAttributeType
+
+        let userNameKey = "\(#keyPath(Member.user)).\(#keyPath(ZMUser.normalizedName))"
+
+        let request = NSFetchRequest<NSDictionary>(entityName: Member.entityName())
+        request.resultType = .dictionaryResultType
+        request.predicate = NSPredicate(format: "%K == %@", #keyPath(Member.team), team)
+        request.propertiesToFetch = [objectIDExpression, #keyPath(Member.user), userNameKey]
+
+        var rows: [Row] = []
+        var changedMembers: [Member] = []
+        let results = team.objectID.isTemporaryID ? [] : context.fetchOrAssert(request: request)
+
+        for result in results {
+            guard
+                let memberID = result["objectID"] as? NSManagedObjectID,
+                let userID = result[#keyPath(Member.user)] as? NSManagedObjectID
+            else { continue }
+
+            if context.registeredObject(for: memberID)?.hasChanges == true || context.registeredObject(for: userID)?.hasChanges == true {
+                if let member = context.object(with: memberID) as? Member {
+                    changedMembers.append(member)
+                }
+                continue
+            }
+
+            rows.append(Row(memberID: memberID, userID: userID, normalizedName: result[userNameKey] as? String))
+        }
+
+        // Unsaved members aren't in the store yet, or not in the team
+        let pendingMembers = context.insertedObjects.union(context.updatedObjects).lazy.compactMap { $0 as? Member }
+        changedMembers.append(contentsOf: pendingMembers)
+
+        var addedMemberIDs = Set<NSManagedObjectID>()
+
+        for member in changedMembers where !member.isDeleted && member.team == team && addedMemberIDs.insert(member.objectID).inserted {
+            guard let user = member.user else { continue }
+            rows.append(Row(memberID: member.objectID, userID: user.objectID, normalizedName: user.normalizedName))
+        }
+
+        return rows
+    }
+
+    // MARK: - Updates
+
+    /// Moves the member to the roster of its current team, using its user's current name.
+    func memberDidChange(_ member: Member) {
+        guard !rosters.isEmpty else { return }
+
+        let team = member.isDeleted ? nil : member.team
+        let user = member.user
+
+        if let placement = placements[member.objectID],
+           placement.teamID == team?.objectID,
+           placement.userID == user?.objectID,
+           placement.normalizedName == user?.normalizedName {
+            return
+        }
+
+        remove(member.objectID)
+        lastMatches = nil
+
+        guard let newTeam = team, let newUser = user, let roster = rosters[newTeam.objectID] else { return }
+
+        let row = Row(memberID: member.objectID, userID: newUser.objectID, normalizedName: newUser.normalizedName)
+        roster.insert(row)
+        placements[member.objectID] = Placement(teamID: newTeam.objectID, userID: newUser.objectID, normalizedName: row.normalizedName)
+    }
+
+    func nameDidChange(of user: ZMUser) {
+        guard !rosters.isEmpty, let member = user.membership else { return }
+        memberDidChange(member)
+    }
+
+    private func remove(_ memberID: NSManagedObjectID) {
+        guard let placement = placements.removeValue(forKey: memberID) else { return }
+        rosters[placement.teamID]?.remove(memberID, normalizedName: placement.normalizedName)
+        lastMatches = nil
+    }
+
+    private func remove(team teamID: NSManagedObjectID) {
+        guard let roster = rosters.removeValue(forKey: teamID) else { return }
+        roster.rows.forEach { placements.removeValue(forKey: $0.memberID) }
+        lastMatches = nil
+    }
+
+    func invalidateAll() {
+        rosters = [:]
+        placements = [:]
+        lastMatches = nil
+    }
+
+    /// Drops the rosters holding temporary IDs, they are fetched again with the permanent IDs.
+    private func contextDidSave() {
+        for (teamID, roster) in rosters where teamID.isTemporaryID || roster.hasTemporaryIDs {
+            remove(team: teamID)
+        }
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        // Matches depend on the search name index, which changes with any user
+        lastMatches = nil
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard !rosters.isEmpty else { return }
+
+        // Relationships set from the other side and merged changes don't go through the model hooks
+        for key in [NSInsertedObjectsKey, NSUpdatedObjectsKey, NSRefreshedObjectsKey, NSDeletedObjectsKey] {
+            guard let objects = userInfo[key] as? Set<NSManagedObject> else { continue }
+
+            for object in objects {
+                switch object {
+                case let member as Member:
+                    memberDidChange(member)
+                case let user as ZMUser where key == NSRefreshedObjectsKey:
+                    nameDidChange(of: user)
+                case let team as Team where key == NSDeletedObjectsKey:
+                    remove(team: team.objectID)
+                default:
+                    break
+                }
+            }
+        }
+
+        if let invalidated = userInfo[NSInvalidatedObjectsKey] as? Set<NSManagedObject> {
+            invalidated.lazy.compactMap { $0 as? Member }.forEach { remove($0.objectID) }
+        }
+    }
+
+}
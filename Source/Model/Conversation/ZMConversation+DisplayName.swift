@@ -79,7 +79,18 @@ public extension ZMConversation {
             return userDefined
         }
 
-        let activeNames: [String] = localParticipants.compactMap { (user) -> String? in
+        guard let context = managedObjectContext else {
+            return participantsGroupName(localParticipants, selfUser: nil)
+        }
+
+        let selfUser = self.selfUser
+        return context.conversationParticipantIndex.groupName(for: self) { entry in
+            participantsGroupName(entry.members, selfUser: selfUser)
+        }
+    }
+
+    private func participantsGroupName(_ participants: Set<ZMUser>, selfUser: ZMUser?) -> String? {
+        let activeNames: [String] = participants.compactMap { (user) -> String? in
             guard user != selfUser else { return nil }
             return user.name
         }
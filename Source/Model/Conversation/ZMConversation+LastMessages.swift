@@ -53,17 +53,29 @@ extension ZMConversation {
 
     /// Returns the most recent message in the conversation.
     @objc public var lastMessage: ZMConversationMessage? {
-        return lastMessages(limit: 1).first
+        return managedObjectContext?.conversationLastMessageCache.lastMessage(in: self)
     }
 
     /// Returns the most recent message sent by a particular user in the conversation.
     public func lastMessageSent(by user: ZMUser) -> ZMMessage? {
+        return managedObjectContext?.conversationLastMessageCache.lastMessage(sentBy: user, in: self)
+    }
+
+    /// Fetches the most recent message in the conversation, optionally sent by a particular user.
+    func fetchLastMessage(sentBy user: ZMUser?) -> ZMMessage? {
+        guard let managedObjectContext = managedObjectContext else { return nil }
+
+        var predicates = [NSPredicate(format: "%K == %@", #keyPath(ZMMessage.visibleInConversation), self)]
+        if let user = user {
+            predicates.append(NSPredicate(format: "%K == %@", #keyPath(ZMMessage.sender), user))
+        }
+
         let fetchRequest = NSFetchRequest<ZMMessage>(entityName: ZMMessage.entityName())
         fetchRequest.fetchLimit = 1
-        fetchRequest.predicate = NSPredicate(format: "%K == %@ AND %K == %@", #keyPath(ZMMessage.visibleInConversation), self, #keyPath(ZMMessage.sender), user)
+        fetchRequest.predicate = NSCompoundPredicate(andPredicateWithSubpredicates: predicates)
         fetchRequest.sortDescriptors = [NSSortDescriptor(key: #keyPath(ZMMessage.serverTimestamp), ascending: false)]
 
-        return self.managedObjectContext?.fetchOrAssert(request: fetchRequest).first
+        return managedObjectContext.fetchOrAssert(request: fetchRequest).first
     }
 
 }
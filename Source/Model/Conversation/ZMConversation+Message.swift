@@ -158,6 +158,12 @@ extension ZMConversation {
             $0.quote = quotedMessage as? ZMMessage
         })
 
+        // Text without links has nothing to preview or attach, the analysis is shared with the categorization
+        if fetchLinkPreview, clientMessage.textAnalysis?.containsLinks == false {
+            clientMessage.linkPreviewState = .done
+            clientMessage.needsLinkAttachmentsUpdate = false
+        }
+
         if let notificationContext = managedObjectContext?.notificationContext {
             NotificationInContext(name: ZMConversation.clearTypingNotificationName,
                                   context: notificationContext,
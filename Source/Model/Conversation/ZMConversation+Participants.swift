@@ -75,7 +75,11 @@ extension ZMConversation {
     }
 
     @objc public var sortedActiveParticipants: [ZMUser] {
-        return sortedUsers(localParticipants)
+        guard let context = managedObjectContext else {
+            return sortedUsers(localParticipants)
+        }
+
+        return context.conversationParticipantIndex.entry(for: self).roster
     }
 
     /// Whether the roles defined for this conversation should be re-downloaded
@@ -83,9 +87,13 @@ extension ZMConversation {
 
     @objc
     public var isSelfAnActiveMember: Bool {
-        return self.participantRoles.contains(where: { (role) -> Bool in
-            role.user?.isSelfUser == true
-        })
+        guard let context = managedObjectContext else {
+            return self.participantRoles.contains(where: { (role) -> Bool in
+                role.user?.isSelfUser == true
+            })
+        }
+
+        return context.conversationParticipantIndex.entry(for: self).containsSelfUser
     }
     // MARK: - keyPathsForValuesAffecting
 
@@ -181,7 +189,11 @@ extension ZMConversation {
     /// even if that state is not yet synchronized with the backend
     @objc
     public var localParticipants: Set<ZMUser> {
-        return Set(localParticipantRoles.compactMap { $0.user })
+        guard let context = managedObjectContext else {
+            return Set(localParticipantRoles.compactMap { $0.user })
+        }
+
+        return context.conversationParticipantIndex.entry(for: self).members
     }
 
     /// Participants that are in the conversation, according to the local state
@@ -242,17 +254,23 @@ extension ZMConversation {
         // Is this a new conversation, or an existing one that is being updated?
         let doesExistsOnBackend = self.remoteIdentifier != nil
 
-        let addedRoles = usersAndRoles.compactMap { (user, role) -> ParticipantRole? in
-            guard !user.isAccountDeleted else { return nil }
+        var addedRoles: [ParticipantRole] = []
 
-            // make sure the role is the right team/conversation role
-            require(
-                role == nil || (role!.team == self.team || role!.conversation == self),
-                "Tried to add a role that does not belong to the conversation"
-            )
+        performIncrementalParticipantUpdate {
+            addedRoles = usersAndRoles.compactMap { (user, role) -> ParticipantRole? in
+                guard !user.isAccountDeleted else { return nil }
 
-            guard let (result, pr) = updateExistingOrCreateParticipantRole(for: user, with: role) else { return nil }
-            return (result == .created) ? pr : nil
+                // make sure the role is the right team/conversation role
+                require(
+                    role == nil || (role!.team == self.team || role!.conversation == self),
+                    "Tried to add a role that does not belong to the conversation"
+                )
+
+                guard let (result, pr) = updateExistingOrCreateParticipantRole(for: user, with: role) else { return nil }
+                return (result == .created) ? pr : nil
+            }
+
+            managedObjectContext?.conversationParticipantIndex.insert(addedRoles.compactMap(\.user), into: self)
         }
 
         let addedSelfUser = doesExistsOnBackend && addedRoles.contains(where: {$0.user?.isSelfUser == true})
@@ -267,6 +285,14 @@ extension ZMConversation {
         }
     }
 
+    private func performIncrementalParticipantUpdate(_ block: () -> Void) {
+        guard let context = managedObjectContext else {
+            return block()
+        }
+
+        context.conversationParticipantIndex.performIncrementalUpdate(block)
+    }
+
     private enum FetchOrCreation {
         case fetched
         case created
@@ -329,17 +355,22 @@ extension ZMConversation {
 
         guard let moc = self.managedObjectContext else { return }
         let existingUsers = Set(self.participantRoles.map { $0.user })
+        var removedUsers = Set<ZMUser>()
+
+        performIncrementalParticipantUpdate {
+            removedUsers = Set(users.compactMap { user -> ZMUser? in
 
-        let removedUsers = Set(users.compactMap { user -> ZMUser? in
+                guard existingUsers.contains(user),
+                    let existingRole = participantRoles.first(where: { $0.user == user })
+                    else { return nil }
 
-            guard existingUsers.contains(user),
-                let existingRole = participantRoles.first(where: { $0.user == user })
-                else { return nil }
+                participantRoles.remove(existingRole)
+                moc.delete(existingRole)
+                return user
+            })
 
-            participantRoles.remove(existingRole)
-            moc.delete(existingRole)
-            return user
-        })
+            moc.conversationParticipantIndex.remove(removedUsers, from: self)
+        }
 
         if !removedUsers.isEmpty {
             let removedSelf = removedUsers.contains(where: { $0.isSelfUser })
@@ -30,18 +30,54 @@ extension ZMConversation {
 
         let convoNameMatching = userDefinedNamePredicate(forSearch: searchQuery)
 
+        let userNamesMatching = predicateForConversationWithUsers(
+            matchingQuery: searchQuery,
+            selfUser: selfUser
+        )
+
+        return predicate(forQueryMatching: [userNamesMatching, convoNameMatching], selfUser: selfUser)
+    }
+
+    /// Same as `predicate(forSearchQuery:selfUser:)`, but the conversation and participant names are
+    /// matched through the search name index instead of evaluating regular expressions on every row.
+    public class func predicate(forSearchQuery searchQuery: String,
+                                selfUser: ZMUser,
+                                in context: NSManagedObjectContext) -> NSPredicate {
+        let index = context.searchNameIndex
+        let normalizedQuery = searchQuery.normalizedForSearch() as String
+        let conversations = index.objectIDs(matching: normalizedQuery, in: [.conversationName])
+        let users = index.objectIDs(matchingAnyWordOf: searchQuery, in: .userName)
+
+        // Evaluating the regular expressions is cheaper than listing too many matches
+        let convoNameMatching: NSPredicate
+        if conversations.count > SearchNameIndex.maximumPredicateMatchCount {
+            convoNameMatching = userDefinedNamePredicate(forSearch: searchQuery)
+        } else {
+            convoNameMatching = NSPredicate(format: "SELF IN %@", conversations.map(context.object(with:)))
+        }
+
+        let userNamesMatching: NSPredicate
+        if users.count > SearchNameIndex.maximumPredicateMatchCount {
+            userNamesMatching = predicateForConversationWithUsers(matchingQuery: searchQuery, selfUser: selfUser)
+        } else {
+            userNamesMatching = NSPredicate(format: "SUBQUERY(%K, $role, $role.user != %@ AND $role.user IN %@).@count > 0",
+                                            ZMConversationParticipantRolesKey,
+                                            selfUser,
+                                            users.map(context.object(with:)))
+        }
+
+        return predicate(forQueryMatching: [userNamesMatching, convoNameMatching], selfUser: selfUser)
+    }
+
+    private class func predicate(forQueryMatching queryPredicates: [NSPredicate], selfUser: ZMUser) -> NSPredicate {
         let selfUserIsMember = NSPredicate(format: "%K == NULL OR (ANY %K.user == %@)", ZMConversationClearedTimeStampKey, ZMConversationParticipantRolesKey, selfUser)
 
         let groupOnly = NSPredicate(format: "(\(ZMConversationConversationTypeKey) == \(ZMConversationType.group.rawValue))")
 
         let notTeamOneToOne = NSCompoundPredicate(notPredicateWithSubpredicate: predicateForTeamOneToOneConversation())
 
-        let userNamesMatching = predicateForConversationWithUsers(
-            matchingQuery: searchQuery,
-            selfUser: selfUser
-        )
         let queryMatching = NSCompoundPredicate(
-            orPredicateWithSubpredicates: [userNamesMatching, convoNameMatching])
+            orPredicateWithSubpredicates: queryPredicates)
 
         return NSCompoundPredicate(andPredicateWithSubpredicates: [
             queryMatching,
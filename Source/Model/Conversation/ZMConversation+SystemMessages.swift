@@ -20,28 +20,31 @@ import Foundation
 
 extension ZMConversation {
 
+    // Session resets and users leaving often come in bursts, they're compacted into one message per burst,
+    // see `ZMSystemMessage+Compaction.swift`.
+
     public func appendSessionResetSystemMessage(user: ZMUser, client: UserClient, at timestamp: Date) {
-        appendSystemMessage(type: .sessionReset,
-                            sender: user,
-                            users: [],
-                            clients: [client],
-                            timestamp: timestamp)
+        appendCompactedSystemMessage(type: .sessionReset,
+                                     sender: user,
+                                     users: [],
+                                     clients: [client],
+                                     timestamp: timestamp)
     }
 
     public func appendTeamMemberRemovedSystemMessage(user: ZMUser, at timestamp: Date) {
-        appendSystemMessage(type: .teamMemberLeave,
-                            sender: user,
-                            users: [user],
-                            clients: nil,
-                            timestamp: timestamp)
+        appendCompactedSystemMessage(type: .teamMemberLeave,
+                                     sender: user,
+                                     users: [user],
+                                     clients: [],
+                                     timestamp: timestamp)
     }
 
     public func appendParticipantRemovedSystemMessage(user: ZMUser, sender: ZMUser? = nil, at timestamp: Date) {
-        appendSystemMessage(type: .participantsRemoved,
-                            sender: sender ?? user,
-                            users: [user],
-                            clients: nil,
-                            timestamp: timestamp)
+        appendCompactedSystemMessage(type: .participantsRemoved,
+                                     sender: sender ?? user,
+                                     users: [user],
+                                     clients: [],
+                                     timestamp: timestamp)
     }
 
     @objc(appendNewConversationSystemMessageAtTimestamp:users:)
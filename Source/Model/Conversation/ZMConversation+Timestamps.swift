@@ -257,7 +257,7 @@ extension ZMConversation {
     }
 
     /// Perform the an mark-as-read update by updating the last-read timestamp and
-    /// create read confirmations for the newly read messages.
+    /// enqueue read confirmations for the newly read messages, see `ReadReceiptCoalescer`.
     ///
     /// - Parameters:
     ///     - range: The range of time in which all messages should be considered read.
@@ -276,10 +276,17 @@ extension ZMConversation {
         let objectID = self.objectID
 
         syncMOC.performGroupedBlock {
-            let conversation = syncMOC.object(with: objectID) as? ZMConversation
-            conversation?.confirmUnreadMessagesAsRead(in: range)
-            conversation?.updateLastRead(range.upperBound, synchronize: true)
-            syncMOC.saveOrRollback()
+            guard let conversation = syncMOC.object(with: objectID) as? ZMConversation else { return }
+
+            let coalescer = syncMOC.readReceiptCoalescer
+            coalescer.enqueueUnreadMessages(of: conversation, in: range)
+
+            // Deferred while read confirmations are pending, so both are saved together by the next flush
+            coalescer.enqueueLastRead(range.upperBound, of: conversation)
+
+            if !coalescer.hasPendingConfirmations(in: conversation) {
+                syncMOC.saveOrRollback()
+            }
         }
     }
 
@@ -0,0 +1,431 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let ConversationPermissionCacheKey = "ConversationPermissionCacheKey"
+
+    var conversationPermissionCache: ConversationPermissionCache {
+        if let cache = userInfo[NSManagedObjectContext.ConversationPermissionCacheKey] as? ConversationPermissionCache {
+            return cache
+        }
+
+        let cache = ConversationPermissionCache(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.ConversationPermissionCacheKey] = cache
+        return cache
+    }
+
+}
+
+/// Caches the actions a user is allowed to perform in a conversation.
+///
+/// The effective mask of a user in a conversation is the action mask of the user's role if the self
+/// user is an active member of the conversation, and empty otherwise. Masks of a conversation are
+/// dropped when one of its participant roles changes, masks of a user when the user's participant roles
+/// change and masks derived from a role when its actions change. Updates which don't change any of these,
+/// e.g. a new message in the conversation, keep the masks. Masks held under temporary object IDs are dropped
+/// once the context saves.
+///
+/// Changes merged from other contexts only reach the objects registered in this context, so the saves of
+/// the other contexts of the store are observed as well. Their changed keys are read before the save and the
+/// masks are dropped once it's done.
+
+final class ConversationPermissionCache: NSObject, TearDownCapable {
+
+    private struct Key: Hashable {
+        let user: NSManagedObjectID
+        let conversation: NSManagedObjectID
+    }
+
+    private struct CachedMask {
+        let mask: ConversationActionMask
+        let role: NSManagedObjectID?
+    }
+
+    /// The objects whose masks have to be dropped after a change.
+    private struct Invalidation {
+        var conversations = Set<NSManagedObjectID>()
+        var users = Set<NSManagedObjectID>()
+        var roles = Set<NSManagedObjectID>()
+
+        var isEmpty: Bool {
+            return conversations.isEmpty && users.isEmpty && roles.isEmpty
+        }
+
+        mutating func formUnion(_ other: Invalidation) {
+            conversations.formUnion(other.conversations)
+            users.formUnion(other.users)
+            roles.formUnion(other.roles)
+        }
+    }
+
+    private static let participantRoleKeys: Set<String> = [#keyPath(ParticipantRole.conversation),
+                                                           #keyPath(ParticipantRole.user),
+                                                           #keyPath(ParticipantRole.role)]
+    private static let actionKeys: Set<String> = [Action.nameKey, Action.roleKey]
+
+    private var roleMasks: [NSManagedObjectID: ConversationActionMask] = [:]
+    private var effectiveMasks: [Key: CachedMask] = [:]
+    private var keysByConversation: [NSManagedObjectID: Set<Key>] = [:]
+    private var keysByUser: [NSManagedObjectID: Set<Key>] = [:]
+    private var keysByRole: [NSManagedObjectID: Set<Key>] = [:]
+    private var hasTemporaryIDs = false
+
+    /// The invalidations of saves of other contexts in progress, by saving context. Guarded by `savesLock`.
+    private var pendingSaves: [ObjectIdentifier: Invalidation] = [:]
+    private let savesLock = NSLock()
+
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private weak var persistentStoreCoordinator: NSPersistentStoreCoordinator?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        self.persistentStoreCoordinator = managedObjectContext.persistentStoreCoordinator
+        super.init()
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextWillSave,
+                                                   object: nil,
+                                                   queue: nil) { [weak self] note in
+                self?.contextWillSave(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: nil,
+                                                   queue: nil) { [weak self] note in
+                self?.contextDidSave(note)
+            }
+        ]
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach { NotificationCenter.default.removeObserver($0) }
+        observerTokens = []
+    }
+
+    // MARK: - Lookup
+
+    func effectiveMask(of user: ZMUser, in conversation: ZMConversation) -> ConversationActionMask {
+        let key = Key(user: user.objectID, conversation: conversation.objectID)
+
+        if let cached = effectiveMasks[key] {
+            return cached.mask
+        }
+
+        let cached = computeEffectiveMask(of: user, in: conversation)
+        effectiveMasks[key] = cached
+        keysByConversation[key.conversation, default: []].insert(key)
+        keysByUser[key.user, default: []].insert(key)
+        if let role = cached.role {
+            keysByRole[role, default: []].insert(key)
+        }
+        hasTemporaryIDs = hasTemporaryIDs || key.user.isTemporaryID || key.conversation.isTemporaryID || cached.role?.isTemporaryID == true
+        return cached.mask
+    }
+
+    private func computeEffectiveMask(of user: ZMUser, in conversation: ZMConversation) -> CachedMask {
+        guard conversation.isSelfAnActiveMember, let role = user.role(in: conversation) else {
+            return CachedMask(mask: [], role: nil)
+        }
+
+        return CachedMask(mask: mask(of: role), role: role.objectID)
+    }
+
+    private func mask(of role: Role) -> ConversationActionMask {
+        if let mask = roleMasks[role.objectID] {
+            return mask
+        }
+
+        let mask = ConversationActionMask(actionNames: role.actions.map(\.name))
+        roleMasks[role.objectID] = mask
+        return mask
+    }
+
+    // MARK: - Invalidation
+
+    /// Drops the cached masks of all users in the given conversation.
+    func invalidate(_ conversation: ZMConversation) {
+        removeKeys(keysByConversation[conversation.objectID])
+    }
+
+    /// Drops the cached masks of the given user in all conversations.
+    func invalidate(_ user: ZMUser) {
+        removeKeys(keysByUser[user.objectID])
+    }
+
+    /// Drops the cached masks derived from the actions of the given role.
+    func invalidate(_ role: Role) {
+        invalidateRole(with: role.objectID)
+    }
+
+    /// Drops the masks of the user, and of the conversations the user is or was a participant of.
+    func participantRolesDidChange(of user: ZMUser) {
+        var invalidation = Invalidation()
+        invalidation.users.insert(user.objectID)
+
+        let committed = user.committedValues(forKeys: [#keyPath(ZMUser.participantRoles)])[#keyPath(ZMUser.participantRoles)] as? Set<ParticipantRole>
+        for participantRole in user.participantRoles.union(committed ?? []) {
+            if let conversation = participantRole.conversation {
+                invalidation.conversations.insert(conversation.objectID)
+            }
+        }
+
+        apply(invalidation)
+    }
+
+    func invalidateAll() {
+        roleMasks = [:]
+        effectiveMasks = [:]
+        keysByConversation = [:]
+        keysByUser = [:]
+        keysByRole = [:]
+        hasTemporaryIDs = false
+    }
+
+    private func invalidateRole(with objectID: NSManagedObjectID) {
+        roleMasks.removeValue(forKey: objectID)
+        removeKeys(keysByRole[objectID])
+    }
+
+    private func apply(_ invalidation: Invalidation) {
+        invalidation.conversations.forEach { removeKeys(keysByConversation[$0]) }
+        invalidation.users.forEach { removeKeys(keysByUser[$0]) }
+        invalidation.roles.forEach(invalidateRole)
+    }
+
+    private func removeKeys(_ keys: Set<Key>?) {
+        for key in keys ?? [] {
+            guard let cached = effectiveMasks.removeValue(forKey: key) else { continue }
+
+            ConversationPermissionCache.remove(key, for: key.conversation, from: &keysByConversation)
+            ConversationPermissionCache.remove(key, for: key.user, from: &keysByUser)
+            if let role = cached.role {
+                ConversationPermissionCache.remove(key, for: role, from: &keysByRole)
+            }
+        }
+    }
+
+    private static func remove(_ key: Key, for objectID: NSManagedObjectID, from keys: inout [NSManagedObjectID: Set<Key>]) {
+        keys[objectID]?.remove(key)
+
+        if keys[objectID]?.isEmpty == true {
+            keys.removeValue(forKey: objectID)
+        }
+    }
+
+    // MARK: - Changes
+
+    /// Collects the objects whose masks depend on the given changes. Updated objects only count if one of
+    /// the keys the masks depend on changed.
+    ///
+    /// Refreshed conversations and users are skipped: a merged save refreshes them for any change, e.g. a new
+    /// message, while a change of their participants also refreshes or deletes the participant roles involved.
+    private static func invalidation(for objectsByKey: [String: Set<NSManagedObject>],
+                                     changedKeys: (NSManagedObject) -> Set<String>) -> Invalidation {
+        var invalidation = Invalidation()
+
+        for (key, objects) in objectsByKey {
+            let isUpdate = key == NSUpdatedObjectsKey
+
+            for object in objects {
+                let keys = isUpdate ? changedKeys(object) : nil
+                let isInsertOrRefresh = key == NSInsertedObjectsKey || key == NSRefreshedObjectsKey
+
+                func changed(_ relevantKeys: Set<String>) -> Bool {
+                    return keys.map { !$0.isDisjoint(with: relevantKeys) } ?? true
+                }
+
+                switch object {
+                case let role as Role:
+                    // Inserted roles have no masks yet
+                    if key != NSInsertedObjectsKey, changed(Role.permissionKeys) {
+                        invalidation.roles.insert(role.objectID)
+                    }
+                case let action as Action:
+                    if changed(actionKeys) {
+                        relatedObjectIDs(of: action, forKey: Action.roleKey).forEach { invalidation.roles.insert($0) }
+                    }
+                case let participantRole as ParticipantRole:
+                    if changed(participantRoleKeys) {
+                        let conversations = relatedObjectIDs(of: participantRole, forKey: #keyPath(ParticipantRole.conversation))
+                        invalidation.conversations.formUnion(conversations)
+                    }
+                case let conversation as ZMConversation:
+                    if !isInsertOrRefresh, changed([#keyPath(ZMConversation.participantRoles)]) {
+                        invalidation.conversations.insert(conversation.objectID)
+                    }
+                case let user as ZMUser:
+                    if !isInsertOrRefresh, changed([#keyPath(ZMUser.participantRoles)]) {
+                        invalidation.users.insert(user.objectID)
+                    }
+                default:
+                    break
+                }
+            }
+        }
+
+        return invalidation
+    }
+
+    /// The current and the last saved object of a to-one relationship, the current one is gone once deleted.
+    private static func relatedObjectIDs(of object: NSManagedObject, forKey key: String) -> Set<NSManagedObjectID> {
+        let current = object.isDeleted ? nil : object.value(forKey: key) as? NSManagedObject
+        let committed = object.objectID.isTemporaryID ? nil : object.committedValues(forKeys: [key])[key] as? NSManagedObject
+        return Set([current, committed].compactMap { $0?.objectID })
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard !effectiveMasks.isEmpty || !roleMasks.isEmpty else { return }
+
+        let keys = [NSInsertedObjectsKey, NSUpdatedObjectsKey, NSRefreshedObjectsKey, NSDeletedObjectsKey, NSInvalidatedObjectsKey]
+        let objectsByKey = keys.reduce(into: [String: Set<NSManagedObject>]()) { result, key in
+            result[key] = userInfo[key] as? Set<NSManagedObject>
+        }
+
+        apply(ConversationPermissionCache.invalidation(for: objectsByKey) { Set($0.changedValuesForCurrentEvent().keys) })
+    }
+
+    private func isOtherContextOfTheStore(_ context: NSManagedObjectContext) -> Bool {
+        guard
+            context !== managedObjectContext,
+            let coordinator = persistentStoreCoordinator
+        else {
+            return false
+        }
+
+        return context.persistentStoreCoordinator === coordinator
+    }
+
+    /// Collects the objects affected by the save of another context of the same store, while their changed
+    /// values can still be read.
+    ///
+    /// This is called on the queue of the saving context, so the saved objects are read there and only the
+    /// object IDs are passed to the queue of the cache's context once the save is done.
+    private func contextWillSave(_ note: Notification) {
+        guard let savingContext = note.object as? NSManagedObjectContext, isOtherContextOfTheStore(savingContext) else { return }
+
+        let objectsByKey: [String: Set<NSManagedObject>] = [
+            NSInsertedObjectsKey: savingContext.insertedObjects,
+            NSUpdatedObjectsKey: savingContext.updatedObjects,
+            NSDeletedObjectsKey: savingContext.deletedObjects
+        ]
+
+        let invalidation = ConversationPermissionCache.invalidation(for: objectsByKey) { Set($0.changedValues().keys) }
+        guard !invalidation.isEmpty else { return }
+
+        savesLock.lock()
+        pendingSaves[ObjectIdentifier(savingContext), default: Invalidation()].formUnion(invalidation)
+        savesLock.unlock()
+    }
+
+    private func contextDidSave(_ note: Notification) {
+        guard let savingContext = note.object as? NSManagedObjectContext else { return }
+
+        if savingContext === managedObjectContext {
+            dropTemporaryIDs()
+            return
+        }
+
+        guard isOtherContextOfTheStore(savingContext), let managedObjectContext = managedObjectContext else { return }
+
+        savesLock.lock()
+        let invalidation = pendingSaves.removeValue(forKey: ObjectIdentifier(savingContext))
+        savesLock.unlock()
+
+        guard let saved = invalidation else { return }
+
+        managedObjectContext.performGroupedBlock { [weak self] in
+            self?.apply(saved)
+        }
+    }
+
+    /// Temporary IDs change when the context saves, the masks held under them would never be read again.
+    private func dropTemporaryIDs() {
+        guard hasTemporaryIDs else { return }
+        hasTemporaryIDs = false
+
+        roleMasks = roleMasks.filter { !$0.key.isTemporaryID }
+        removeKeys(Set(effectiveMasks.lazy.filter { key, cached in
+            key.user.isTemporaryID || key.conversation.isTemporaryID || cached.role?.isTemporaryID == true
+        }.map(\.key)))
+    }
+
+}
+
+// MARK: - Model hooks
+
+// The hooks of conversations, users and participant roles are shared with other caches, see
+// `ZMManagedObject+ChangeHooks.swift`.
+
+extension Role {
+
+    /// The keys which the action masks depend on.
+    static let permissionKeys: Set<String> = [Role.actionsKey, Role.nameKey, Role.participantRolesKey]
+
+    public override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+        valueDidChange(forKey: key)
+    }
+
+    public override func didChange(_ change: NSKeyValueSetMutationKind, valuesForKey key: String, with objects: Set<AnyHashable>) {
+        super.didChange(change, valuesForKey: key, with: objects)
+        valueDidChange(forKey: key)
+    }
+
+    private func valueDidChange(forKey key: String) {
+        guard Role.permissionKeys.contains(key) else { return }
+        managedObjectContext?.conversationPermissionCache.invalidate(self)
+    }
+
+}
+
+extension Action {
+
+    public override func willChangeValue(forKey key: String) {
+        super.willChangeValue(forKey: key)
+
+        guard key == Action.roleKey, let role = role else { return }
+        managedObjectContext?.conversationPermissionCache.invalidate(role)
+    }
+
+    public override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+
+        guard key == Action.nameKey || key == Action.roleKey, let role = role else { return }
+        managedObjectContext?.conversationPermissionCache.invalidate(role)
+    }
+
+}
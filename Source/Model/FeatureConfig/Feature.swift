@@ -216,3 +216,33 @@ public class Feature: ZMManagedObject {
         }
     }
 }
+
+// MARK: - Model hooks
+
+// Keeps the feature config cache of the context up to date, see `FeatureConfigCache`.
+
+extension Feature {
+
+    public override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+
+        guard key == #keyPath(Feature.statusValue) || key == #keyPath(Feature.configData) else { return }
+        invalidateCachedValue()
+    }
+
+    public override func prepareForDeletion() {
+        super.prepareForDeletion()
+        invalidateCachedValue()
+    }
+
+    private func invalidateCachedValue() {
+        guard let cache = managedObjectContext?.featureConfigCache else { return }
+
+        if let name = Feature.Name(rawValue: nameValue) {
+            cache.invalidate(name)
+        } else {
+            cache.invalidateAll()
+        }
+    }
+
+}
@@ -0,0 +1,244 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let FeatureConfigCacheKey = "FeatureConfigCacheKey"
+
+    /// The feature config cache shared by all contexts of the same persistent store coordinator.
+    var featureConfigCache: FeatureConfigCache {
+        if let cache = userInfo[NSManagedObjectContext.FeatureConfigCacheKey] as? FeatureConfigCache {
+            return cache
+        }
+
+        let cache = persistentStoreCoordinator.map(FeatureConfigCache.cache(for:)) ?? FeatureConfigCache()
+        userInfo[NSManagedObjectContext.FeatureConfigCacheKey] = cache
+        return cache
+    }
+
+}
+
+/// Caches the decoded features of an account, so reading a feature doesn't fetch and decode it.
+///
+/// A single cache is shared by all contexts of a persistent store coordinator and can be read from
+/// any of them. Storing a feature through the `FeatureService` replaces its cached value once the
+/// context has saved the feature, any other change to a feature's status or config drops it.
+///
+/// A context reading a feature before the change of another context reached it caches the old value,
+/// so saved features are dropped again when any context of the coordinator saves or refreshes them.
+
+final class FeatureConfigCache {
+
+    private static let lock = NSLock()
+    private static let caches = NSMapTable<NSPersistentStoreCoordinator, FeatureConfigCache>.weakToStrongObjects()
+
+    static func cache(for coordinator: NSPersistentStoreCoordinator) -> FeatureConfigCache {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if let cache = caches.object(forKey: coordinator) {
+            return cache
+        }
+
+        let cache = FeatureConfigCache(persistentStoreCoordinator: coordinator)
+        caches.setObject(cache, forKey: coordinator)
+        return cache
+    }
+
+    /// Values stored in a context which hasn't saved them yet.
+    private struct StagedValues {
+        weak var context: NSManagedObjectContext?
+        var values: [Feature.Name: Any] = [:]
+    }
+
+    private let lock = NSLock()
+    private var values: [Feature.Name: Any] = [:]
+
+    /// The staged values by context, entries of deallocated contexts are dropped on the next save.
+    private var stagedValues: [ObjectIdentifier: StagedValues] = [:]
+    private weak var persistentStoreCoordinator: NSPersistentStoreCoordinator?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    /// Incremented whenever a value is dropped, so a value computed from stale data isn't cached.
+    private var generation = 0
+
+    init(persistentStoreCoordinator: NSPersistentStoreCoordinator? = nil) {
+        self.persistentStoreCoordinator = persistentStoreCoordinator
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: nil,
+                                                   queue: nil) { [weak self] note in
+                self?.contextDidSave(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: nil,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            }
+        ]
+    }
+
+    deinit {
+        observerTokens.forEach { NotificationCenter.default.removeObserver($0) }
+    }
+
+    // MARK: - Access
+
+    /// Returns the cached value of a feature, computing and caching it with the given block if needed.
+    func value<T>(for name: Feature.Name, compute: () -> T) -> T {
+        lock.lock()
+        let cachedValue = values[name] as? T
+        let generation = self.generation
+        lock.unlock()
+
+        if let value = cachedValue {
+            return value
+        }
+
+        let value = compute()
+
+        lock.lock()
+        // A staged value isn't saved yet, the computed value may include it
+        if generation == self.generation, !isStaged(name) {
+            values[name] = value
+        }
+        lock.unlock()
+
+        return value
+    }
+
+    func store<T>(_ value: T, for name: Feature.Name) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        generation += 1
+        values[name] = value
+    }
+
+    /// Stores a value once the given context has saved the feature. The value is dropped if the context
+    /// rolls back or the feature is changed otherwise in the meantime.
+    func store<T>(_ value: T, for name: Feature.Name, whenSavedIn context: NSManagedObjectContext) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let key = ObjectIdentifier(context)
+        generation += 1
+        values.removeValue(forKey: name)
+
+        if stagedValues[key]?.context !== context {
+            stagedValues[key] = StagedValues(context: context)
+        }
+        stagedValues[key]?.values[name] = value
+    }
+
+    private func isStaged(_ name: Feature.Name) -> Bool {
+        return stagedValues.values.contains { $0.values[name] != nil }
+    }
+
+    private func isObserved(_ context: NSManagedObjectContext) -> Bool {
+        return context.persistentStoreCoordinator === persistentStoreCoordinator
+    }
+
+    /// Publishes the staged values of the features saved by the context and drops the other saved features.
+    private func contextDidSave(_ note: Notification) {
+        guard let context = note.object as? NSManagedObjectContext, isObserved(context) else { return }
+
+        let savedNames = FeatureConfigCache.featureNames(in: note, forKeys: [NSInsertedObjectsKey, NSUpdatedObjectsKey])
+        let key = ObjectIdentifier(context)
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        stagedValues = stagedValues.filter { $0.value.context != nil }
+
+        guard !savedNames.isEmpty else { return }
+
+        generation += 1
+
+        for name in savedNames {
+            if stagedValues[key]?.context === context, let value = stagedValues[key]?.values.removeValue(forKey: name) {
+                values[name] = value
+            } else {
+                values.removeValue(forKey: name)
+            }
+        }
+    }
+
+    /// Drops the features refreshed by a merge, and the staged values of the features reverted by a
+    /// rollback of the staging context.
+    private func objectsDidChange(_ note: Notification) {
+        guard let context = note.object as? NSManagedObjectContext, isObserved(context) else { return }
+
+        let key = ObjectIdentifier(context)
+        let invalidatedAll = note.userInfo?[NSInvalidatedAllObjectsKey] != nil
+        let refreshedNames = FeatureConfigCache.featureNames(in: note, forKeys: [NSRefreshedObjectsKey])
+        let revertedNames = FeatureConfigCache.featureNames(in: note, forKeys: [NSRefreshedObjectsKey, NSInvalidatedObjectsKey, NSDeletedObjectsKey])
+
+        guard invalidatedAll || !revertedNames.isEmpty else { return }
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        if !refreshedNames.isEmpty {
+            generation += 1
+            refreshedNames.forEach { values.removeValue(forKey: $0) }
+        }
+
+        guard stagedValues[key]?.context === context, stagedValues[key]?.values.isEmpty == false else { return }
+
+        if invalidatedAll {
+            stagedValues[key] = nil
+            return
+        }
+
+        for name in revertedNames {
+            stagedValues[key]?.values.removeValue(forKey: name)
+        }
+    }
+
+    private static func featureNames(in note: Notification, forKeys keys: [String]) -> [Feature.Name] {
+        return keys
+            .compactMap { note.userInfo?[$0] as? Set<NSManagedObject> }
+            .joined()
+            .compactMap { ($0 as? Feature).flatMap { Feature.Name(rawValue: $0.nameValue) } }
+    }
+
+    // MARK: - Invalidation
+
+    func invalidate(_ name: Feature.Name) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        generation += 1
+        values.removeValue(forKey: name)
+        stagedValues.keys.forEach { stagedValues[$0]?.values.removeValue(forKey: name) }
+    }
+
+    func invalidateAll() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        generation += 1
+        values = [:]
+        stagedValues = [:]
+    }
+
+}
@@ -25,6 +25,10 @@ import Foundation
 /// encoded form is what is stored in the database. Use this class to fetch a specific
 /// feature as a type that contains a decoded configuration.
 ///
+/// Fetched features are cached, decoded, in the `FeatureConfigCache` shared by all contexts
+/// of the account, so repeated fetches don't hit the database. Stored features replace the cached
+/// values once the context is saved.
+///
 /// **Note:** fetching features can occur on any context, but updates should only
 /// take place on the sync context.
 
@@ -34,6 +38,10 @@ public class FeatureService {
 
     private let context: NSManagedObjectContext
 
+    private var cache: FeatureConfigCache {
+        return context.featureConfigCache
+    }
+
     // MARK: - Life cycle
 
     public init(context: NSManagedObjectContext) {
@@ -43,12 +51,14 @@ public class FeatureService {
     // MARK: - App lock
 
     public func fetchAppLock() -> Feature.AppLock {
-        guard let feature = Feature.fetch(name: .appLock, context: context),
-              let featureConfig = feature.config else {
-                  return .init()
-              }
-        let config = try! JSONDecoder().decode(Feature.AppLock.Config.self, from: featureConfig)
-        return.init(status: feature.status, config: config)
+        return cache.value(for: .appLock) {
+            guard let feature = Feature.fetch(name: .appLock, context: context),
+                  let featureConfig = feature.config else {
+                      return .init()
+                  }
+            let config = try! JSONDecoder().decode(Feature.AppLock.Config.self, from: featureConfig)
+            return.init(status: feature.status, config: config)
+        }
     }
 
     public func storeAppLock(_ appLock: Feature.AppLock) {
@@ -58,15 +68,19 @@ public class FeatureService {
             $0.status = appLock.status
             $0.config = config
         }
+
+        cache.store(appLock, for: .appLock, whenSavedIn: context)
     }
 
     // MARK: - Conference calling
 
     public func fetchConferenceCalling() -> Feature.ConferenceCalling {
-        guard let feature = Feature.fetch(name: .conferenceCalling, context: context) else {
-            return .init()
+        return cache.value(for: .conferenceCalling) {
+            guard let feature = Feature.fetch(name: .conferenceCalling, context: context) else {
+                return .init()
+            }
+            return .init(status: feature.status)
         }
-        return .init(status: feature.status)
     }
 
     public func storeConferenceCalling(_ conferenceCalling: Feature.ConferenceCalling) {
@@ -74,6 +88,8 @@ public class FeatureService {
             $0.status = conferenceCalling.status
         }
 
+        cache.store(conferenceCalling, for: .conferenceCalling, whenSavedIn: context)
+
         guard
             needsToNotifyUser(for: .conferenceCalling),
             conferenceCalling.status == .enabled
@@ -87,11 +103,13 @@ public class FeatureService {
     // MARK: - File sharing
 
     public func fetchFileSharing() -> Feature.FileSharing {
-        guard let feature = Feature.fetch(name: .fileSharing, context: context) else {
-            return .init()
-        }
+        return cache.value(for: .fileSharing) {
+            guard let feature = Feature.fetch(name: .fileSharing, context: context) else {
+                return .init()
+            }
 
-        return .init(status: feature.status)
+            return .init(status: feature.status)
+        }
     }
 
     public func storeFileSharing(_ fileSharing: Feature.FileSharing) {
@@ -99,6 +117,8 @@ public class FeatureService {
             $0.status = fileSharing.status
         }
 
+        cache.store(fileSharing, for: .fileSharing, whenSavedIn: context)
+
         guard needsToNotifyUser(for: .fileSharing) else { return }
 
         switch fileSharing.status {
@@ -113,12 +133,14 @@ public class FeatureService {
     // MARK: - Self deleting messages
 
     public func fetchSelfDeletingMesssages() -> Feature.SelfDeletingMessages {
-        guard let feature = Feature.fetch(name: .selfDeletingMessages, context: context),
-              let featureConfig = feature.config else {
-                  return .init()
-              }
-        let config = try! JSONDecoder().decode(Feature.SelfDeletingMessages.Config.self, from: featureConfig)
-        return .init(status: feature.status, config: config)
+        return cache.value(for: .selfDeletingMessages) {
+            guard let feature = Feature.fetch(name: .selfDeletingMessages, context: context),
+                  let featureConfig = feature.config else {
+                      return .init()
+                  }
+            let config = try! JSONDecoder().decode(Feature.SelfDeletingMessages.Config.self, from: featureConfig)
+            return .init(status: feature.status, config: config)
+        }
     }
 
     public func storeSelfDeletingMessages(_ selfDeletingMessages: Feature.SelfDeletingMessages) {
@@ -129,6 +151,8 @@ public class FeatureService {
             $0.config = config
         }
 
+        cache.store(selfDeletingMessages, for: .selfDeletingMessages, whenSavedIn: context)
+
         guard needsToNotifyUser(for: .selfDeletingMessages) else { return }
 
         switch (selfDeletingMessages.status, selfDeletingMessages.config.enforcedTimeoutSeconds) {
@@ -146,10 +170,12 @@ public class FeatureService {
     // MARK: - Conversation guest links
 
     public func fetchConversationGuestLinks() -> Feature.ConversationGuestLinks {
-        guard let feature = Feature.fetch(name: .conversationGuestLinks, context: context) else {
-            return .init()
+        return cache.value(for: .conversationGuestLinks) {
+            guard let feature = Feature.fetch(name: .conversationGuestLinks, context: context) else {
+                return .init()
+            }
+            return .init(status: feature.status)
         }
-        return .init(status: feature.status)
     }
 
     public func storeConversationGuestLinks(_ conversationGuestLinks: Feature.ConversationGuestLinks) {
@@ -157,6 +183,8 @@ public class FeatureService {
             $0.status = conversationGuestLinks.status
         }
 
+        cache.store(conversationGuestLinks, for: .conversationGuestLinks, whenSavedIn: context)
+
         guard needsToNotifyUser(for: .conversationGuestLinks) else { return }
 
         switch conversationGuestLinks.status {
@@ -171,15 +199,17 @@ public class FeatureService {
     // MARK: - Classified domains
 
     public func fetchClassifiedDomains() -> Feature.ClassifiedDomains {
-        guard
-            let feature = Feature.fetch(name: .classifiedDomains, context: context),
-            let featureConfig = feature.config
-        else {
-            return .init()
-        }
+        return cache.value(for: .classifiedDomains) {
+            guard
+                let feature = Feature.fetch(name: .classifiedDomains, context: context),
+                let featureConfig = feature.config
+            else {
+                return .init()
+            }
 
-        let config = try! JSONDecoder().decode(Feature.ClassifiedDomains.Config.self, from: featureConfig)
-        return .init(status: feature.status, config: config)
+            let config = try! JSONDecoder().decode(Feature.ClassifiedDomains.Config.self, from: featureConfig)
+            return .init(status: feature.status, config: config)
+        }
     }
 
     public func storeClassifiedDomains(_ classifiedDomains: Feature.ClassifiedDomains) {
@@ -189,22 +219,28 @@ public class FeatureService {
             $0.status = classifiedDomains.status
             $0.config = config
         }
+
+        cache.store(classifiedDomains, for: .classifiedDomains, whenSavedIn: context)
     }
 
     // MARK: - Digital signature
 
     public func fetchDigitalSignature() -> Feature.DigitalSignature {
-        guard let feature = Feature.fetch(name: .digitalSignature, context: context) else {
-            return .init()
-        }
+        return cache.value(for: .digitalSignature) {
+            guard let feature = Feature.fetch(name: .digitalSignature, context: context) else {
+                return .init()
+            }
 
-        return .init(status: feature.status)
+            return .init(status: feature.status)
+        }
     }
 
     public func storeDigitalSignature(_ digitalSignature: Feature.DigitalSignature) {
         Feature.updateOrCreate(havingName: .digitalSignature, in: context) {
             $0.status = digitalSignature.status
         }
+
+        cache.store(digitalSignature, for: .digitalSignature, whenSavedIn: context)
     }
 
     // MARK: - Methods
@@ -51,10 +51,11 @@ protocol Cache {
     /// Deletes the data for a key.
     func deleteAssetData(_ key: String)
 
-    /// Deletes assets created earlier than the given date.
+    /// Deletes assets created earlier than the given date and returns their keys.
     ///
     /// This will cause I/O
-    func deleteAssetsOlderThan(_ date: Date) throws
+    @discardableResult
+    func deleteAssetsOlderThan(_ date: Date) throws -> [String]
 
     /// Checks if the data exists in the cache. Faster than checking the data itself
     func hasDataForKey(_ key: String) -> Bool
@@ -66,34 +66,32 @@ extension ZMMessage {
     }
 
     @objc public func addReaction(_ unicodeValue: String?, forUser user: ZMUser) {
-        removeReaction(forUser: user)
-        guard let unicodeValue = unicodeValue,
-            unicodeValue.count > 0 else {
-                updateCategoryCache()
-                return
-        }
+        guard
+            let context = managedObjectContext,
+            context.messageReactionIndex.setReaction(unicodeValue, forUser: user, on: self)
+        else { return }
 
-        guard let reaction = self.reactions.first(where: {$0.unicodeValue! == unicodeValue}) else {
-            // we didn't find a reaction, need to add a new one
-            let newReaction = Reaction.insertReaction(unicodeValue, users: [user], inMessage: self)
-            self.mutableSetValue(forKey: "reactions").add(newReaction)
+        // Only the reaction of the self user affects the category
+        if user.isSelfUser {
             updateCategoryCache()
-            return
         }
-        reaction.mutableSetValue(forKey: ZMReactionUsersValueKey).add(user)
     }
 
-    fileprivate func removeReaction(forUser user: ZMUser) {
-        guard let reaction = self.reactions.first(where: {$0.users.contains(user)}) else {
-            return
-        }
-        reaction.mutableSetValue(forKey: ZMReactionUsersValueKey).remove(user)
+    /// The number of users who reacted with each emoji.
+    public var reactionCounts: [String: Int] {
+        return managedObjectContext?.messageReactionIndex.summary(for: self).countsByEmoji ?? [:]
+    }
+
+    /// The emoji the user reacted with, if any.
+    public func reaction(of user: ZMUser) -> String? {
+        return managedObjectContext?.messageReactionIndex.summary(for: self).emojiByUser[user.objectID]
     }
 
     @objc public func clearAllReactions() {
         let oldReactions = self.reactions
         reactions.removeAll()
         guard let moc = managedObjectContext else { return }
+        moc.messageReactionIndex.invalidate(self)
         oldReactions.forEach(moc.delete)
     }
 
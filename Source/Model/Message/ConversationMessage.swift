@@ -324,11 +324,8 @@ extension ZMMessage {
     }
 
     @objc public var usersReaction: [String: [UserType]] {
-        var result = [String: [ZMUser]]()
-        for reaction in reactions where reaction.users.count > 0 {
-            result[reaction.unicodeValue!] = [ZMUser](reaction.users)
-        }
-        return result
+        guard let context = managedObjectContext else { return [:] }
+        return context.messageReactionIndex.usersByEmoji(of: self)
     }
 
     @objc public var canBeDeleted: Bool {
@@ -0,0 +1,230 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let ConversationMessageNonceIndexKey = "ConversationMessageNonceIndexKey"
+
+    @objc
+    var conversationMessageNonceIndex: ConversationMessageNonceIndex {
+        if let index = userInfo[NSManagedObjectContext.ConversationMessageNonceIndexKey] as? ConversationMessageNonceIndex {
+            return index
+        }
+
+        let index = ConversationMessageNonceIndex(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.ConversationMessageNonceIndexKey] = index
+        return index
+    }
+
+}
+
+/// Maps the nonces of messages to their object IDs per conversation, so looking up a message by its nonce
+/// doesn't walk the messages of the conversation.
+///
+/// Messages are indexed when they are inserted or assigned to a conversation, when the context saves them,
+/// and when a lookup had to find them otherwise. Entries are only hints: a message found through the index
+/// is checked against the nonce and conversation before it's returned, and stale entries are dropped.
+/// The index holds at most `maximumEntryCount` entries, the least recently used conversations are evicted
+/// beyond that.
+///
+/// The message hooks adding messages to the index are shared with the last message cache and the reaction
+/// index, see `ZMManagedObject+ChangeHooks.swift`.
+
+@objc
+final class ConversationMessageNonceIndex: NSObject, TearDownCapable {
+
+    private final class Bucket {
+        var messages: [UUID: NSManagedObjectID] = [:]
+        var lastUse: UInt64 = 0
+    }
+
+    static let maximumEntryCount = 20_000
+
+    let maximumEntryCount: Int
+
+    private var buckets: [NSManagedObjectID: Bucket] = [:]
+    private(set) var entryCount = 0
+    private var useCounter: UInt64 = 0
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    init(managedObjectContext: NSManagedObjectContext, maximumEntryCount: Int = ConversationMessageNonceIndex.maximumEntryCount) {
+        self.managedObjectContext = managedObjectContext
+        self.maximumEntryCount = maximumEntryCount
+        super.init()
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.contextDidSave(note)
+            }
+        ]
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach(NotificationCenter.default.removeObserver)
+        observerTokens = []
+        invalidateAll()
+    }
+
+    // MARK: - Lookup
+
+    /// Returns the indexed message with the given nonce if it still belongs to the conversation.
+    @objc(messageWithNonce:inConversation:)
+    func message(withNonce nonce: UUID, in conversation: ZMConversation) -> ZMMessage? {
+        guard
+            let bucket = buckets[conversation.objectID],
+            let objectID = bucket.messages[nonce]
+        else { return nil }
+
+        touch(bucket)
+
+        guard
+            let message = existingMessage(with: objectID),
+            !message.isDeleted,
+            message.nonce == nonce,
+            message.visibleInConversation == conversation || message.hiddenInConversation == conversation
+        else {
+            bucket.messages.removeValue(forKey: nonce)
+            entryCount -= 1
+            return nil
+        }
+
+        return message
+    }
+
+    private func existingMessage(with objectID: NSManagedObjectID) -> ZMMessage? {
+        guard let moc = managedObjectContext else { return nil }
+
+        if let message = moc.registeredObject(for: objectID) {
+            return message as? ZMMessage
+        }
+
+        return (try? moc.existingObject(with: objectID)) as? ZMMessage
+    }
+
+    // MARK: - Updates
+
+    @objc(addMessage:)
+    func add(_ message: ZMMessage) {
+        guard let nonce = message.nonce, !message.isDeleted else { return }
+
+        [message.visibleInConversation, message.hiddenInConversation].compactMap { $0 }.forEach {
+            add(message.objectID, nonce: nonce, to: $0)
+        }
+    }
+
+    private func add(_ messageID: NSManagedObjectID, nonce: UUID, to conversation: ZMConversation) {
+        // Temporary IDs of conversations change when they are saved, the bucket would never be found again
+        guard !conversation.objectID.isTemporaryID else { return }
+
+        let bucket: Bucket
+        if let existing = buckets[conversation.objectID] {
+            bucket = existing
+        } else {
+            bucket = Bucket()
+            buckets[conversation.objectID] = bucket
+        }
+
+        touch(bucket)
+
+        guard bucket.messages.updateValue(messageID, forKey: nonce) == nil else { return }
+
+        entryCount += 1
+        evictIfNeeded()
+    }
+
+    func remove(_ message: ZMMessage) {
+        let committed = message.committedValues(forKeys: [ZMMessageNonceDataKey, ZMMessageConversationKey, ZMMessageHiddenInConversationKey])
+        let nonces = [message.nonce, (committed[ZMMessageNonceDataKey] as? Data).flatMap(UUID.init(data:))].compactMap { $0 }
+        let conversations = [message.visibleInConversation,
+                             message.hiddenInConversation,
+                             committed[ZMMessageConversationKey] as? ZMConversation,
+                             committed[ZMMessageHiddenInConversationKey] as? ZMConversation].compactMap { $0 }
+
+        for conversation in conversations {
+            guard let bucket = buckets[conversation.objectID] else { continue }
+
+            for nonce in nonces where bucket.messages[nonce] == message.objectID {
+                bucket.messages.removeValue(forKey: nonce)
+                entryCount -= 1
+            }
+        }
+    }
+
+    func invalidateAll() {
+        buckets = [:]
+        entryCount = 0
+    }
+
+    private func touch(_ bucket: Bucket) {
+        useCounter += 1
+        bucket.lastUse = useCounter
+    }
+
+    /// Drops the least recently used conversations until the index is back to three quarters of its limit,
+    /// so evictions are amortized over many insertions.
+    private func evictIfNeeded() {
+        guard entryCount > maximumEntryCount else { return }
+
+        let leastRecentlyUsedFirst = buckets.sorted { $0.value.lastUse < $1.value.lastUse }
+
+        for (conversationID, bucket) in leastRecentlyUsedFirst {
+            guard entryCount > maximumEntryCount / 4 * 3 else { break }
+            buckets.removeValue(forKey: conversationID)
+            entryCount -= bucket.messages.count
+        }
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        // Messages merged from other contexts are only reported here
+        let inserted = (userInfo[NSInsertedObjectsKey] as? Set<NSManagedObject>) ?? []
+        inserted.lazy.compactMap { $0 as? ZMMessage }.forEach(add)
+
+        guard !buckets.isEmpty else { return }
+
+        let deleted = (userInfo[NSDeletedObjectsKey] as? Set<NSManagedObject>) ?? []
+        deleted.lazy.compactMap { $0 as? ZMMessage }.forEach(remove)
+    }
+
+    /// Saving gives inserted messages their permanent object IDs.
+    private func contextDidSave(_ note: Notification) {
+        let inserted = (note.userInfo?[NSInsertedObjectsKey] as? Set<NSManagedObject>) ?? []
+        inserted.lazy.compactMap { $0 as? ZMMessage }.forEach(add)
+    }
+
+}
@@ -173,10 +173,15 @@ private struct FileCache: Cache {
     /// Deletes assets created earlier than the given date
     ///
     /// - parameter date: assets earlier than this date will be deleted
-    func deleteAssetsOlderThan(_ date: Date) throws {
+    /// - returns: the keys of the deleted assets
+    @discardableResult
+    func deleteAssetsOlderThan(_ date: Date) throws -> [String] {
+        var deletedKeys: [String] = []
         for expiredAsset in try assetsOlderThan(date) {
             try FileManager.default.removeItem(at: expiredAsset)
+            deletedKeys.append(expiredAsset.lastPathComponent)
         }
+        return deletedKeys
     }
 
     /// Returns assets created earlier than the given date
@@ -283,6 +288,7 @@ private struct FileCache: Cache {
                              data: Data) {
         guard let key = type(of: self).cacheKeyForAsset(for: team, format: format, encrypted: encrypted) else { return }
         self.cache.storeAssetData(data, key: key, createdAt: Date())
+        AssetDownloadWorkIndex.notifyCacheDidChange(self, cacheKeys: [key])
     }
 
     /// Sets the image asset data for a given message. This will cause I/O
@@ -319,6 +325,7 @@ private struct FileCache: Cache {
     open func deleteAssetData(for team: Team, format: ZMImageFormat, encrypted: Bool) {
         guard let key = type(of: self).cacheKeyForAsset(for: team, format: format, encrypted: encrypted) else { return }
         cache.deleteAssetData(key)
+        AssetDownloadWorkIndex.notifyCacheDidChange(self, cacheKeys: [key])
     }
 
     /// Deletes the image data for a given message. This will cause I/O
@@ -353,9 +360,14 @@ private struct FileCache: Cache {
 
     public func deleteAssetsOlderThan(_ date: Date) {
         do {
-            try cache.deleteAssetsOlderThan(date)
+            let deletedKeys = try cache.deleteAssetsOlderThan(date)
+            if !deletedKeys.isEmpty {
+                // Team logos are deleted along with the assets of messages
+                AssetDownloadWorkIndex.notifyCacheDidChange(self, cacheKeys: deletedKeys)
+            }
         } catch let error {
             zmLog.error("Error trying to delete assets older than \(date): \(error)")
+            AssetDownloadWorkIndex.notifyCacheDidChange(self, cacheKeys: nil)
         }
     }
 
@@ -400,6 +412,7 @@ public extension FileAssetCache {
     /// This is intended for testing
     func wipeCaches() {
         fileCache.wipeCaches()
+        AssetDownloadWorkIndex.notifyCacheDidChange(self, cacheKeys: nil)
     }
 }
 
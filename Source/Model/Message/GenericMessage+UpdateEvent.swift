@@ -20,18 +20,7 @@ import Foundation
 
 extension GenericMessage {
     public init?(from updateEvent: ZMUpdateEvent) {
-        let base64Content: String?
-
-        switch updateEvent.type {
-        case .conversationClientMessageAdd:
-            base64Content = updateEvent.payload.string(forKey: "data")
-        case .conversationOtrMessageAdd:
-            base64Content = updateEvent.payload.dictionary(forKey: "data")?.string(forKey: "text")
-        case .conversationOtrAssetAdd:
-            base64Content = updateEvent.payload.dictionary(forKey: "data")?.string(forKey: "info")
-        default:
-            return nil
-        }
+        guard let base64Content = updateEvent.base64GenericMessageContent else { return nil }
 
         var message = GenericMessage(withBase64String: base64Content)
 
@@ -50,3 +39,36 @@ extension GenericMessage {
         return ZMClientMessage.self
     }
 }
+
+extension ZMUpdateEvent {
+
+    /// The base64 encoded generic message of a message event.
+    var base64GenericMessageContent: String? {
+        switch type {
+        case .conversationClientMessageAdd:
+            return payload.string(forKey: "data")
+        case .conversationOtrMessageAdd:
+            return payload.dictionary(forKey: "data")?.string(forKey: "text")
+        case .conversationOtrAssetAdd:
+            return payload.dictionary(forKey: "data")?.string(forKey: "info")
+        default:
+            return nil
+        }
+    }
+
+    /// The routing fields of the generic message of a message event, scanned without decoding the message.
+    /// Messages sent as external are encrypted, their fields are only available after decoding them.
+    public var genericMessageFields: GenericMessageFields? {
+        guard
+            let base64Content = base64GenericMessageContent,
+            let data = Data(base64Encoded: base64Content),
+            let fields = GenericMessageFields(serializedData: data),
+            fields.contentType != .external
+        else {
+            return nil
+        }
+
+        return fields
+    }
+
+}
@@ -0,0 +1,72 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+import WireUtilities
+
+/// The results of scanning the text of a message, computed once per text.
+///
+/// Categorizing a message, normalizing it for search and deciding whether it needs a link preview all
+/// look at the same text, the analysis lets them share a single pass of the link detector.
+
+final class MessageTextAnalysis {
+
+    let text: String
+
+    /// The ranges of the links found in the text, in UTF-16 offsets.
+    let linkRanges: [NSRange]
+
+    var containsLinks: Bool {
+        return !linkRanges.isEmpty
+    }
+
+    /// The category of the text, not taking link previews into account.
+    var category: MessageCategory {
+        return containsLinks ? [.text, .link] : .text
+    }
+
+    /// The text normalized for search, only computed when it's needed.
+    private(set) lazy var normalizedText: String = text.normalizedForSearch() as String
+
+    init(text: String) {
+        self.text = text
+        self.linkRanges = linkParser
+            .matches(in: text, range: NSRange(location: 0, length: (text as NSString).length))
+            .map(\.range)
+    }
+
+}
+
+extension ZMClientMessage {
+
+    /// The analysis of the current message text, or `nil` if the message has no text.
+    var textAnalysis: MessageTextAnalysis? {
+        guard let text = textMessageData?.messageText, !text.isEmpty else {
+            return nil
+        }
+
+        if let analysis = cachedTextAnalysis, analysis.text == text {
+            return analysis
+        }
+
+        let analysis = MessageTextAnalysis(text: text)
+        cachedTextAnalysis = analysis
+        return analysis
+    }
+
+}
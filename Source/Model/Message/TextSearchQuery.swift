@@ -44,8 +44,8 @@ extension ZMClientMessage {
             return
         }
 
-        if let normalized = textMessageData?.messageText?.normalizedForSearch() {
-            normalizedText = normalized as String
+        if let analysis = textAnalysis {
+            normalizedText = analysis.normalizedText
         } else {
             normalizedText = ""
         }
@@ -22,6 +22,7 @@ extension ZMClientMessage {
 
     func deleteContent() {
         cachedUnderlyingMessage = nil
+        cachedTextAnalysis = nil
         dataSet.compactMap { $0 as? ZMGenericMessageData }.forEach {
             $0.managedObjectContext?.delete($0)
         }
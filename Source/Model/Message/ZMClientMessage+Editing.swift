@@ -64,6 +64,7 @@ extension ZMClientMessage {
         self.nonce = nonce
         updatedTimestamp = updateEvent.timestamp
         reactions.removeAll()
+        managedObjectContext?.messageReactionIndex.invalidate(self)
         linkAttachments = nil
 
         return true
@@ -277,11 +277,30 @@ extension GenericMessage {
         let encryptionContext = selfClient.keysStore.encryptionContext
         var messageData: Data?
 
+        // The plaintext is the same for every recipient, so we serialize it only once.
+        let plaintext = try? serializedData()
+
         encryptionContext.perform { sessionsDirectory in
+            if externalData == nil,
+               let plaintext = plaintext,
+               GenericMessage.minimumEncryptedPayloadSize(plaintextSize: plaintext.count,
+                                                          recipients: recipients,
+                                                          selfClient: selfClient,
+                                                          sessionDirectory: sessionsDirectory) > ZMClientMessage.byteSizeExternalThreshold {
+                // Even the smallest possible payload is too big, we therefore go straight to the external message
+                // instead of encrypting the message for every recipient only to discard the result.
+                messageData = self.encryptForTransportWithExternalDataBlob(for: recipients,
+                                                                           with: missingClientsStrategy,
+                                                                           useQualifiedIdentifiers: useQualifiedIdentifiers,
+                                                                           in: context)
+                return
+            }
+
             if useQualifiedIdentifiers, let selfDomain = ZMUser.selfUser(in: context).domain {
                 let message = proteusMessage(selfClient,
                                              selfDomain: selfDomain,
                                              recipients: recipients,
+                                             plaintext: plaintext,
                                              missingClientsStrategy: missingClientsStrategy,
                                              externalData: externalData,
                                              sessionDirectory: sessionsDirectory)
@@ -289,6 +308,7 @@ extension GenericMessage {
             } else {
                 let message = otrMessage(selfClient,
                                          recipients: recipients,
+                                         plaintext: plaintext,
                                          missingClientsStrategy: missingClientsStrategy,
                                          externalData: externalData,
                                          sessionDirectory: sessionsDirectory)
@@ -318,6 +338,7 @@ extension GenericMessage {
     private func proteusMessage(_ selfClient: UserClient,
                                 selfDomain: String,
                                 recipients: [ZMUser: Set<UserClient>],
+                                plaintext: Data?,
                                 missingClientsStrategy: MissingClientsStrategy,
                                 externalData: Data?,
                                 sessionDirectory: EncryptionSessionsDirectory) -> Proteus_QualifiedNewOtrMessage {
@@ -326,6 +347,7 @@ extension GenericMessage {
             selfClient,
             selfDomain: selfDomain,
             recipients: recipients,
+            plaintext: plaintext,
             sessionDirectory: sessionDirectory)
 
         // We do not want to send pushes for delivery receipts.
@@ -342,12 +364,14 @@ extension GenericMessage {
 
     private func otrMessage(_ selfClient: UserClient,
                             recipients: [ZMUser: Set<UserClient>],
+                            plaintext: Data?,
                             missingClientsStrategy: MissingClientsStrategy,
                             externalData: Data?,
                             sessionDirectory: EncryptionSessionsDirectory) -> Proteus_NewOtrMessage {
 
         let userEntries = userEntriesWithEncryptedData(selfClient,
                                                        recipients: recipients,
+                                                       plaintext: plaintext,
                                                        sessionDirectory: sessionDirectory)
 
         // We do not want to send pushes for delivery receipts.
@@ -368,6 +392,7 @@ extension GenericMessage {
     private func qualifiedUserEntriesWithEncryptedData(_ selfClient: UserClient,
                                                        selfDomain: String,
                                                        recipients: [ZMUser: Set<UserClient>],
+                                                       plaintext: Data?,
                                                        sessionDirectory: EncryptionSessionsDirectory) -> [Proteus_QualifiedUserEntry] {
 
         let recipientsByDomain = Dictionary(grouping: recipients) { (element) -> String in
@@ -382,6 +407,7 @@ extension GenericMessage {
 
                 let clientEntries = clientEntriesWithEncryptedData(selfClient,
                                                                    userClients: clients,
+                                                                   plaintext: plaintext,
                                                                    sessionDirectory: sessionDirectory)
 
                 guard !clientEntries.isEmpty else { return nil }
@@ -394,6 +420,7 @@ extension GenericMessage {
 
     private func userEntriesWithEncryptedData(_ selfClient: UserClient,
                                               recipients: [ZMUser: Set<UserClient>],
+                                              plaintext: Data?,
                                               sessionDirectory: EncryptionSessionsDirectory) -> [Proteus_UserEntry] {
 
         return recipients.compactMap { (user, clients) in
@@ -401,6 +428,7 @@ extension GenericMessage {
 
             let clientEntries = clientEntriesWithEncryptedData(selfClient,
                                                                userClients: clients,
+                                                               plaintext: plaintext,
                                                                sessionDirectory: sessionDirectory)
 
             guard !clientEntries.isEmpty else { return nil }
@@ -411,21 +439,26 @@ extension GenericMessage {
 
     private func clientEntriesWithEncryptedData(_ selfClient: UserClient,
                                                 userClients: Set<UserClient>,
+                                                plaintext: Data?,
                                                 sessionDirectory: EncryptionSessionsDirectory) -> [Proteus_ClientEntry] {
 
         return userClients.compactMap { client in
             guard client != selfClient else { return nil }
-            return clientEntry(for: client, sessionDirectory: sessionDirectory)
+            return clientEntry(for: client, plaintext: plaintext, sessionDirectory: sessionDirectory)
         }
     }
 
     // Assumes it's not the self client.
-    private func clientEntry(for client: UserClient, sessionDirectory: EncryptionSessionsDirectory) -> Proteus_ClientEntry? {
+    private func clientEntry(for client: UserClient, plaintext: Data?, sessionDirectory: EncryptionSessionsDirectory) -> Proteus_ClientEntry? {
         guard let sessionIdentifier = client.sessionIdentifier else { return nil }
 
         if sessionDirectory.hasSession(for: sessionIdentifier) {
-            let encryptedData = try? sessionDirectory.encryptCaching(serializedData(), for: sessionIdentifier)
-            guard let data = encryptedData else { return nil }
+            guard
+                let plaintext = plaintext,
+                let data = try? sessionDirectory.encryptCaching(plaintext, for: sessionIdentifier)
+            else {
+                return nil
+            }
             return Proteus_ClientEntry(withClient: client, data: data)
 
         } else if client.failedToEstablishSession {
@@ -549,6 +582,39 @@ extension GenericMessage {
     }
 }
 
+// MARK: - Payload size estimate
+
+extension GenericMessage {
+
+    /// Lower bound of what encrypting for a single client adds on top of the plaintext: the Proteus
+    /// envelope of a message in an established session (MAC, session tag, counters and ratchet key) and the
+    /// protobuf client entry wrapping the ciphertext. Prekey messages add the prekey bundle on top of that.
+    static let minimumEncryptionOverheadPerClient = 96
+
+    /// Returns a lower bound of the size of the payload we would get by encrypting a message of the given
+    /// size for the given recipients. If it exceeds `ZMClientMessage.byteSizeExternalThreshold` the message
+    /// has to be sent as an external message, otherwise only the size of the encrypted payload tells.
+    ///
+    /// Only the clients which get a ciphertext are counted, like in `clientEntriesWithEncryptedData`: the self
+    /// client, clients of deleted accounts and clients without an established session are left out.
+    static func minimumEncryptedPayloadSize(plaintextSize: Int,
+                                            recipients: [ZMUser: Set<UserClient>],
+                                            selfClient: UserClient,
+                                            sessionDirectory: EncryptionSessionsDirectory) -> UInt {
+        let numberOfClients = recipients.reduce(0) { count, recipient in
+            guard !recipient.key.isAccountDeleted else { return count }
+
+            return count + recipient.value.filter { client in
+                guard client != selfClient, let sessionIdentifier = client.sessionIdentifier else { return false }
+                return sessionDirectory.hasSession(for: sessionIdentifier)
+            }.count
+        }
+
+        return UInt(numberOfClients * (plaintextSize + minimumEncryptionOverheadPerClient))
+    }
+
+}
+
 // MARK: - External
 
 extension GenericMessage {
@@ -70,6 +70,7 @@ extension ZMClientMessage: ZMTextMessageData {
         self.nonce = editNonce
         self.updatedTimestamp = Date()
         self.reactions.removeAll()
+        self.managedObjectContext?.messageReactionIndex.invalidate(self)
         self.linkPreviewState = fetchLinkPreview ? .waitingToBeProcessed : .done
         self.linkAttachments = nil
         self.delivered = false
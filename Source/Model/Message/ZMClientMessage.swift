@@ -35,6 +35,9 @@ public class ZMClientMessage: ZMOTRMessage {
     /// In memory cache
     var cachedUnderlyingMessage: GenericMessage?
 
+    /// In memory cache of the text analysis, see `textAnalysis`
+    var cachedTextAnalysis: MessageTextAnalysis?
+
     public override static func entityName() -> String {
         return "ClientMessage"
     }
@@ -59,18 +62,21 @@ public class ZMClientMessage: ZMOTRMessage {
         super.awakeFromFetch()
 
         cachedUnderlyingMessage = nil
+        cachedTextAnalysis = nil
     }
 
     public override func awake(fromSnapshotEvents flags: NSSnapshotEventType) {
         super.awake(fromSnapshotEvents: flags)
 
         cachedUnderlyingMessage = nil
+        cachedTextAnalysis = nil
     }
 
     public override func didTurnIntoFault() {
         super.didTurnIntoFault()
 
         cachedUnderlyingMessage = nil
+        cachedTextAnalysis = nil
     }
 
     public override var isUpdatingExistingMessage: Bool {
@@ -162,10 +162,8 @@ extension ZMMessage {
         }
         else {
             // does the text itself includes a link?
-            let matches = linkParser.matches(in: text, range: NSRange(location: 0, length: text.count))
-            if matches.count > 0 {
-                category.update(with: .link)
-            }
+            let analysis = (self as? ZMClientMessage)?.textAnalysis ?? MessageTextAnalysis(text: text)
+            category.formUnion(analysis.category)
         }
         return category
     }
@@ -200,10 +198,7 @@ extension ZMMessage {
             return .none
         }
         let selfUser = ZMUser.selfUser(in: self.managedObjectContext!)
-        for reaction in self.reactions where reaction.users.contains(selfUser) {
-            return .liked
-        }
-        return .none
+        return reaction(of: selfUser) != nil ? .liked : .none
     }
 
     fileprivate var knockCategory: MessageCategory {
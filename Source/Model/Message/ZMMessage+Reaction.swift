@@ -19,16 +19,47 @@
 import Foundation
 
 extension ZMMessage {
+
     static func add(reaction: WireProtos.Reaction, senderID: UUID, conversation: ZMConversation, inContext moc: NSManagedObjectContext) {
-        guard
-            let user = ZMUser.fetch(with: senderID, in: moc),
-            let nonce = UUID(uuidString: reaction.messageID),
-            let localMessage = ZMMessage.fetch(withNonce: nonce, for: conversation, in: moc)
-        else {
-            return
+        add(reactions: [(reaction, senderID)], conversation: conversation, inContext: moc)
+    }
+
+    /// Applies many reactions to messages of a conversation in one pass, in the given order.
+    ///
+    /// Senders and messages are looked up once each, and the category of a message is updated once
+    /// after all its reactions are applied.
+    static func add(reactions: [(reaction: WireProtos.Reaction, senderID: UUID)], conversation: ZMConversation, inContext moc: NSManagedObjectContext) {
+        var users: [UUID: ZMUser?] = [:]
+        var messages: [UUID: ZMMessage?] = [:]
+        var messagesNeedingCategoryUpdate: [ZMMessage] = []
+        let index = moc.messageReactionIndex
+
+        for (reaction, senderID) in reactions {
+            guard let nonce = UUID(uuidString: reaction.messageID) else { continue }
+
+            let user = users[senderID] ?? {
+                let user = ZMUser.fetch(with: senderID, in: moc)
+                users[senderID] = .some(user)
+                return user
+            }()
+
+            let message = messages[nonce] ?? {
+                let message = ZMMessage.fetch(withNonce: nonce, for: conversation, in: moc)
+                messages[nonce] = .some(message)
+                return message
+            }()
+
+            guard
+                let sender = user,
+                let localMessage = message,
+                index.setReaction(reaction.emoji, forUser: sender, on: localMessage),
+                sender.isSelfUser,
+                !messagesNeedingCategoryUpdate.contains(localMessage)
+            else { continue }
+
+            messagesNeedingCategoryUpdate.append(localMessage)
         }
 
-        localMessage.addReaction(reaction.emoji, forUser: user)
-        localMessage.updateCategoryCache()
+        messagesNeedingCategoryUpdate.forEach { $0.updateCategoryCache() }
     }
 }
@@ -429,37 +429,16 @@ NSString * const ZMMessageDecryptionErrorCodeKey = @"decryptionErrorCode";
         return nil;
     }
     
-    NSEntityDescription *entity = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[self.entityName];
-    NSPredicate *noncePredicate = [NSPredicate predicateWithFormat:@"%K == %@", ZMMessageNonceDataKey, [nonce data]];
-    
-    BOOL checkedAllHiddenMessages = NO;
-    BOOL checkedAllVisibleMessage = NO;
-
-    if (![conversation hasFaultForRelationshipNamed:ZMConversationAllMessagesKey]) {
-        checkedAllVisibleMessage = YES;
-        for (ZMMessage *message in conversation.allMessages) {
-            if (message.isFault) {
-                checkedAllVisibleMessage = NO;
-            } else if ([message.entity isKindOfEntity:entity] && [noncePredicate evaluateWithObject:message]) {
-                return (id) message;
-            }
-        }
+    ConversationMessageNonceIndex *nonceIndex = moc.conversationMessageNonceIndex;
+    ZMMessage *indexedMessage = [nonceIndex messageWithNonce:nonce inConversation:conversation];
+    if ([indexedMessage isKindOfClass:[self class]]) {
+        return (id) indexedMessage;
     }
     
-    if (![conversation hasFaultForRelationshipNamed:ZMConversationHiddenMessagesKey]) {
-        checkedAllHiddenMessages = YES;
-        for (ZMMessage *message in conversation.hiddenMessages) {
-            if (message.isFault) {
-                checkedAllHiddenMessages = NO;
-            } else if ([message.entity isKindOfEntity:entity] && [noncePredicate evaluateWithObject:message]) {
-                return (id) message;
-            }
-        }
-    }
-
-    if (checkedAllVisibleMessage && checkedAllHiddenMessages) {
-        return nil;
-    }
+    // On an index miss we go straight to the fetch: the nonce is indexed in the store, while walking the
+    // messages of the conversation would fire their faults. The fetch includes the unsaved changes.
+    NSEntityDescription *entity = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[self.entityName];
+    NSPredicate *noncePredicate = [NSPredicate predicateWithFormat:@"%K == %@", ZMMessageNonceDataKey, [nonce data]];
 
     NSPredicate *conversationPredicate = [NSPredicate predicateWithFormat:@"%K == %@ OR %K == %@", ZMMessageConversationKey, conversation.objectID, ZMMessageHiddenInConversationKey, conversation.objectID];
     
@@ -473,6 +452,7 @@ NSString * const ZMMessageDecryptionErrorCodeKey = @"decryptionErrorCode";
     ZMMessage *message = fetchResult.firstObject;
     
     if ([message.entity isKindOfEntity:entity]) {
+        [nonceIndex addMessage:message];
         return message;
     } else {
         return nil;
@@ -27,9 +27,7 @@ extension ZMOTRMessage {
     override public var causedSecurityLevelDegradation: Bool {
         get {
             guard let conversation = self.conversation, let moc = self.managedObjectContext else { return false }
-            let messagesByConversation = moc.messagesThatCausedSecurityLevelDegradationByConversation
-            guard let messages = messagesByConversation[conversation.objectID] else { return false }
-            return messages.contains(self.objectID)
+            return moc.sideState.degradingMessagesByConversation[conversation.objectID]?.contains(self.objectID) ?? false
         }
         set {
             guard let conversation = self.conversation, let moc = self.managedObjectContext else { return }
@@ -43,21 +41,7 @@ extension ZMOTRMessage {
                 try! moc.obtainPermanentIDs(for: [conversation])
             }
 
-            // set
-            var dictionary = moc.messagesThatCausedSecurityLevelDegradationByConversation
-            var messagesForConversation = dictionary[conversation.objectID] ?? Set()
-            if newValue {
-                messagesForConversation.insert(self.objectID)
-            } else {
-                messagesForConversation.remove(self.objectID)
-            }
-            if messagesForConversation.isEmpty {
-                dictionary.removeValue(forKey: conversation.objectID)
-            } else {
-                dictionary[conversation.objectID] = messagesForConversation
-            }
-            moc.messagesThatCausedSecurityLevelDegradationByConversation = dictionary
-            moc.zm_hasUserInfoChanges = true
+            moc.sideState.setMessage(self.objectID, causedSecurityLevelDegradation: newValue, in: conversation.objectID)
         }
     }
 }
@@ -69,7 +53,7 @@ extension ZMConversation {
     /// and not persisted).
     public var messagesThatCausedSecurityLevelDegradation: [ZMOTRMessage] {
         guard let moc = self.managedObjectContext else { return [] }
-        guard let messageIds = moc.messagesThatCausedSecurityLevelDegradationByConversation[self.objectID] else { return [] }
+        guard let messageIds = moc.sideState.degradingMessagesByConversation[self.objectID] else { return [] }
         return messageIds.compactMap {
             (try? moc.existingObject(with: $0)) as? ZMOTRMessage
         }
@@ -77,34 +61,19 @@ extension ZMConversation {
 
     public func clearMessagesThatCausedSecurityLevelDegradation() {
         guard let moc = self.managedObjectContext else { return }
-        var currentMessages = moc.messagesThatCausedSecurityLevelDegradationByConversation
-        if currentMessages.removeValue(forKey: self.objectID) != nil {
-            moc.messagesThatCausedSecurityLevelDegradationByConversation = currentMessages
-        }
+        moc.sideState.clearDegradingMessages(in: self.objectID)
     }
 }
 
-private let messagesThatCausedSecurityLevelDegradationKey = "ZM_messagesThatCausedSecurityLevelDegradation"
-
-typealias SecurityDegradingMessagesByConversation = [NSManagedObjectID: Set<NSManagedObjectID>]
-
 extension NSManagedObjectContext {
 
-    /// Non-persisted list of messages that caused security level degradation, indexed by conversation
-    fileprivate(set) var messagesThatCausedSecurityLevelDegradationByConversation: SecurityDegradingMessagesByConversation {
-        get {
-            return self.userInfo[messagesThatCausedSecurityLevelDegradationKey] as? SecurityDegradingMessagesByConversation ?? SecurityDegradingMessagesByConversation()
-        }
-        set {
-            self.userInfo[messagesThatCausedSecurityLevelDegradationKey] = newValue
-            self.zm_hasUserInfoChanges = true
-        }
-    }
-
-    /// Merge list of messages that caused security level degradation from one context to another
+    /// Applies the security level degradation changes recorded by the context with the given user info
+    /// which weren't pulled yet.
     func mergeSecurityLevelDegradationInfo(fromUserInfo userInfo: [String: Any]) {
         guard self.zm_isUserInterfaceContext else { return } // we don't merge anything to sync, sync is autoritative
-        let valuesToMerge = userInfo[messagesThatCausedSecurityLevelDegradationKey] as? SecurityDegradingMessagesByConversation
-        self.messagesThatCausedSecurityLevelDegradationByConversation = valuesToMerge ?? SecurityDegradingMessagesByConversation()
+
+        if let source = userInfo[NSManagedObjectContext.SideStateKey] as? ContextSideState, source !== sideState {
+            sideState.applyDegradingMessagesChanges(from: source)
+        }
     }
 }
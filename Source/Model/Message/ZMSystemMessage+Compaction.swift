@@ -0,0 +1,132 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// Bursts of membership and session events, e.g. many team members leaving at once, are merged into
+/// the system message of the first event instead of appending a message for each of them.
+///
+/// An event is merged into the last message of the conversation if it's an unread system message of the
+/// same type and sender, at most `compactionWindow` older than the event, and it stays within
+/// `maximumCompactedEntries` users and clients. Otherwise a new message is started, so a burst is
+/// always split the same way for the same sequence of events. Merging an event advances the timestamps
+/// and unread state of the conversation like appending a message would.
+
+extension ZMSystemMessage {
+
+    /// The maximum number of users and clients a merged system message lists.
+    static let maximumCompactedEntries = 50
+
+    /// How much later than the first event of a message an event can be merged into it.
+    static let compactionWindow: TimeInterval = 60
+
+    fileprivate static let compactableTypes: Set<ZMSystemMessageType> = [.participantsRemoved, .teamMemberLeave, .sessionReset]
+
+    /// Types whose sender is the user the event is about and which are displayed from `users` alone,
+    /// so events of different senders can be merged without losing anyone.
+    fileprivate static let typesDisplayedFromUsers: Set<ZMSystemMessageType> = [.teamMemberLeave]
+
+    fileprivate func canCompact(type: ZMSystemMessageType,
+                                sender: ZMUser,
+                                users: Set<ZMUser>,
+                                clients: Set<UserClient>,
+                                timestamp: Date) -> Bool {
+        guard
+            systemMessageType == type,
+            ZMSystemMessage.compactableTypes.contains(type),
+            childMessages.isEmpty,
+            participantsRemovedReason == .none,
+            let serverTimestamp = serverTimestamp,
+            timestamp >= serverTimestamp,
+            timestamp.timeIntervalSince(serverTimestamp) <= ZMSystemMessage.compactionWindow
+        else {
+            return false
+        }
+
+        if ZMSystemMessage.typesDisplayedFromUsers.contains(type) {
+            // Only merged while every sender is listed, the sender of the merged message is shown from `users` then
+            guard users.contains(sender), let currentSender = self.sender, self.users.contains(currentSender) else { return false }
+        } else if type == .participantsRemoved {
+            // Users who left by themselves are displayed from the sender, only removals by someone else are merged
+            guard self.sender == sender, !users.contains(sender), !self.users.contains(sender) else { return false }
+        } else {
+            guard self.sender == sender else { return false }
+        }
+
+        let entries = self.users.union(users).count + Set(self.clients.compactMap { $0 as? UserClient }).union(clients).count
+        return entries <= ZMSystemMessage.maximumCompactedEntries
+    }
+
+    fileprivate func compact(users: Set<ZMUser>, clients: Set<UserClient>) {
+        if !users.isSubset(of: self.users) {
+            self.users = self.users.union(users)
+        }
+
+        let currentClients = Set(self.clients.compactMap { $0 as? UserClient })
+        if !clients.isSubset(of: currentClients) {
+            self.clients = currentClients.union(clients)
+        }
+    }
+
+}
+
+extension ZMConversation {
+
+    /// Appends a system message, or merges it into the last message of the conversation
+    /// if that's a system message it can be compacted with.
+    @discardableResult
+    func appendCompactedSystemMessage(type: ZMSystemMessageType,
+                                      sender: ZMUser,
+                                      users: Set<ZMUser>,
+                                      clients: Set<UserClient>,
+                                      timestamp: Date) -> ZMSystemMessage {
+        if let lastMessage = lastMessage as? ZMSystemMessage,
+           !lastMessage.isZombieObject,
+           !isRead(lastMessage),
+           lastMessage.canCompact(type: type, sender: sender, users: users, clients: clients, timestamp: timestamp) {
+            lastMessage.compact(users: users, clients: clients)
+            updateTimestampsAfterCompacting(into: lastMessage, at: timestamp)
+            return lastMessage
+        }
+
+        return appendSystemMessage(type: type,
+                                   sender: sender,
+                                   users: users,
+                                   clients: clients,
+                                   timestamp: timestamp)
+    }
+
+    /// A message the self user already read isn't extended, the merged event would never show as unread.
+    private func isRead(_ message: ZMMessage) -> Bool {
+        guard let lastRead = lastReadServerTimeStamp, let serverTimestamp = message.serverTimestamp else { return false }
+        return serverTimestamp <= lastRead
+    }
+
+    /// The merged message keeps the timestamp of its first event, the conversation is advanced to the
+    /// timestamp of the merged event instead, like `append(_:)` does for a new message.
+    private func updateTimestampsAfterCompacting(into message: ZMSystemMessage, at timestamp: Date) {
+        updateServerModified(timestamp)
+
+        if message.shouldGenerateUnreadCount() {
+            updateLastModified(timestamp)
+        }
+
+        calculateLastUnreadMessages()
+    }
+
+}
@@ -0,0 +1,283 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let MessageReactionIndexKey = "MessageReactionIndexKey"
+
+    var messageReactionIndex: MessageReactionIndex {
+        if let index = userInfo[NSManagedObjectContext.MessageReactionIndexKey] as? MessageReactionIndex {
+            return index
+        }
+
+        let index = MessageReactionIndex(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.MessageReactionIndexKey] = index
+        return index
+    }
+
+}
+
+/// Summarizes the reactions of messages, so adding, removing and counting reactions doesn't walk the
+/// reactions of a message and the users of each reaction.
+///
+/// A summary is built the first time the reactions of a message are accessed through the index and then
+/// updated in place by the index itself. Changes to the reactions made elsewhere, e.g. merged from another
+/// context or by clearing all reactions, drop the summary instead. Summaries only hold object IDs and counts,
+/// so they neither retain the messages, reactions and users nor fault the users in. At most
+/// `maximumSummaryCount` summaries are kept, the least recently read ones are dropped beyond that.
+
+final class MessageReactionIndex: NSObject, TearDownCapable {
+
+    final class Summary {
+
+        /// The number of users per emoji, emojis without users are left out.
+        fileprivate(set) var countsByEmoji: [String: Int] = [:]
+
+        /// The emoji each user reacted with, keyed by the object ID of the user.
+        fileprivate(set) var emojiByUser: [NSManagedObjectID: String] = [:]
+
+        fileprivate var reactionsByEmoji: [String: NSManagedObjectID] = [:]
+        fileprivate var hasTemporaryIDs = false
+        fileprivate var lastUse: UInt64 = 0
+
+        fileprivate init(reactions: Set<Reaction>) {
+            for reaction in reactions {
+                guard let emoji = reaction.unicodeValue else { continue }
+
+                reactionsByEmoji[emoji] = reaction.objectID
+
+                // Reading the IDs of the users doesn't fire the fault of the relationship nor of the users.
+                let userIDs = reaction.objectIDs(forRelationshipNamed: ZMReactionUsersValueKey)
+                guard !userIDs.isEmpty else { continue }
+                countsByEmoji[emoji, default: 0] += userIDs.count
+                userIDs.forEach { emojiByUser[$0] = emoji }
+            }
+
+            hasTemporaryIDs = reactionsByEmoji.values.contains { $0.isTemporaryID } || emojiByUser.keys.contains { $0.isTemporaryID }
+        }
+
+    }
+
+    static let maximumSummaryCount = 1_000
+
+    private var summaries: [NSManagedObjectID: Summary] = [:]
+    private var useCounter: UInt64 = 0
+    private var incrementalUpdateDepth = 0
+    private var hasTemporaryIDs = false
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        super.init()
+
+        observerTokens = [
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            },
+            NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] _ in
+                self?.dropTemporaryIDs()
+            }
+        ]
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach(NotificationCenter.default.removeObserver)
+        observerTokens = []
+        invalidateAll()
+    }
+
+    // MARK: - Lookup
+
+    func summary(for message: ZMMessage) -> Summary {
+        if let summary = summaries[message.objectID] {
+            touch(summary)
+            return summary
+        }
+
+        let summary = Summary(reactions: message.reactions)
+        summary.hasTemporaryIDs = summary.hasTemporaryIDs || message.objectID.isTemporaryID
+        hasTemporaryIDs = hasTemporaryIDs || summary.hasTemporaryIDs
+        touch(summary)
+        summaries[message.objectID] = summary
+        evictIfNeeded()
+        return summary
+    }
+
+    /// The users who reacted with each emoji.
+    func usersByEmoji(of message: ZMMessage) -> [String: [ZMUser]] {
+        guard let context = managedObjectContext else { return [:] }
+
+        var result = [String: [ZMUser]]()
+        for (userID, emoji) in summary(for: message).emojiByUser {
+            guard let user = context.object(with: userID) as? ZMUser else { continue }
+            result[emoji, default: []].append(user)
+        }
+        return result
+    }
+
+    private func touch(_ summary: Summary) {
+        useCounter += 1
+        summary.lastUse = useCounter
+    }
+
+    /// Drops the least recently read summaries until the index is back to three quarters of its limit,
+    /// so evictions are amortized over many reads.
+    private func evictIfNeeded() {
+        guard summaries.count > MessageReactionIndex.maximumSummaryCount else { return }
+
+        let leastRecentlyUsedFirst = summaries.sorted { $0.value.lastUse < $1.value.lastUse }
+
+        for (messageID, _) in leastRecentlyUsedFirst {
+            guard summaries.count > MessageReactionIndex.maximumSummaryCount / 4 * 3 else { break }
+            summaries.removeValue(forKey: messageID)
+        }
+    }
+
+    // MARK: - Updates
+
+    /// Sets the reaction of a user, an empty or `nil` emoji removes it. Returns `true` if the reaction changed.
+    @discardableResult
+    func setReaction(_ emoji: String?, forUser user: ZMUser, on message: ZMMessage) -> Bool {
+        guard let context = managedObjectContext else { return false }
+
+        let summary = self.summary(for: message)
+        let emoji = emoji.flatMap { $0.isEmpty ? nil : $0 }
+        let previousEmoji = summary.emojiByUser[user.objectID]
+
+        guard emoji != previousEmoji else { return false }
+
+        incrementalUpdateDepth += 1
+        defer { incrementalUpdateDepth -= 1 }
+
+        if let previousEmoji = previousEmoji {
+            if let reactionID = summary.reactionsByEmoji[previousEmoji], let reaction = context.object(with: reactionID) as? Reaction {
+                reaction.mutableSetValue(forKey: ZMReactionUsersValueKey).remove(user)
+            }
+            summary.emojiByUser.removeValue(forKey: user.objectID)
+
+            let count = (summary.countsByEmoji[previousEmoji] ?? 1) - 1
+            summary.countsByEmoji[previousEmoji] = count > 0 ? count : nil
+        }
+
+        if let emoji = emoji {
+            if let reactionID = summary.reactionsByEmoji[emoji], let reaction = context.object(with: reactionID) as? Reaction {
+                reaction.mutableSetValue(forKey: ZMReactionUsersValueKey).add(user)
+            } else {
+                let reaction = Reaction.insertReaction(emoji, users: [user], inMessage: message)
+                message.mutableSetValue(forKey: #keyPath(ZMMessage.reactions)).add(reaction)
+                summary.reactionsByEmoji[emoji] = reaction.objectID
+            }
+
+            summary.emojiByUser[user.objectID] = emoji
+            summary.countsByEmoji[emoji, default: 0] += 1
+
+            if user.objectID.isTemporaryID || summary.reactionsByEmoji[emoji]?.isTemporaryID == true {
+                summary.hasTemporaryIDs = true
+                hasTemporaryIDs = true
+            }
+        }
+
+        return true
+    }
+
+    func reactionsDidChange(of message: ZMMessage) {
+        guard incrementalUpdateDepth == 0 else { return }
+        invalidate(message)
+    }
+
+    func invalidate(_ message: ZMMessage) {
+        summaries.removeValue(forKey: message.objectID)
+    }
+
+    func invalidateAll() {
+        summaries = [:]
+        hasTemporaryIDs = false
+    }
+
+    /// Temporary IDs change when the context saves, the summaries holding them would no longer match.
+    private func dropTemporaryIDs() {
+        guard hasTemporaryIDs else { return }
+        hasTemporaryIDs = false
+
+        summaries = summaries.filter { !$0.value.hasTemporaryIDs }
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard !summaries.isEmpty, let refreshed = userInfo[NSRefreshedObjectsKey] as? Set<NSManagedObject> else { return }
+
+        for object in refreshed {
+            switch object {
+            case let message as ZMMessage:
+                invalidate(message)
+            case let reaction as Reaction:
+                reaction.message.map(invalidate)
+            default:
+                break
+            }
+        }
+    }
+
+}
+
+// MARK: - Model hooks
+
+// The hooks of messages are shared with other caches, see `ZMManagedObject+ChangeHooks.swift`.
+//
+// Reaction users mutated through their mutable set report the change through
+// `didChange(_:valuesForKey:with:)`, so that variant is routed to the same hook.
+
+extension Reaction {
+
+    open override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+        valueDidChange(forKey: key)
+    }
+
+    open override func didChange(_ change: NSKeyValueSetMutationKind, valuesForKey key: String, with objects: Set<AnyHashable>) {
+        super.didChange(change, valuesForKey: key, with: objects)
+        valueDidChange(forKey: key)
+    }
+
+    private func valueDidChange(forKey key: String) {
+        guard
+            key == ZMReactionUsersValueKey || key == ZMReactionMessageValueKey,
+            let message = message
+        else { return }
+
+        managedObjectContext?.messageReactionIndex.reactionsDidChange(of: message)
+    }
+
+}
@@ -0,0 +1,250 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension NSManagedObjectContext {
+
+    static let AvailabilityBroadcastRosterKey = "AvailabilityBroadcastRosterKey"
+
+    var availabilityBroadcastRoster: AvailabilityBroadcastRoster {
+        if let roster = userInfo[NSManagedObjectContext.AvailabilityBroadcastRosterKey] as? AvailabilityBroadcastRoster {
+            return roster
+        }
+
+        let roster = AvailabilityBroadcastRoster(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.AvailabilityBroadcastRosterKey] = roster
+        return roster
+    }
+
+}
+
+/// Keeps the known team members and the connected users of other teams sorted by remote identifier, so the
+/// recipients of an availability broadcast are a prefix of each list.
+///
+/// The lists are built the first time they are read. Team members joining a conversation with the self user
+/// are inserted in place, any other change which can affect the lists, e.g. a participant leaving, a team
+/// membership or a connection changing, drops the affected list instead.
+
+final class AvailabilityBroadcastRoster: NSObject, TearDownCapable {
+
+    /// Users sorted by the transport string of their remote identifier.
+    struct SortedUsers {
+
+        private(set) var users: [ZMUser] = []
+        private var keys: [String] = []
+        private var members: Set<ZMUser> = []
+
+        init<S: Sequence>(_ users: S) where S.Element == ZMUser {
+            let sorted = users.map { (SortedUsers.key(of: $0), $0) }.sorted { $0.0 < $1.0 }
+            self.keys = sorted.map(\.0)
+            self.users = sorted.map(\.1)
+            self.members = Set(self.users)
+        }
+
+        func contains(_ user: ZMUser) -> Bool {
+            return members.contains(user)
+        }
+
+        func prefix(_ maxLength: Int) -> ArraySlice<ZMUser> {
+            return users.prefix(max(maxLength, 0))
+        }
+
+        mutating func insert(_ user: ZMUser) {
+            guard members.insert(user).inserted else { return }
+
+            let key = SortedUsers.key(of: user)
+            var low = 0
+            var high = keys.count
+
+            while low < high {
+                let mid = (low + high) / 2
+                if keys[mid] < key {
+                    low = mid + 1
+                } else {
+                    high = mid
+                }
+            }
+
+            keys.insert(key, at: low)
+            users.insert(user, at: low)
+        }
+
+        private static func key(of user: ZMUser) -> String {
+            return user.remoteIdentifier?.transportString() ?? ""
+        }
+
+    }
+
+    private var teamMembers: SortedUsers?
+    private var teamUsers: SortedUsers?
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerToken: NSObjectProtocol?
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        super.init()
+
+        observerToken = NotificationCenter.default.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                               object: managedObjectContext,
+                                                               queue: nil) { [weak self] note in
+            self?.objectsDidChange(note)
+        }
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        if let token = observerToken {
+            NotificationCenter.default.removeObserver(token)
+        }
+        observerToken = nil
+        invalidateAll()
+    }
+
+    // MARK: - Lookup
+
+    /// The users who both share the team and a conversation with the self user, see `ZMUser.knownTeamMembers(in:)`.
+    var knownTeamMembers: SortedUsers {
+        if let teamMembers = teamMembers {
+            return teamMembers
+        }
+
+        guard let context = managedObjectContext else { return SortedUsers([]) }
+
+        let teamMembers = SortedUsers(ZMUser.knownTeamMembers(in: context))
+        self.teamMembers = teamMembers
+        return teamMembers
+    }
+
+    /// The users from another team who are connected with the self user, see `ZMUser.knownTeamUsers(in:)`.
+    var knownTeamUsers: SortedUsers {
+        if let teamUsers = teamUsers {
+            return teamUsers
+        }
+
+        guard let context = managedObjectContext else { return SortedUsers([]) }
+
+        let teamUsers = SortedUsers(ZMUser.knownTeamUsers(in: context))
+        self.teamUsers = teamUsers
+        return teamUsers
+    }
+
+    // MARK: - Updates
+
+    /// Inserts the user of a participant role that was added to a conversation of the self user, or all
+    /// participants of the conversation if the self user was added to it.
+    func participantRoleDidChange(_ participantRole: ParticipantRole) {
+        guard
+            teamMembers != nil,
+            let context = managedObjectContext,
+            let conversation = participantRole.conversation,
+            let user = participantRole.user
+        else { return }
+
+        let selfUser = ZMUser.selfUser(in: context)
+        let entry = context.conversationParticipantIndex.entry(for: conversation)
+
+        guard entry.containsSelfUser else { return }
+
+        let addedUsers = user == selfUser ? Array(entry.members) : [user]
+
+        for user in addedUsers where user != selfUser && user.isOnSameTeam(otherUser: selfUser) {
+            teamMembers?.insert(user)
+        }
+    }
+
+    func invalidateTeamMembers() {
+        teamMembers = nil
+    }
+
+    func invalidateTeamUsers() {
+        teamUsers = nil
+    }
+
+    func invalidateAll() {
+        teamMembers = nil
+        teamUsers = nil
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard teamMembers != nil || teamUsers != nil else { return }
+
+        // Participant roles inserted in this context are already applied by the model hooks
+        let inserted = (userInfo[NSInsertedObjectsKey] as? Set<NSManagedObject>) ?? []
+        inserted.lazy.compactMap { $0 as? ParticipantRole }.forEach(participantRoleDidChange)
+
+        for key in [NSInsertedObjectsKey, NSRefreshedObjectsKey, NSDeletedObjectsKey] {
+            guard let objects = userInfo[key] as? Set<NSManagedObject> else { continue }
+
+            for object in objects {
+                switch object {
+                case is Member, is Team:
+                    invalidateAll()
+                    return
+                case is ZMConnection:
+                    invalidateTeamUsers()
+                case is ParticipantRole where key != NSInsertedObjectsKey:
+                    invalidateTeamMembers()
+                default:
+                    break
+                }
+            }
+        }
+    }
+
+}
+
+// MARK: - Model hooks
+
+// The hooks of users and participant roles are shared with other caches, see
+// `ZMManagedObject+ChangeHooks.swift`. Members also keep the team member directory up to date.
+
+extension Member {
+
+    public override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+
+        if key == #keyPath(Member.team) || key == #keyPath(Member.user) {
+            managedObjectContext?.availabilityBroadcastRoster.invalidateAll()
+            managedObjectContext?.teamMemberDirectory.memberDidChange(self)
+        }
+    }
+
+}
+
+extension ZMConnection {
+
+    open override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+
+        if key == ZMConnectionStatusKey || key == #keyPath(ZMConnection.to) {
+            managedObjectContext?.availabilityBroadcastRoster.invalidateTeamUsers()
+        }
+    }
+
+}
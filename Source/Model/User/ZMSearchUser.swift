@@ -134,6 +134,11 @@ public class ZMSearchUser: NSObject, UserType {
     fileprivate var internalCompleteImageData: Data?
     fileprivate var internalIsAccountDeleted: Bool?
 
+    /// Incremented whenever image data is set on the search user, so observers can tell
+    /// the images changed without comparing the data.
+    internal private(set) var previewImageDataVersion = 0
+    internal private(set) var completeImageDataVersion = 0
+
     @objc
     public var hasTeam: Bool {
         return user?.hasTeam ?? false
@@ -673,8 +678,10 @@ public class ZMSearchUser: NSObject, UserType {
         switch size {
         case .preview:
             internalPreviewImageData = imageData
+            previewImageDataVersion += 1
         case .complete:
             internalCompleteImageData = imageData
+            completeImageDataVersion += 1
         }
 
         contextProvider?.viewContext.searchUserObserverCenter.notifyUpdatedSearchUser(self)
@@ -64,6 +64,9 @@ extension ZMUser {
     /// a limited subset of all users. Known team members are priortized first, followed by
     /// connected non team members. The self user is guaranteed to be a recipient.
     ///
+    /// Both groups are read as a prefix of the context's `availabilityBroadcastRoster`, which keeps
+    /// them sorted by remote identifier.
+    ///
     /// - Parameters:
     ///     - context: The context to search in.
     ///     - maxCount: The maximum number of recipients to return.
@@ -71,23 +74,16 @@ extension ZMUser {
     public static func recipientsForAvailabilityStatusBroadcast(in context: NSManagedObjectContext, maxCount: Int) -> Set<ZMUser> {
         var recipients: Set = [selfUser(in: context)]
         var remainingSlots = maxCount - recipients.count
+        let roster = context.availabilityBroadcastRoster
 
-        let sortByIdentifer: (ZMUser, ZMUser) -> Bool = {
-            $0.remoteIdentifier.transportString() < $1.remoteIdentifier.transportString()
-        }
-
-        let teamMembers = knownTeamMembers(in: context)
-            .sorted(by: sortByIdentifer)
-            .prefix(remainingSlots)
+        let teamMembers = roster.knownTeamMembers.prefix(remainingSlots)
 
         recipients.formUnion(teamMembers)
         remainingSlots = maxCount - recipients.count
 
         guard remainingSlots > 0 else { return recipients }
 
-        let teamUsers = knownTeamUsers(in: context)
-            .sorted(by: sortByIdentifer)
-            .prefix(remainingSlots)
+        let teamUsers = roster.knownTeamUsers.prefix(remainingSlots)
 
         recipients.formUnion(teamUsers)
 
@@ -18,7 +18,7 @@
 
 import Foundation
 
-enum ConversationAction {
+enum ConversationAction: CaseIterable {
     case addConversationMember
     case removeConversationMember
     case modifyConversationName
@@ -42,6 +42,34 @@ enum ConversationAction {
         case .deleteConvesation: return "delete_conversation"
         }
     }
+
+    private static let actionsByName = Dictionary(uniqueKeysWithValues: allCases.map { ($0.name, $0) })
+
+    init?(name: String) {
+        guard let action = ConversationAction.actionsByName[name] else { return nil }
+        self = action
+    }
+
+    var mask: ConversationActionMask {
+        return ConversationActionMask(rawValue: 1 << ConversationAction.allCases.firstIndex(of: self)!)
+    }
+}
+
+/// A set of conversation actions, one bit per `ConversationAction`.
+struct ConversationActionMask: OptionSet, Hashable {
+    let rawValue: UInt32
+
+    /// Returns the mask of the given action names, names which aren't known are ignored.
+    init<S: Sequence>(actionNames: S) where S.Element == String? {
+        self = actionNames.reduce(into: ConversationActionMask()) { mask, name in
+            guard let name = name, let action = ConversationAction(name: name) else { return }
+            mask.formUnion(action.mask)
+        }
+    }
+
+    init(rawValue: UInt32) {
+        self.rawValue = rawValue
+    }
 }
 
 public extension ZMUser {
@@ -57,28 +85,28 @@ public extension ZMUser {
     @objc(canAddServiceToConversation:)
     func canAddService(to conversation: ZMConversation) -> Bool {
         guard !isGuest(in: conversation), conversation.conversationType == .group else { return false }
-        return hasRoleWithAction(actionName: ConversationAction.addConversationMember.name,
+        return hasRoleWithAction(.addConversationMember,
                                  conversation: conversation)
     }
 
     @objc(canRemoveServiceFromConversation:)
     func canRemoveService(from conversation: ZMConversation) -> Bool {
         guard !isGuest(in: conversation), conversation.conversationType == .group else { return false }
-        return hasRoleWithAction(actionName: ConversationAction.removeConversationMember.name,
+        return hasRoleWithAction(.removeConversationMember,
                                  conversation: conversation)
     }
 
     @objc(canAddUserToConversation:)
     func canAddUser(to conversation: ConversationLike) -> Bool {
         guard conversation.conversationType == .group else { return false }
-        return hasRoleWithAction(actionName: ConversationAction.addConversationMember.name,
+        return hasRoleWithAction(.addConversationMember,
                                  conversation: conversation)
     }
 
     @objc(canRemoveUserFromConversation:)
     func canRemoveUser(from conversation: ZMConversation) -> Bool {
         guard conversation.conversationType == .group else { return false }
-        return hasRoleWithAction(actionName: ConversationAction.removeConversationMember.name,
+        return hasRoleWithAction(.removeConversationMember,
                                  conversation: conversation)
     }
 
@@ -86,7 +114,7 @@ public extension ZMUser {
     func canDeleteConversation(_ conversation: ZMConversation) -> Bool {
         guard conversation.conversationType == .group else { return false }
         let selfUser = ZMUser.selfUser(in: self.managedObjectContext!)
-        return hasRoleWithAction(actionName: ConversationAction.deleteConvesation.name,
+        return hasRoleWithAction(.deleteConvesation,
                                  conversation: conversation) && conversation.creator == self
             && selfUser.hasTeam && selfUser.teamIdentifier == self.teamIdentifier
     }
@@ -94,21 +122,21 @@ public extension ZMUser {
     @objc(canModifyOtherMemberInConversation:)
     func canModifyOtherMember(in conversation: ZMConversation) -> Bool {
         guard conversation.conversationType == .group else { return false }
-        return hasRoleWithAction(actionName: ConversationAction.modifyOtherConversationMember.name,
+        return hasRoleWithAction(.modifyOtherConversationMember,
                                  conversation: conversation)
     }
 
     @objc(canModifyReadReceiptSettingsInConversation:)
     func canModifyReadReceiptSettings(in conversation: ConversationLike) -> Bool {
         guard conversation.conversationType == .group else { return false }
-        return hasRoleWithAction(actionName: ConversationAction.modifyConversationReceiptMode.name,
+        return hasRoleWithAction(.modifyConversationReceiptMode,
                                  conversation: conversation)
     }
 
     @objc(canModifyEphemeralSettingsInConversation:)
     func canModifyEphemeralSettings(in conversation: ConversationLike) -> Bool {
         if conversation.conversationType == .group {
-            return hasRoleWithAction(actionName: ConversationAction.modifyConversationMessageTimer.name, conversation: conversation)
+            return hasRoleWithAction(.modifyConversationMessageTimer, conversation: conversation)
         } else {
             guard
                 conversation.teamRemoteIdentifier == nil || !isGuest(in: conversation),
@@ -131,20 +159,20 @@ public extension ZMUser {
             conversation.teamRemoteIdentifier != nil
             else { return false }
 
-        return hasRoleWithAction(actionName: ConversationAction.modifyConversationAccess.name, conversation: conversation)
+        return hasRoleWithAction(.modifyConversationAccess, conversation: conversation)
     }
 
     @objc(canModifyTitleInConversation:)
     func canModifyTitle(in conversation: ConversationLike) -> Bool {
         guard conversation.conversationType == .group else { return false }
 
-        return hasRoleWithAction(actionName: ConversationAction.modifyConversationName.name, conversation: conversation)
+        return hasRoleWithAction(.modifyConversationName, conversation: conversation)
     }
 
     @objc(canLeave:)
     func canLeave(_ conversation: ZMConversation) -> Bool {
         guard conversation.conversationType == .group else { return true }
-        return hasRoleWithAction(actionName: ConversationAction.leaveConversation.name, conversation: conversation)
+        return hasRoleWithAction(.leaveConversation, conversation: conversation)
     }
 
     @objc
@@ -215,10 +243,14 @@ public extension ZMUser {
         }
     }
 
-    private func hasRoleWithAction(actionName: String, conversation: ConversationLike) -> Bool {
+    private func hasRoleWithAction(_ action: ConversationAction, conversation: ConversationLike) -> Bool {
+        if let conversation = conversation as? ZMConversation, let context = managedObjectContext {
+            return context.conversationPermissionCache.effectiveMask(of: self, in: conversation).contains(action.mask)
+        }
+
         guard conversation.isSelfAnActiveMember,
             let role = self.role(in: conversation)
         else { return false }
-        return role.actions.contains(where: {$0.name == actionName})
+        return role.actions.contains(where: {$0.name == action.name})
     }
 }
@@ -67,6 +67,38 @@ extension ZMUser {
         return NSCompoundPredicate(andPredicateWithSubpredicates: orPredicates)
     }
 
+    /// Retrieves users with name or handle matching search string, having one of given connection statuses
+    ///
+    /// The name and handle matching is answered by the search name index of the context instead of
+    /// evaluating regular expressions on every user.
+    ///
+    /// - Parameters:
+    ///   - query: search string
+    ///   - connectionStatuses: an array of connections status of the users. E.g. for connected users it is [ZMConnectionStatus.accepted.rawValue]
+    ///   - context: the context in which the predicate will be used
+    /// - Returns: predicate having search query and supplied connection statuses
+    public static func predicateForUsers(withSearch query: String, connectionStatuses: [Int16]?, in context: NSManagedObjectContext) -> NSPredicate {
+        var allPredicates = [NSPredicate]()
+        if let statuses = connectionStatuses {
+            allPredicates.append(predicateForUsers(withConnectionStatuses: statuses))
+        }
+
+        if !query.isEmpty {
+            let index = context.searchNameIndex
+            var matches = index.objectIDs(matching: query, in: [.userName])
+            matches.formUnion(index.objectIDs(withTokenPrefix: query.strippingLeadingAtSign(), in: .userHandle))
+
+            if matches.count > SearchNameIndex.maximumPredicateMatchCount {
+                // Evaluating the regular expressions is cheaper than listing that many users
+                allPredicates.append(predicateForUsers(withSearch: query, connectionStatuses: nil))
+            } else {
+                allPredicates.append(NSPredicate(format: "SELF IN %@", matches.map(context.object(with:))))
+            }
+        }
+
+        return NSCompoundPredicate(andPredicateWithSubpredicates: allPredicates)
+    }
+
     @objc(predicateForUsersWithConnectionStatusInArray:)
     public static func predicateForUsers(withConnectionStatuses connectionStatuses: [Int16]) -> NSPredicate {
         return NSPredicate(format: "(%K IN (%@))", #keyPath(ZMUser.connection.status), connectionStatuses)
@@ -231,9 +231,11 @@ extension ZMUser {
     public func setImage(data: Data?, size: ProfileImageSize) {
         guard let imageData = data else {
             managedObjectContext?.zm_userImageCache?.removeAllUserImages(self)
+            managedObjectContext?.assetDownloadWorkIndex.update(self)
             return
         }
         managedObjectContext?.zm_userImageCache?.setUserImage(self, imageData: imageData, size: size)
+        managedObjectContext?.assetDownloadWorkIndex.update(self, kind: AssetDownloadKind(size))
 
         if let uiContext = managedObjectContext?.zm_userInterface {
             let changedKey = size == .preview ? #keyPath(ZMUser.previewImageData) : #keyPath(ZMUser.completeImageData)
@@ -251,29 +253,11 @@ extension ZMUser {
     }
 
     public static var previewImageDownloadFilter: NSPredicate {
-        let assetIdExists = NSPredicate(format: "(%K != nil)", ZMUser.previewProfileAssetIdentifierKey)
-        let assetIdIsValid = NSPredicate { (user, _) -> Bool in
-            guard let user = user as? ZMUser else { return false }
-            return user.previewProfileAssetIdentifier?.isValidAssetID ?? false
-        }
-        let notCached = NSPredicate { (user, _) -> Bool in
-            guard let user = user as? ZMUser else { return false }
-            return user.imageSmallProfileData == nil
-        }
-        return NSCompoundPredicate(andPredicateWithSubpredicates: [assetIdExists, assetIdIsValid, notCached])
+        return AssetDownloadKind.userPreviewImage.downloadFilter
     }
 
     public static var completeImageDownloadFilter: NSPredicate {
-        let assetIdExists = NSPredicate(format: "(%K != nil)", ZMUser.completeProfileAssetIdentifierKey)
-        let assetIdIsValid = NSPredicate { (user, _) -> Bool in
-            guard let user = user as? ZMUser else { return false }
-            return user.completeProfileAssetIdentifier?.isValidAssetID ?? false
-        }
-        let notCached = NSPredicate { (user, _) -> Bool in
-            guard let user = user as? ZMUser else { return false }
-            return user.imageMediumData == nil
-        }
-        return NSCompoundPredicate(andPredicateWithSubpredicates: [assetIdExists, assetIdIsValid, notCached])
+        return AssetDownloadKind.userCompleteImage.downloadFilter
     }
 
     public func updateAndSyncProfileAssetIdentifiers(previewIdentifier: String, completeIdentifier: String) {
@@ -0,0 +1,188 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+// MARK: - Model hooks
+//
+// Changes are only reported in the objects did change notification once the context processes its
+// pending changes. The per-context caches and indices which have to be up to date as soon as a value is
+// set are therefore updated from these hooks, each class has a single hook dispatching on the changed key.
+// This file holds the hooks of the classes several caches depend on, the hooks only used by a single
+// cache live next to it.
+//
+// To-many relationships mutated through their mutable set (e.g. `mutableSetValue(forKey:)` or the
+// generated `add…` accessors) report the change through `didChange(_:valuesForKey:with:)`, so that
+// variant is routed to the same hook. Changes which don't go through the accessors, e.g. merges, are
+// caught by the objects did change notification observed by each cache.
+
+extension ZMConversation {
+
+    open override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+        valueDidChange(forKey: key)
+    }
+
+    open override func didChange(_ change: NSKeyValueSetMutationKind, valuesForKey key: String, with objects: Set<AnyHashable>) {
+        super.didChange(change, valuesForKey: key, with: objects)
+        valueDidChange(forKey: key)
+    }
+
+    private func valueDidChange(forKey key: String) {
+        guard let context = managedObjectContext else { return }
+
+        switch key {
+        case #keyPath(ZMConversation.participantRoles):
+            context.conversationParticipantIndex.participantRolesDidChange(in: self)
+            context.conversationPermissionCache.invalidate(self)
+        case #keyPath(ZMConversation.clearedTimeStamp):
+            context.conversationLastMessageCache.invalidate(self)
+        default:
+            break
+        }
+    }
+
+}
+
+extension ZMUser {
+
+    open override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+        valueDidChange(forKey: key)
+    }
+
+    open override func didChange(_ change: NSKeyValueSetMutationKind, valuesForKey key: String, with objects: Set<AnyHashable>) {
+        super.didChange(change, valuesForKey: key, with: objects)
+        valueDidChange(forKey: key)
+    }
+
+    private func valueDidChange(forKey key: String) {
+        guard let context = managedObjectContext else { return }
+
+        switch key {
+        case #keyPath(ZMUser.participantRoles):
+            context.conversationParticipantIndex.participantRolesDidChange(of: self)
+            context.conversationPermissionCache.participantRolesDidChange(of: self)
+        case #keyPath(ZMUser.name), #keyPath(ZMUser.normalizedName):
+            context.conversationParticipantIndex.nameDidChange(of: self)
+            context.teamMemberDirectory.nameDidChange(of: self)
+        case "remoteIdentifier_data":
+            // The broadcast roster is sorted by remote identifier, which is also part of the image cache keys
+            context.availabilityBroadcastRoster.invalidateAll()
+            context.assetDownloadWorkIndex.update(self)
+        case "teamIdentifier", "teamIdentifier_data", #keyPath(ZMUser.domain):
+            // The broadcast roster is filtered by team
+            context.availabilityBroadcastRoster.invalidateAll()
+        case ZMUser.previewProfileAssetIdentifierKey:
+            context.assetDownloadWorkIndex.update(self, kind: .userPreviewImage)
+        case ZMUser.completeProfileAssetIdentifierKey:
+            context.assetDownloadWorkIndex.update(self, kind: .userCompleteImage)
+        default:
+            break
+        }
+    }
+
+}
+
+extension ParticipantRole {
+
+    public override func willChangeValue(forKey key: String) {
+        super.willChangeValue(forKey: key)
+
+        guard
+            key == #keyPath(ParticipantRole.conversation) || key == #keyPath(ParticipantRole.user),
+            let context = managedObjectContext,
+            let conversation = conversation
+        else { return }
+
+        context.conversationPermissionCache.invalidate(conversation)
+
+        guard let user = user else { return }
+
+        context.conversationParticipantIndex.remove([user], from: conversation)
+        context.availabilityBroadcastRoster.invalidateTeamMembers()
+    }
+
+    public override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+
+        guard let context = managedObjectContext else { return }
+
+        switch key {
+        case #keyPath(ParticipantRole.conversation), #keyPath(ParticipantRole.user):
+            if let conversation = conversation {
+                context.conversationPermissionCache.invalidate(conversation)
+            }
+            if let conversation = conversation, let user = user {
+                context.conversationParticipantIndex.insert([user], into: conversation)
+                context.availabilityBroadcastRoster.participantRoleDidChange(self)
+            }
+        case #keyPath(ParticipantRole.role):
+            // Without a conversation no cached mask depends on the participant role
+            if let conversation = conversation {
+                context.conversationPermissionCache.invalidate(conversation)
+            }
+        default:
+            break
+        }
+    }
+
+}
+
+extension ZMMessage {
+
+    open override func willChangeValue(forKey key: String) {
+        super.willChangeValue(forKey: key)
+
+        switch key {
+        case ZMMessageConversationKey, ZMMessageServerTimestampKey, ZMMessageSenderKey:
+            managedObjectContext?.conversationLastMessageCache.messageWillChange(self)
+        default:
+            break
+        }
+    }
+
+    open override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+        valueDidChange(forKey: key)
+    }
+
+    open override func didChange(_ change: NSKeyValueSetMutationKind, valuesForKey key: String, with objects: Set<AnyHashable>) {
+        super.didChange(change, valuesForKey: key, with: objects)
+        valueDidChange(forKey: key)
+    }
+
+    private func valueDidChange(forKey key: String) {
+        guard let context = managedObjectContext else { return }
+
+        switch key {
+        case ZMMessageNonceDataKey, ZMMessageHiddenInConversationKey:
+            context.conversationMessageNonceIndex.add(self)
+        case ZMMessageConversationKey:
+            context.conversationMessageNonceIndex.add(self)
+            context.conversationLastMessageCache.messageDidChange(self)
+        case ZMMessageServerTimestampKey, ZMMessageSenderKey:
+            context.conversationLastMessageCache.messageDidChange(self)
+        case #keyPath(ZMMessage.reactions):
+            context.messageReactionIndex.reactionsDidChange(of: self)
+        default:
+            break
+        }
+    }
+
+}
@@ -31,9 +31,128 @@ static NSString * const NeedsToBeUpdatedFromBackendKey = @"needsToBeUpdatedFromB
 static NSString * const RemoteIdentifierDataKey = @"remoteIdentifier_data";
 NSString * const ZMManagedObjectLocallyModifiedKeysKey = @"modifiedKeys";
 static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
+static NSString * const LocallyModifiedKeyTablesKey = @"ZMLocallyModifiedKeyTables";
+
+
+
+/// Assigns a bit to each property of an entity, so that the keys changed by a save can be
+/// collected and compared as a mask rather than as sets.
+@interface ZMLocallyModifiedKeyTable : NSObject
+
+- (instancetype)initWithEntity:(NSEntityDescription *)entity ignoredKeys:(NSSet *)ignoredKeys;
+
+/// The keys tracked unless a subclass overrides @c -keysTrackedForLocalModifications
+@property (nonatomic, readonly) NSSet<NSString *> *defaultTrackedKeys;
+@property (nonatomic, readonly) uint64_t ignoredMask;
+
+/// Returns NO if one of the keys isn't a property of the entity or the entity has too many properties for a mask.
+- (BOOL)getMask:(uint64_t *)mask forKeys:(id<NSFastEnumeration>)keys;
+/// The mask of the tracked keys without the ignored keys, memoized for each set of tracked keys since
+/// @c -keysTrackedForLocalModifications can depend on the object, e.g. only the self user tracks keys.
+- (BOOL)getTrackedMask:(uint64_t *)mask forTrackedKeys:(NSSet<NSString *> *)trackedKeys;
+- (NSSet<NSString *> *)keysForMask:(uint64_t)mask;
+
+@end
+
+
+
+@implementation ZMLocallyModifiedKeyTable
+{
+    NSArray<NSString *> *_keys;
+    NSDictionary<NSString *, NSNumber *> *_bitsByKey;
+    NSMutableDictionary<NSSet<NSString *> *, NSNumber *> *_trackedMasks;
+}
+
+- (instancetype)initWithEntity:(NSEntityDescription *)entity ignoredKeys:(NSSet *)ignoredKeys;
+{
+    self = [super init];
+    if (self) {
+        NSMutableArray *keys = [NSMutableArray array];
+        [entity.attributesByName enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSAttributeDescription *attribute, BOOL *stop) {
+            NOT_USED(stop);
+            if (attribute.attributeType != NSUndefinedAttributeType) {
+                [keys addObject:key];
+            }
+        }];
+        [keys addObjectsFromArray:entity.relationshipsByName.allKeys];
+        [keys sortUsingSelector:@selector(compare:)];
+        _keys = [keys copy];
+        
+        NSMutableDictionary *bitsByKey = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+        [_keys enumerateObjectsUsingBlock:^(NSString *key, NSUInteger idx, BOOL *stop) {
+            NOT_USED(stop);
+            bitsByKey[key] = @(idx);
+        }];
+        _bitsByKey = [bitsByKey copy];
+        
+        NSMutableSet *trackedKeys = [NSMutableSet setWithArray:_keys];
+        [trackedKeys minusSet:ignoredKeys ?: [NSSet set]];
+        _defaultTrackedKeys = [trackedKeys copy];
+        
+        uint64_t ignoredMask = 0;
+        for (NSString *key in ignoredKeys) {
+            NSNumber *bit = _bitsByKey[key];
+            if (bit != nil && bit.unsignedIntegerValue < 64) {
+                ignoredMask |= (1ULL << bit.unsignedIntegerValue);
+            }
+        }
+        _ignoredMask = ignoredMask;
+        _trackedMasks = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (BOOL)getMask:(uint64_t *)mask forKeys:(id<NSFastEnumeration>)keys;
+{
+    if (_keys.count > 64) {
+        return NO;
+    }
+    uint64_t result = 0;
+    for (NSString *key in keys) {
+        NSNumber *bit = _bitsByKey[key];
+        if (bit == nil) {
+            return NO;
+        }
+        result |= (1ULL << bit.unsignedIntegerValue);
+    }
+    *mask = result;
+    return YES;
+}
+
+- (BOOL)getTrackedMask:(uint64_t *)mask forTrackedKeys:(NSSet<NSString *> *)trackedKeys;
+{
+    NSNumber *trackedMask = _trackedMasks[trackedKeys];
+    if (trackedMask == nil) {
+        uint64_t result = 0;
+        if (! [self getMask:&result forKeys:trackedKeys]) {
+            return NO;
+        }
+        trackedMask = @(result & ~self.ignoredMask);
+        _trackedMasks[[trackedKeys copy]] = trackedMask;
+    }
+    *mask = trackedMask.unsignedLongLongValue;
+    return YES;
+}
+
+- (NSSet<NSString *> *)keysForMask:(uint64_t)mask;
+{
+    NSMutableSet *keys = [NSMutableSet set];
+    for (NSUInteger bit = 0; mask != 0; ++bit, mask >>= 1) {
+        if ((mask & 1) != 0) {
+            [keys addObject:_keys[bit]];
+        }
+    }
+    return keys;
+}
+
+@end
+
 
 
 @interface ZMManagedObject ()
+
+- (ZMLocallyModifiedKeyTable *)locallyModifiedKeyTable;
+
 @end
 
 
@@ -102,12 +221,16 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 
 - (NSDictionary *)filteredChangedValues;
 {
+    NSDictionary *changedValues = self.changedValues;
     NSSet *ignoredKeys = self.ignoredKeys;
-    NSArray *changedKeys = [self.changedValues.allKeys filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString *k, NSDictionary *bindings) {
-        NOT_USED(bindings);
-        return ! [ignoredKeys containsObject:k];
-    }]];
-    return [self.changedValues dictionaryWithValuesForKeys:changedKeys];
+    NSMutableDictionary *filteredValues = [NSMutableDictionary dictionaryWithCapacity:changedValues.count];
+    [changedValues enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+        NOT_USED(stop);
+        if (! [ignoredKeys containsObject:key]) {
+            filteredValues[key] = value;
+        }
+    }];
+    return filteredValues;
 }
 
 - (void)setKeysThatHaveLocalModifications:(NSSet *)keys;
@@ -120,7 +243,7 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
     if ([self.modifiedKeys isEqualToSet:changedTrackedKeys]){
         return;
     }
-    self.modifiedKeys = (keys.count == 0) ? nil : [changedTrackedKeys copy];
+    self.modifiedKeys = (changedTrackedKeys.count == 0) ? nil : [changedTrackedKeys copy];
 }
 
 - (NSString *)objectIDURLString
@@ -481,6 +604,9 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 
 - (void)resetLocallyModifiedKeys:(NSSet *)keys;
 {
+    if (! [self.modifiedKeys intersectsSet:keys]) {
+        return;
+    }
     NSMutableSet *newKeys = [self.keysThatHaveLocalModifications mutableCopy];
     [newKeys minusSet:keys];
     self.modifiedKeys = (newKeys.count == 0) ? nil : [newKeys copy];
@@ -515,24 +641,32 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 
 - (NSSet *)keysTrackedForLocalModifications;
 {
-    NSMutableSet *keys = [NSMutableSet set];
-    NSSet *ignoredKeys = self.ignoredKeys;
-    
-    [self.entity.attributesByName enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSAttributeDescription *attribute, BOOL *stop) {
-        NOT_USED(stop);
-        if (attribute.attributeType != NSUndefinedAttributeType && ! [ignoredKeys containsObject:key]) {
-            [keys addObject:key];
-        }
-    }];
+    ZMLocallyModifiedKeyTable *table = self.locallyModifiedKeyTable;
+    if (table != nil) {
+        return table.defaultTrackedKeys;
+    }
+    return [[ZMLocallyModifiedKeyTable alloc] initWithEntity:self.entity ignoredKeys:self.ignoredKeys].defaultTrackedKeys;
+}
+
+/// The key table of the receiver's entity, shared by all objects of the entity in the context.
+- (ZMLocallyModifiedKeyTable *)locallyModifiedKeyTable;
+{
+    NSManagedObjectContext *moc = self.managedObjectContext;
+    if (moc == nil) {
+        return nil;
+    }
     
-    [self.entity.relationshipsByName enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSRelationshipDescription *relationship, BOOL *stop) {
-        NOT_USED(relationship);
-        NOT_USED(stop);
-        if (! [ignoredKeys containsObject:key]) {
-            [keys addObject:key];
+    ZMLocallyModifiedKeyTable *table = moc.userInfo[LocallyModifiedKeyTablesKey][self.entity.name];
+    if (table == nil) {
+        NSMutableDictionary *map = moc.userInfo[LocallyModifiedKeyTablesKey];
+        if (map == nil) {
+            map = [NSMutableDictionary dictionary];
+            moc.userInfo[LocallyModifiedKeyTablesKey] = map;
         }
-    }];
-    return keys;
+        table = [[ZMLocallyModifiedKeyTable alloc] initWithEntity:self.entity ignoredKeys:self.ignoredKeys];
+        map[self.entity.name] = table;
+    }
+    return table;
 }
 
 
@@ -577,6 +711,9 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 - (void)awakeFromFetch
 {
     [super awakeFromFetch];
+    if (Instrumentation.isEnabled) {
+        [Instrumentation incrementCounter:InstrumentationCounterFaultsFired entity:self.entity.name by:1];
+    }
     [self removeObsoleteKeys];
 }
 
@@ -599,6 +736,24 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
     if (![self.class isTrackingLocalModifications]) {
         return;
     }
+    
+    // Most saves don't add any tracked keys, comparing masks avoids building sets for them
+    ZMLocallyModifiedKeyTable *table = self.locallyModifiedKeyTable;
+    uint64_t oldMask = 0;
+    uint64_t changedMask = 0;
+    uint64_t trackedMask = 0;
+    if (table != nil &&
+        [table getMask:&oldMask forKeys:self.modifiedKeys ?: [NSSet set]] &&
+        [table getMask:&changedMask forKeys:self.changedValues] &&
+        [table getTrackedMask:&trackedMask forTrackedKeys:self.keysTrackedForLocalModifications])
+    {
+        uint64_t const updatedMask = oldMask | (changedMask & trackedMask);
+        if (updatedMask != oldMask) {
+            [self setKeysThatHaveLocalModifications:[self filterUpdatedLocallyModifiedKeys:[table keysForMask:updatedMask]]];
+        }
+        return;
+    }
+    
     NSSet *oldKeys = self.keysThatHaveLocalModifications;
     NSMutableSet *newKeys = [oldKeys mutableCopy];
     [newKeys addObjectsFromArray:self.filteredChangedValues.allKeys ?: @[]];
@@ -116,24 +116,7 @@ class ExplicitChangeDetector: ChangeDetector {
     ///     All objects and their observable keys that have changed.
 
     private func observableChangesCausedByChange(in updatedObject: UpdatedObject) -> ObservableChangesByObject {
-        let (object, changedKeys) = (updatedObject.object, updatedObject.changedKeys)
-
-        var result = ObservableChangesByObject()
-
-        let affectedKeysOfUpdatedObject = changedKeys
-            .map { dependencyKeyStore.observableKeysAffectedByValue(object.classIdentifier, key: $0) }
-            .flattened
-
-        if !affectedKeysOfUpdatedObject.isEmpty {
-            result[object] = Changes(changedKeys: affectedKeysOfUpdatedObject)
-        }
-
-        if let sideEffectSource = object as? SideEffectSource {
-            let affectedKeysOfOtherObjects = sideEffectSource.affectedObjectsAndKeys(keyStore: dependencyKeyStore, knownKeys: changedKeys)
-            result = result.merged(with: affectedKeysOfOtherObjects)
-        }
-
-        return result
+        return dependencyKeyStore.observableChanges(causedBy: updatedObject.changedKeys, in: updatedObject.object)
     }
 
     /// Identify which objects and their observable keys have changed as a result of insertion or deletion
@@ -187,14 +170,6 @@ fileprivate extension ExplicitChangeDetector {
 
 }
 
-private extension Sequence where Element: SetAlgebra {
-
-    var flattened: Element {
-        reduce(Element()) { $0.union($1) }
-    }
-
-}
-
 private extension LazySequence {
 
     func collect() -> [Self.Element] {
@@ -25,7 +25,8 @@ extension ModifiedObjects: Mergeable {
             updated: updated.union(other.updated),
             refreshed: refreshed.union(other.refreshed),
             inserted: inserted.union(other.inserted),
-            deleted: deleted.union(other.deleted)
+            deleted: deleted.union(other.deleted),
+            mergedChangedKeys: mergedChangedKeys.merging(other.mergedChangedKeys) { $0.union($1) }
         )
     }
 
@@ -25,6 +25,10 @@ struct ModifiedObjects {
     let inserted: Set<ZMManagedObject>
     let deleted: Set<ZMManagedObject>
 
+    /// The keys changed by the saves of other contexts, for merged objects whose changes can't be read
+    /// from the objects themselves.
+    let mergedChangedKeys: [NSManagedObjectID: Set<String>]
+
     var updatedAndRefreshed: Set<ZMManagedObject> {
         return updated.union(refreshed)
     }
@@ -48,12 +52,14 @@ struct ModifiedObjects {
         updated: Set<ZMManagedObject> = [],
         refreshed: Set<ZMManagedObject> = [],
         inserted: Set<ZMManagedObject> = [],
-        deleted: Set<ZMManagedObject> = []
+        deleted: Set<ZMManagedObject> = [],
+        mergedChangedKeys: [NSManagedObjectID: Set<String>] = [:]
     ) {
         self.updated = updated
         self.refreshed = refreshed
         self.inserted = inserted
         self.deleted = deleted
+        self.mergedChangedKeys = mergedChangedKeys
     }
 
     private static func extractObjects(for key: String, from userInfo: [String: Any]) -> Set<ZMManagedObject> {
@@ -18,11 +18,37 @@
 
 import Foundation
 
+/// Collects changes while the notification dispatcher is in economical mode, without taking snapshots.
+///
+/// Touched objects are only recorded by their IDs, grouped per entity, together with a bitmask of
+/// their changed keys, so the memory used stays bounded by the number of distinct objects touched.
+/// The keys are resolved into observable changes when the changes are consumed. The changes of merged
+/// objects are taken from the keys saved by the other context, since refreshed objects don't have any
+/// changed values. Objects whose changes aren't known, e.g. inserted or deleted objects, are reported
+/// as potentially having any change.
+
 class PotentialChangeDetector: ChangeDetector {
 
     // MARK: - Private properties
 
-    private var modifiedObjects = ModifiedObjects()
+    private unowned let context: NSManagedObjectContext
+    private let dependencyKeyStore: DependencyKeyStore
+
+    /// Touched objects by entity name.
+    private var dirtyObjects: [ClassIdentifier: [NSManagedObjectID: DirtyKeys]] = [:]
+
+    /// Touched objects which can't be looked up by their ID later on, because they were inserted,
+    /// deleted or only have a temporary ID.
+    private var retainedObjects: [ZMManagedObject: DirtyKeys] = [:]
+
+    private var keyTables: [ClassIdentifier: KeyTable] = [:]
+
+    // MARK: - Life cycle
+
+    init(classIdentifiers: [ClassIdentifier], managedObjectContext: NSManagedObjectContext) {
+        context = managedObjectContext
+        dependencyKeyStore = DependencyKeyStore(classIdentifiers: classIdentifiers)
+    }
 
     // MARK: - Methods
 
@@ -31,31 +57,174 @@ class PotentialChangeDetector: ChangeDetector {
             reset()
         }
 
-        return modifiedObjects.allObjects.compactMap {
-            ObjectChangeInfo.changeInfo(for: $0, changes: Changes(mayHaveUnknownChanges: true))
+        var changes = ObjectAndChanges()
+
+        let objectIDs = Set(dirtyObjects.values.flatMap(\.keys))
+        for object in context.existingObjects(with: objectIDs) {
+            guard let keys = dirtyObjects[object.classIdentifier]?[object.objectID] else { continue }
+            merge(observableChanges(for: object, keys: keys), into: &changes)
+        }
+
+        for (object, keys) in retainedObjects {
+            merge(observableChanges(for: object, keys: keys), into: &changes)
+        }
+
+        return changes.compactMap {
+            ObjectChangeInfo.changeInfo(for: $0, changes: $1)
         }
     }
 
     func reset() {
-        modifiedObjects = ModifiedObjects()
+        dirtyObjects = [:]
+        retainedObjects = [:]
+        keyTables = [:]
     }
 
     func add(changes: Changes, for object: ZMManagedObject) {
-        detectChanges(for: ModifiedObjects(updated: [object]))
+        guard
+            !changes.mayHaveUnknownChanges,
+            changes.originalChanges.isEmpty,
+            !changes.changedKeys.isEmpty,
+            let mask = keyTables[object.classIdentifier, default: KeyTable()].mask(for: changes.changedKeys)
+        else {
+            record(.unknown, for: object)
+            return
+        }
+
+        record(DirtyKeys(observableKeys: mask), for: object)
     }
 
     func detectChanges(for objects: ModifiedObjects) {
-        modifiedObjects = modifiedObjects.merged(with: objects)
+        for object in objects.updatedAndRefreshed {
+            record(changedKeys(of: object, mergedKeys: objects.mergedChangedKeys[object.objectID]), for: object)
+        }
+
+        for object in objects.inserted.union(objects.deleted) {
+            record(.unknown, for: object, retainingObject: true)
+        }
+    }
+
+    // MARK: - Private methods
+
+    private func changedKeys(of object: ZMManagedObject, mergedKeys: Set<String>?) -> DirtyKeys {
+        var keys = mergedKeys ?? []
+
+        // The changed values of a fault are always empty, and so are those of objects refreshed by a merge.
+        if !object.isFault {
+            keys.formUnion(object.changedValues().keys)
+            keys.formUnion(object.changedValuesForCurrentEvent().keys)
+        }
+
+        guard
+            !keys.isEmpty,
+            let mask = keyTables[object.classIdentifier, default: KeyTable()].mask(for: keys)
+        else {
+            return .unknown
+        }
+
+        return DirtyKeys(changedKeys: mask)
+    }
+
+    private func record(_ keys: DirtyKeys, for object: ZMManagedObject, retainingObject: Bool = false) {
+        let objectID = object.objectID
+
+        if retainingObject || objectID.isTemporaryID || retainedObjects[object] != nil {
+            var keys = keys
+            if let dirtyKeys = dirtyObjects[object.classIdentifier]?.removeValue(forKey: objectID) {
+                keys.formUnion(dirtyKeys)
+            }
+            retainedObjects[object, default: DirtyKeys()].formUnion(keys)
+        } else {
+            dirtyObjects[object.classIdentifier, default: [:]][objectID, default: DirtyKeys()].formUnion(keys)
+        }
+    }
+
+    private func observableChanges(for object: ZMManagedObject, keys: DirtyKeys) -> ObjectAndChanges {
+        guard !keys.hasUnknownChanges, let keyTable = keyTables[object.classIdentifier] else {
+            return [object: Changes(mayHaveUnknownChanges: true)]
+        }
+
+        var changes = dependencyKeyStore.observableChanges(causedBy: keyTable.keys(in: keys.changedKeys), in: object)
+
+        let observableKeys = keyTable.keys(in: keys.observableKeys)
+        if !observableKeys.isEmpty {
+            changes[object] = changes[object]?.merged(with: Changes(changedKeys: observableKeys)) ?? Changes(changedKeys: observableKeys)
+        }
+
+        return changes
+    }
+
+    private func merge(_ changes: ObjectAndChanges, into result: inout ObjectAndChanges) {
+        for (object, objectChanges) in changes {
+            result[object] = result[object]?.merged(with: objectChanges) ?? objectChanges
+        }
     }
 
 }
 
-// MARK: - Helper extensions
+// MARK: - Helper types
+
+fileprivate extension PotentialChangeDetector {
+
+    struct DirtyKeys {
+
+        static let unknown = DirtyKeys(hasUnknownChanges: true)
+
+        /// The changed keys of the managed object, as bits of the entity's key table.
+        var changedKeys: UInt64 = 0
+
+        /// Observable keys which were reported as changed, as bits of the entity's key table.
+        var observableKeys: UInt64 = 0
+
+        var hasUnknownChanges = false
 
-private extension Dictionary where Value: SetAlgebra {
+        mutating func formUnion(_ other: DirtyKeys) {
+            changedKeys |= other.changedKeys
+            observableKeys |= other.observableKeys
+            hasUnknownChanges = hasUnknownChanges || other.hasUnknownChanges
+        }
+
+    }
+
+    /// Assigns a bit to each key of an entity the first time the key changes.
+    struct KeyTable {
+
+        private var bits: [String: Int] = [:]
+        private var keys: [String] = []
+
+        /// Returns the mask of the given keys, or `nil` if the table has run out of bits.
+        mutating func mask<S: Sequence>(for keys: S) -> UInt64? where S.Element == String {
+            var mask: UInt64 = 0
+
+            for key in keys {
+                if let bit = bits[key] {
+                    mask |= 1 << UInt64(bit)
+                    continue
+                }
+
+                guard self.keys.count < UInt64.bitWidth else { return nil }
+
+                let bit = self.keys.count
+                bits[key] = bit
+                self.keys.append(key)
+                mask |= 1 << UInt64(bit)
+            }
+
+            return mask
+        }
+
+        func keys(in mask: UInt64) -> Set<String> {
+            var result = Set<String>()
+            var remaining = mask
+
+            while remaining != 0 {
+                result.insert(keys[remaining.trailingZeroBitCount])
+                remaining &= remaining - 1
+            }
+
+            return result
+        }
 
-    subscript(key: Key, default defaultValue: Value) -> Value {
-        return self[key] ?? defaultValue
     }
 
 }
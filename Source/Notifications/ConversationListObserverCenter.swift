@@ -113,6 +113,8 @@ public class ConversationListObserverCenter: NSObject, ZMConversationObserver, C
             $0.conversationsChanges(inserted: insertedConversations, deleted: deletedConversations)
             $0.recalculateListAndNotify()
         }
+
+        managedObjectContext.conversationListWarmStartStore?.setNeedsWrite()
     }
 
     private func labelDidChange(_ changes: LabelChangeInfo) {
@@ -290,8 +292,10 @@ class ConversationListSnapshot: NSObject {
             return
         }
 
+        let start = Instrumentation.timestamp()
         var listChange: ConversationListChangeInfo?
         defer {
+            Instrumentation.record(.conversationListRecalculation, since: start)
             notifyObservers(conversationChanges: conversationChanges, listChanges: listChange)
             conversationChanges = []
             needsToRecalculate = false
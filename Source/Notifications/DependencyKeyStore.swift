@@ -214,3 +214,30 @@ class DependencyKeyStore {
         }
     }
 }
+
+extension DependencyKeyStore {
+
+    /// Returns the objects and their observable keys which changed as a result of changes to the given keys of an object.
+    ///
+    /// E.g if `user.fullName` and `conversation.name` both depend on `user.firstName`, then a change to `user.firstName`
+    /// means `user.fullName` and `conversation.name` must be considered changed too.
+    func observableChanges(causedBy changedKeys: Set<String>, in object: ZMManagedObject) -> ObjectAndChanges {
+        var result = ObjectAndChanges()
+
+        let affectedKeysOfObject = changedKeys.reduce(into: Set<String>()) {
+            $0.formUnion(observableKeysAffectedByValue(object.classIdentifier, key: $1))
+        }
+
+        if !affectedKeysOfObject.isEmpty {
+            result[object] = Changes(changedKeys: affectedKeysOfObject)
+        }
+
+        if let sideEffectSource = object as? SideEffectSource {
+            let affectedKeysOfOtherObjects = sideEffectSource.affectedObjectsAndKeys(keyStore: self, knownKeys: changedKeys)
+            result = result.merged(with: affectedKeysOfOtherObjects)
+        }
+
+        return result
+    }
+
+}
@@ -24,6 +24,7 @@ extension Notification.Name {
     static let MessageChange = Notification.Name("ZMMessageChangedNotification")
     static let UserChange = Notification.Name("ZMUserChangedNotification")
     static let SearchUserChange = Notification.Name("ZMSearchUserChangedNotification")
+    static let SearchUserBatchChange = Notification.Name("ZMSearchUserBatchChangedNotification")
     static let ConnectionChange = Notification.Name("ZMConnectionChangeNotification")
     static let UserClientChange = Notification.Name("ZMUserClientChangeNotification")
     static let NewUnreadMessage = Notification.Name("ZMNewUnreadMessageNotification")
@@ -49,6 +49,10 @@ import CoreData
         didSet {
             guard operationMode != oldValue else { return }
 
+            savedKeysLock.lock()
+            isCollectingSavedKeys = operationMode == .economical
+            savedKeysLock.unlock()
+
             if operationMode == .economical {
                 conversationListObserverCenter.stopObserving()
             }
@@ -62,6 +66,21 @@ import CoreData
         }
     }
 
+    /// The conversations whose merged changes are detected and notified first, e.g. the open conversation.
+
+    public var prioritizedConversations = Set<NSManagedObjectID>()
+
+    /// How long detecting changes and posting notifications may run before the remaining work is
+    /// deferred to the next turn of the run loop.
+
+    public var mergeTimeBudget: TimeInterval = 0.008
+
+    /// Whether changes are waiting to be detected or notified.
+
+    public var hasPendingMergedChanges: Bool {
+        return !pendingMergedObjects.isEmpty || !pendingChangeInfos.isEmpty
+    }
+
     // MARK: - Private properties
 
     private unowned var managedObjectContext: NSManagedObjectContext
@@ -93,6 +112,33 @@ import CoreData
 
     private var unreadMessages = UnreadMessages()
 
+    /// Merged objects whose changes haven't been detected yet, in the order they will be processed.
+    private var pendingMergedObjects = ArraySlice<ZMManagedObject>()
+
+    /// The keys saved by other contexts for the pending merged objects.
+    private var pendingMergedKeys: [NSManagedObjectID: Set<String>] = [:]
+
+    /// The keys changed by the saves of other contexts of the store, collected on the queues of the saving
+    /// contexts until the changes are merged, only in economical mode. Guarded by `savedKeysLock`.
+    private var savedKeys: [NSManagedObjectID: Set<String>] = [:]
+    private var savedKeysOrder = ArraySlice<NSManagedObjectID>()
+    private var savedKeysOrderCounts: [NSManagedObjectID: Int] = [:]
+    private var isCollectingSavedKeys = false
+    private let savedKeysLock = NSLock()
+
+    /// The saved keys of the oldest objects are dropped past this number of objects, the changes of those
+    /// objects are then unknown.
+    private static let maximumSavedKeys = 10_000
+    private weak var persistentStoreCoordinator: NSPersistentStoreCoordinator?
+
+    /// Detected changes which haven't been notified yet, in the order they will be posted.
+    private var pendingChangeInfos = ArraySlice<ObjectChangeInfo>()
+
+    private var isSliceScheduled = false
+
+    /// The number of objects or changes processed between checks of the time budget.
+    private static let sliceSize = 50
+
     // MARK: - Life cycle
 
     public init(managedObjectContext: NSManagedObjectContext) {
@@ -102,34 +148,38 @@ import CoreData
         )
 
         self.managedObjectContext = managedObjectContext
+        self.persistentStoreCoordinator = managedObjectContext.persistentStoreCoordinator
+
+        let classIdentifiers = [
+            ZMConversation.classIdentifier,
+            ZMUser.classIdentifier,
+            ZMConnection.classIdentifier,
+            UserClient.classIdentifier,
+            ZMMessage.classIdentifier,
+            ZMClientMessage.classIdentifier,
+            ZMAssetClientMessage.classIdentifier,
+            ZMSystemMessage.classIdentifier,
+            Reaction.classIdentifier,
+            ZMGenericMessageData.classIdentifier,
+            Team.classIdentifier,
+            Member.classIdentifier,
+            Label.classIdentifier,
+            ParticipantRole.classIdentifier
+        ]
 
         changeDetectorBuilder = { operationMode in
             switch operationMode {
             case .normal:
-                let classIdentifiers = [
-                    ZMConversation.classIdentifier,
-                    ZMUser.classIdentifier,
-                    ZMConnection.classIdentifier,
-                    UserClient.classIdentifier,
-                    ZMMessage.classIdentifier,
-                    ZMClientMessage.classIdentifier,
-                    ZMAssetClientMessage.classIdentifier,
-                    ZMSystemMessage.classIdentifier,
-                    Reaction.classIdentifier,
-                    ZMGenericMessageData.classIdentifier,
-                    Team.classIdentifier,
-                    Member.classIdentifier,
-                    Label.classIdentifier,
-                    ParticipantRole.classIdentifier
-                ]
-
                 return ExplicitChangeDetector(
                     classIdentifiers: classIdentifiers,
                     managedObjectContext: managedObjectContext
                 )
 
             case .economical:
-                return PotentialChangeDetector()
+                return PotentialChangeDetector(
+                    classIdentifiers: classIdentifiers,
+                    managedObjectContext: managedObjectContext
+                )
             }
         }
 
@@ -152,6 +202,13 @@ import CoreData
             object: managedObjectContext
         )
 
+        NotificationCenter.default.addObserver(
+            self,
+            selector: #selector(NotificationDispatcher.otherContextWillSave),
+            name: .NSManagedObjectContextWillSave,
+            object: nil
+        )
+
         let token = NotificationInContext.addObserver(
             name: .NonCoreDataChangeInManagedObject,
             context: managedObjectContext.notificationContext,
@@ -162,7 +219,11 @@ import CoreData
     }
 
     public func tearDown() {
+        pendingMergedObjects = []
+        pendingMergedKeys = [:]
+        pendingChangeInfos = []
         NotificationCenter.default.removeObserver(self)
+        consumeSavedKeys()
         notificationCenterTokens.forEach(NotificationCenter.default.removeObserver)
         notificationCenterTokens = []
         conversationListObserverCenter.tearDown()
@@ -199,6 +260,104 @@ import CoreData
         fireAllNotificationsIfAllowed()
     }
 
+    /// Collects the keys changed by a save of another context of the store. The changed values are gone
+    /// once the save is done and merged objects are refreshed, so they're read before the save, on the
+    /// queue of the saving context.
+
+    func otherContextWillSave(_ note: Notification) {
+        guard
+            let savingContext = note.object as? NSManagedObjectContext,
+            savingContext !== managedObjectContext,
+            let coordinator = persistentStoreCoordinator,
+            savingContext.persistentStoreCoordinator === coordinator
+        else {
+            return
+        }
+
+        savedKeysLock.lock()
+        let isCollecting = isCollectingSavedKeys
+        savedKeysLock.unlock()
+
+        guard isCollecting else { return }
+
+        var keys: [NSManagedObjectID: Set<String>] = [:]
+
+        for object in savingContext.updatedObjects where !object.objectID.isTemporaryID {
+            let changedKeys = object.changedValues().keys
+            guard !changedKeys.isEmpty else { continue }
+            keys[object.objectID] = Set(changedKeys)
+        }
+
+        guard !keys.isEmpty else { return }
+
+        savedKeysLock.lock()
+        defer { savedKeysLock.unlock() }
+
+        for (objectID, changedKeys) in keys {
+            if let existing = savedKeys.updateValue(changedKeys, forKey: objectID) {
+                savedKeys[objectID] = existing.union(changedKeys)
+            } else {
+                savedKeysOrder.append(objectID)
+                savedKeysOrderCounts[objectID, default: 0] += 1
+            }
+        }
+
+        evictSavedKeysIfNeeded()
+    }
+
+    /// Drops the saved keys of the objects saved first. Objects consumed and saved again appear in the order
+    /// once per save, only their last appearance drops them. Must be called with `savedKeysLock` held.
+    private func evictSavedKeysIfNeeded() {
+        while savedKeys.count > NotificationDispatcher.maximumSavedKeys, let objectID = savedKeysOrder.popFirst() {
+            let count = (savedKeysOrderCounts[objectID] ?? 1) - 1
+            savedKeysOrderCounts[objectID] = count > 0 ? count : nil
+
+            if count == 0 {
+                savedKeys.removeValue(forKey: objectID)
+            }
+        }
+
+        // Consumed objects are left in the order, it's compacted once it's twice the limit
+        if savedKeysOrder.count > 2 * NotificationDispatcher.maximumSavedKeys {
+            savedKeysOrder = ArraySlice(savedKeysOrder.filter { savedKeys[$0] != nil })
+            savedKeysOrderCounts = savedKeysOrder.reduce(into: [:]) { $0[$1, default: 0] += 1 }
+        }
+    }
+
+    /// Removes and returns the saved keys of the given objects, or all saved keys if `objectIDs` is nil.
+    @discardableResult
+    private func consumeSavedKeys(of objectIDs: Set<NSManagedObjectID>? = nil) -> [NSManagedObjectID: Set<String>] {
+        savedKeysLock.lock()
+        defer { savedKeysLock.unlock() }
+
+        guard let objectIDs = objectIDs else {
+            defer {
+                savedKeys = [:]
+                savedKeysOrder = []
+                savedKeysOrderCounts = [:]
+            }
+            return savedKeys
+        }
+
+        var result: [NSManagedObjectID: Set<String>] = [:]
+        for objectID in objectIDs {
+            result[objectID] = savedKeys.removeValue(forKey: objectID)
+        }
+        return result
+    }
+
+    /// Returns the saved keys of the given objects, keeping them until the changes are merged.
+    private func savedKeys(of objectIDs: Set<NSManagedObjectID>) -> [NSManagedObjectID: Set<String>] {
+        savedKeysLock.lock()
+        defer { savedKeysLock.unlock() }
+
+        var result: [NSManagedObjectID: Set<String>] = [:]
+        for objectID in objectIDs {
+            result[objectID] = savedKeys[objectID]
+        }
+        return result
+    }
+
     /// This will be called if a change to an object does not cause a change in Core Data,
     /// e.g. downloading the asset and adding it to the cache.
 
@@ -233,17 +392,91 @@ import CoreData
     }
 
     /// Call this AFTER merging the changes from syncMOC into uiMOC.
+    ///
+    /// The changed objects are fetched with one request per entity. Their changes are detected and notified
+    /// in slices limited by `mergeTimeBudget`, objects of prioritized conversations and conversations first.
+    /// If the budget runs out, the remaining work is done in the next turns of the run loop. The keys changed
+    /// by the save are collected before the other context saves, so the changes stay precise in economical mode.
 
     public func didMergeChanges(_ changedObjectIDs: Set<NSManagedObjectID>) {
+        let mergedKeys = consumeSavedKeys(of: changedObjectIDs)
+
         guard isEnabled else { return }
 
-        let changedObjects = changedObjectIDs.compactMap {
-            try? managedObjectContext.existingObject(with: $0) as? ZMManagedObject
+        pendingMergedKeys.merge(mergedKeys) { $0.union($1) }
+
+        let start = Instrumentation.timestamp()
+        let changedObjects = managedObjectContext.existingObjects(with: changedObjectIDs)
+
+        Instrumentation.increment(.objectsMerged, by: changedObjects.count)
+        Instrumentation.record(.mergeChanges, since: start)
+
+        let alreadyPending = Set(pendingMergedObjects)
+        let newObjects = changedObjects.filter { !alreadyPending.contains($0) }
+        pendingMergedObjects = ArraySlice(prioritized(Array(pendingMergedObjects) + newObjects, by: { $0 }))
+
+        processSlice()
+    }
+
+    /// Detects the changes of pending merged objects and posts pending notifications until the time budget
+    /// runs out, each is processed at least once so the work always progresses.
+    private func processSlice() {
+        isSliceScheduled = false
+        guard isEnabled else { return }
+
+        let deadline = CFAbsoluteTimeGetCurrent() + mergeTimeBudget
+
+        while !pendingMergedObjects.isEmpty {
+            let slice = pendingMergedObjects.prefix(NotificationDispatcher.sliceSize)
+            pendingMergedObjects = pendingMergedObjects.dropFirst(slice.count)
+            let updated = slice.filter { !$0.isDeleted && $0.managedObjectContext != nil }
+            var mergedKeys: [NSManagedObjectID: Set<String>] = [:]
+            slice.forEach { mergedKeys[$0.objectID] = pendingMergedKeys.removeValue(forKey: $0.objectID) }
+
+            Instrumentation.measure(.changeDetection) {
+                changeDetector.detectChanges(for: ModifiedObjects(updated: Set(updated), mergedChangedKeys: mergedKeys))
+            }
+
+            guard CFAbsoluteTimeGetCurrent() < deadline else { break }
         }
 
-        changeDetector.detectChanges(for: ModifiedObjects(updated: Set(changedObjects)))
+        if shouldFireNotifications {
+            fireAllNotifications(deadline: deadline, areMergedChanges: true)
+        } else {
+            scheduleSliceIfNeeded()
+        }
+    }
 
-        fireAllNotificationsIfAllowed()
+    private func scheduleSliceIfNeeded() {
+        guard hasPendingMergedChanges, !isSliceScheduled else { return }
+
+        isSliceScheduled = true
+        managedObjectContext.performGroupedBlock { [weak self] in
+            self?.processSlice()
+        }
+    }
+
+    /// Orders the elements belonging to prioritized conversations first, followed by conversations,
+    /// keeping the order of the elements otherwise.
+    private func prioritized<T>(_ elements: [T], by object: (T) -> AnyObject?) -> [T] {
+        var prioritized: [T] = []
+        var conversations: [T] = []
+        var others: [T] = []
+
+        for element in elements {
+            switch object(element) {
+            case let conversation as ZMConversation where prioritizedConversations.contains(conversation.objectID):
+                prioritized.append(element)
+            case let message as ZMMessage where message.conversation.map({ prioritizedConversations.contains($0.objectID) }) == true:
+                prioritized.append(element)
+            case is ZMConversation:
+                conversations.append(element)
+            default:
+                others.append(element)
+            }
+        }
+
+        return prioritized + conversations + others
     }
 
     /// This can safely be called from any thread as it will switch to uiContext internally.
@@ -262,6 +495,9 @@ import CoreData
     }
 
     private func stopObserving() {
+        pendingMergedObjects = []
+        pendingMergedKeys = [:]
+        pendingChangeInfos = []
         changeDetector.reset()
         unreadMessages = UnreadMessages()
         allChangeInfoConsumers.forEach { $0.stopObserving() }
@@ -272,10 +508,19 @@ import CoreData
     }
 
     private func process(note: Notification) {
-        guard let objects = ModifiedObjects(notification: note) else { return }
+        guard var objects = ModifiedObjects(notification: note) else { return }
+
+        if !objects.refreshed.isEmpty {
+            // Objects refreshed by merging the save of another context
+            let mergedKeys = savedKeys(of: Set(objects.refreshed.map(\.objectID)))
+            objects = objects.merged(with: ModifiedObjects(mergedChangedKeys: mergedKeys))
+        }
         forwardChangesToConversationListObserver(modifiedObjects: objects)
         checkForUnreadMessages(insertedObjects: objects.inserted, updatedObjects: objects.updated)
-        changeDetector.detectChanges(for: objects)
+
+        Instrumentation.measure(.changeDetection) {
+            changeDetector.detectChanges(for: objects)
+        }
     }
 
     private func forwardChangesToConversationListObserver(modifiedObjects: ModifiedObjects) {
@@ -320,13 +565,41 @@ import CoreData
         return operationMode != .economical
     }
 
-    private func fireAllNotifications() {
+    /// Posts the detected changes, once the deadline has passed the remaining changes are posted in the
+    /// next turns of the run loop.
+    ///
+    /// Changes made in the context are posted ahead of the merged changes still waiting to be posted, so
+    /// the UI reacts to its own changes without waiting for a merged backlog. Merged changes are queued
+    /// behind them, with the changes of prioritized conversations first.
+    private func fireAllNotifications(deadline: CFAbsoluteTime? = nil, areMergedChanges: Bool = false) {
+        let start = Instrumentation.timestamp()
+        defer { Instrumentation.record(.notification, since: start) }
+
+        let deadline = deadline ?? CFAbsoluteTimeGetCurrent() + mergeTimeBudget
         let detectedChanges = changeDetector.consumeChanges()
-        var changesByClass = [ClassIdentifier: [ObjectChangeInfo]]()
         let unreadMessages = self.unreadMessages
         self.unreadMessages = UnreadMessages()
 
-        detectedChanges.forEach { changeInfo in
+        if areMergedChanges {
+            pendingChangeInfos = ArraySlice(prioritized(Array(pendingChangeInfos) + detectedChanges, by: { $0.object }))
+        } else {
+            pendingChangeInfos = ArraySlice(detectedChanges) + pendingChangeInfos
+        }
+
+        repeat {
+            let slice = pendingChangeInfos.prefix(NotificationDispatcher.sliceSize)
+            pendingChangeInfos = pendingChangeInfos.dropFirst(slice.count)
+            postNotifications(for: slice)
+        } while !pendingChangeInfos.isEmpty && CFAbsoluteTimeGetCurrent() < deadline
+
+        fireNewUnreadMessagesNotifications(unreadMessages: unreadMessages)
+        scheduleSliceIfNeeded()
+    }
+
+    private func postNotifications<S: Sequence>(for changeInfos: S) where S.Element == ObjectChangeInfo {
+        var changesByClass = [ClassIdentifier: [ObjectChangeInfo]]()
+
+        changeInfos.forEach { changeInfo in
             guard let objectInSnapshot = changeInfo.object as? ObjectInSnapshot else { return }
 
             postNotification(
@@ -337,6 +610,10 @@ import CoreData
 
             guard let managedObject = changeInfo.object as? ZMManagedObject else { return }
 
+            if Instrumentation.isEnabled {
+                Instrumentation.increment(.changeInfosProduced, entity: managedObject.entity.name)
+            }
+
             let classIdentifier = managedObject.classIdentifier
             var previousChanges = changesByClass[classIdentifier] ?? []
             previousChanges.append(changeInfo)
@@ -344,7 +621,6 @@ import CoreData
         }
 
         forwardNotificationToObserverCenters(changeInfos: changesByClass)
-        fireNewUnreadMessagesNotifications(unreadMessages: unreadMessages)
     }
 
     private func fireNewUnreadMessagesNotifications(unreadMessages: UnreadMessages) {
@@ -364,6 +640,8 @@ import CoreData
         object: AnyObject? = nil,
         changeInfo: ObjectChangeInfo
     ) {
+        Instrumentation.increment(.notificationsPosted)
+
         NotificationInContext(
             name: name,
             context: managedObjectContext.notificationContext,
@@ -376,6 +654,37 @@ import CoreData
 
 // MARK: - Helper extensions
 
+extension NSManagedObjectContext {
+
+    /// Returns the objects with the given IDs which exist in the context, objects which aren't
+    /// registered or are faults are fetched with one request per entity.
+
+    func existingObjects(with objectIDs: Set<NSManagedObjectID>) -> [ZMManagedObject] {
+        var objects: [ZMManagedObject] = []
+        var objectIDsToFetch: [NSEntityDescription: [NSManagedObjectID]] = [:]
+
+        for objectID in objectIDs {
+            if let object = registeredObject(for: objectID), !object.isFault {
+                (object as? ZMManagedObject).map { objects.append($0) }
+            } else if !objectID.isTemporaryID {
+                objectIDsToFetch[objectID.entity, default: []].append(objectID)
+            }
+        }
+
+        for (entity, objectIDs) in objectIDsToFetch {
+            let request = NSFetchRequest<NSManagedObject>()
+            request.entity = entity
+            request.predicate = NSPredicate(format: "SELF IN %@", objectIDs)
+            request.includesSubentities = false
+            request.returnsObjectsAsFaults = false
+            objects.append(contentsOf: fetchOrAssert(request: request).compactMap { $0 as? ZMManagedObject })
+        }
+
+        return objects
+    }
+
+}
+
 private extension LazySequenceProtocol {
 
     func collect() -> [Element] {
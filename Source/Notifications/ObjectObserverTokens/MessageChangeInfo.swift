@@ -90,7 +90,9 @@ extension ZMSystemMessage {
     public class override var observableKeys: Set<String> {
         let keys = super.observableKeys
         let additionalKeys = [#keyPath(ZMSystemMessage.childMessages),
-                              #keyPath(ZMSystemMessage.systemMessageType)]
+                              #keyPath(ZMSystemMessage.systemMessageType),
+                              ZMMessageUsersKey,
+                              ZMMessageClientsKey]
         return keys.union(additionalKeys)
     }
 
@@ -116,6 +118,7 @@ extension ZMSystemMessage {
                 "reactionsChanged: \(reactionsChanged)",
                 "confirmationsChanged: \(confirmationsChanged)",
                 "childMessagesChanged: \(childMessagesChanged)",
+                "systemMessageUsersChanged: \(systemMessageUsersChanged)",
                 "quoteChanged: \(quoteChanged)",
                 "imageChanged: \(imageChanged)",
                 "fileAvailabilityChanged: \(fileAvailabilityChanged)",
@@ -151,6 +154,11 @@ extension ZMSystemMessage {
         return changedKeysContain(keys: #keyPath(ZMSystemMessage.childMessages))
     }
 
+    /// Whether users or clients were added to a system message, e.g. when it's compacted with a later event
+    public var systemMessageUsersChanged: Bool {
+        return changedKeysContain(keys: ZMMessageUsersKey, ZMMessageClientsKey)
+    }
+
     public var quoteChanged: Bool {
         return changedKeysContain(keys: #keyPath(ZMClientMessage.quote))
     }
@@ -173,6 +173,10 @@ extension ZMUser: ObjectInSnapshot {
     func userDidChange(_ changeInfo: UserChangeInfo)
 }
 
+public protocol ZMSearchUserBatchObserver: AnyObject {
+    func searchUsersDidChange(_ changeInfos: [UserChangeInfo])
+}
+
 extension UserChangeInfo {
 
     // MARK: Registering UserType
@@ -202,8 +206,11 @@ extension UserChangeInfo {
     /// Adds an observer for the searchUser if one specified or to all ZMSearchUser is none is specified. You must
     /// hold on to the token and use it to unregister.
     ///
+    /// While batch observers are registered the changes are only posted as batches, so the observer also picks
+    /// the changes of its user from the batches.
+    ///
     private static func add(searchUserObserver observer: ZMUserObserver, for user: ZMSearchUser?, in managedObjectContext: NSManagedObjectContext) -> NSObjectProtocol {
-        return ManagedObjectObserverToken(name: .SearchUserChange, managedObjectContext: managedObjectContext, object: user) { [weak observer] (note) in
+        let changeToken = ManagedObjectObserverToken(name: .SearchUserChange, managedObjectContext: managedObjectContext, object: user) { [weak observer] (note) in
             guard
                 let `observer` = observer,
                 let changeInfo = note.changeInfo as? UserChangeInfo
@@ -213,6 +220,40 @@ extension UserChangeInfo {
 
             observer.userDidChange(changeInfo)
         }
+
+        let batchToken = ManagedObjectObserverToken(name: .SearchUserBatchChange, managedObjectContext: managedObjectContext) { [weak observer] (note) in
+            guard
+                let `observer` = observer,
+                let changeInfos = note.userInfo[SearchUserObserverCenter.changeInfosKey] as? [UserChangeInfo]
+            else {
+                return
+            }
+
+            for changeInfo in changeInfos where user == nil || changeInfo.object === user {
+                observer.userDidChange(changeInfo)
+            }
+        }
+
+        return SearchUserObserverToken(tokens: [changeToken, batchToken])
+    }
+
+    /// Adds an observer which is notified once for each batch of changed ZMSearchUsers in the given context,
+    /// e.g. when the images of a page of search results were updated. While a batch observer is registered, the
+    /// changes are no longer posted per search user. You must hold on to the token and use it to unregister.
+    ///
+    public static func add(searchUserBatchObserver observer: ZMSearchUserBatchObserver, in managedObjectContext: NSManagedObjectContext) -> NSObjectProtocol {
+        let token = ManagedObjectObserverToken(name: .SearchUserBatchChange, managedObjectContext: managedObjectContext) { [weak observer] (note) in
+            guard
+                let `observer` = observer,
+                let changeInfos = note.userInfo[SearchUserObserverCenter.changeInfosKey] as? [UserChangeInfo]
+            else {
+                return
+            }
+
+            observer.searchUsersDidChange(changeInfos)
+        }
+
+        return SearchUserObserverToken(tokens: [token], batchObserverCenter: managedObjectContext.searchUserObserverCenter)
     }
 
     // MARK: Registering UserObservers
@@ -37,74 +37,143 @@ extension NSManagedObjectContext {
     }
 }
 
-public class SearchUserSnapshot {
+/// Cheap values identifying the observable state of a search user.
+///
+/// Images are identified by their cache key and whether the image cache contains them, so
+/// comparing stamps never loads image data.
+public struct SearchUserVersionStamp: Equatable {
+
+    public struct Image: Equatable {
+        /// The image cache key of the user's asset, if the search user has a user.
+        public let cacheKey: String?
+        /// Whether the image cache contains the user's asset.
+        public let isCached: Bool
+        /// The number of times image data was set on the search user itself.
+        public let localVersion: Int
+    }
+
+    public let name: String?
+    public let previewImage: Image
+    public let completeImage: Image
+    public let isConnected: Bool
+    public let user: NSManagedObjectID?
+    public let isPendingApprovalByOtherUser: Bool
+
+    init(searchUser: ZMSearchUser) {
+        name = searchUser.name
+        previewImage = Image(searchUser: searchUser, size: .preview)
+        completeImage = Image(searchUser: searchUser, size: .complete)
+        isConnected = searchUser.isConnected
+        user = searchUser.user?.objectID
+        isPendingApprovalByOtherUser = searchUser.isPendingApprovalByOtherUser
+    }
+
+    /// Returns the keys of the values that differ from the other stamp, the keys are those of
+    /// `ZMSearchUser` so they can be used in a `UserChangeInfo`.
+    func changedKeys(comparedTo other: SearchUserVersionStamp) -> Set<String> {
+        var changedKeys = Set<String>()
+
+        if name != other.name {
+            changedKeys.insert(#keyPath(ZMSearchUser.name))
+        }
+        if previewImage != other.previewImage {
+            changedKeys.insert(#keyPath(ZMSearchUser.previewImageData))
+        }
+        if completeImage != other.completeImage {
+            changedKeys.insert(#keyPath(ZMSearchUser.completeImageData))
+        }
+        if isConnected != other.isConnected {
+            changedKeys.insert(#keyPath(ZMSearchUser.isConnected))
+        }
+        if user != other.user {
+            changedKeys.insert(#keyPath(ZMSearchUser.user))
+        }
+        if isPendingApprovalByOtherUser != other.isPendingApprovalByOtherUser {
+            changedKeys.insert(#keyPath(ZMSearchUser.isPendingApprovalByOtherUser))
+        }
+
+        return changedKeys
+    }
+
+}
+
+extension SearchUserVersionStamp.Image {
+
+    init(searchUser: ZMSearchUser, size: ProfileImageSize) {
+        let user = searchUser.user
+
+        cacheKey = user?.imageCacheKey(for: size)
+        isCached = user.flatMap { $0.managedObjectContext?.zm_userImageCache?.hasUserImage($0, size: size) } ?? false
 
-    /// Keys that we want to be notified for
-    static let observableKeys: [String] = [#keyPath(ZMSearchUser.name),
-                                            #keyPath(ZMSearchUser.completeImageData),
-                                            #keyPath(ZMSearchUser.previewImageData),
-                                            #keyPath(ZMSearchUser.isConnected),
-                                            #keyPath(ZMSearchUser.user),
-                                            #keyPath(ZMSearchUser.isPendingApprovalByOtherUser)]
+        switch size {
+        case .preview:
+            localVersion = searchUser.previewImageDataVersion
+        case .complete:
+            localVersion = searchUser.completeImageDataVersion
+        }
+    }
+
+}
+
+public class SearchUserSnapshot {
 
     weak var searchUser: ZMSearchUser?
-    public private (set) var snapshotValues: [String: NSObject?]
+    public private (set) var stamp: SearchUserVersionStamp
 
     /// The managed object context used for notifications
     weak var managedObjectContext: NSManagedObjectContext?
 
     public init(searchUser: ZMSearchUser, managedObjectContext: NSManagedObjectContext) {
         self.searchUser = searchUser
-        self.snapshotValues = SearchUserSnapshot.createSnapshots(searchUser: searchUser)
+        self.stamp = SearchUserVersionStamp(searchUser: searchUser)
         self.managedObjectContext = managedObjectContext
     }
 
-    /// Creates a snapshot values for the observableKeys keys and stores them
-    static func createSnapshots(searchUser: ZMSearchUser) -> [String: NSObject?] {
-        return observableKeys.mapToDictionaryWithOptionalValue { searchUser.value(forKey: $0) as? NSObject }
+    /// Updates the stamp and returns a change info if anything changed
+    func update() -> UserChangeInfo? {
+        guard let searchUser = searchUser else { return nil }
+
+        let newStamp = SearchUserVersionStamp(searchUser: searchUser)
+        let changedKeys = newStamp.changedKeys(comparedTo: stamp)
+        stamp = newStamp
+
+        guard !changedKeys.isEmpty else { return nil }
+
+        let userChange = UserChangeInfo(object: searchUser)
+        userChange.changedKeys = changedKeys
+        return userChange
     }
 
-    /// Updates the snapshot values for the observableKeys keys,
-    /// returns the changes keys if keys changed or nil when nothing changed
+    /// Updates the stamp and posts a notification if anything changed
     func updateAndNotify() {
-        guard let searchUser = searchUser else { return }
-        let newSnapshotValues = SearchUserSnapshot.createSnapshots(searchUser: searchUser)
-
-        var changedKeys = [String]()
-        newSnapshotValues.forEach {
-            guard let oldValue = snapshotValues[$0.key] else {
-                changedKeys.append($0.key)
-                return
-            }
-            if oldValue != $0.value {
-                changedKeys.append($0.key)
-            }
-        }
-        snapshotValues = newSnapshotValues
-        postNotification(changedKeys: changedKeys)
+        guard let changeInfo = update(), let moc = managedObjectContext else { return }
+
+        SearchUserSnapshot.post(changeInfo, in: moc)
     }
 
     /// Post a UserChangeInfo for the specified SearchUser
-    func postNotification(changedKeys: [String]) {
-        guard changedKeys.count > 0,
-            let searchUser = searchUser,
-            let moc = self.managedObjectContext
-            else { return }
-
-        let userChange = UserChangeInfo(object: searchUser)
-        userChange.changedKeys = Set(changedKeys)
+    static func post(_ changeInfo: UserChangeInfo, in managedObjectContext: NSManagedObjectContext) {
         NotificationInContext(name: .SearchUserChange,
-                              context: moc.notificationContext,
-                              object: searchUser,
-                              changeInfo: userChange).post()
+                              context: managedObjectContext.notificationContext,
+                              object: changeInfo.object,
+                              changeInfo: changeInfo).post()
     }
 }
 
 @objcMembers public class SearchUserObserverCenter: NSObject, ChangeInfoConsumer {
 
+    /// Key of the change infos in the user info of a batch notification
+    static let changeInfosKey = "changeInfos"
+
     /// Map of searchUser remoteID to snapshot
     internal var snapshots: [UUID: SearchUserSnapshot] = [:]
 
+    /// Search users updated through `notifyUpdatedSearchUser(_:)` since the last batch was posted
+    private var pendingSearchUsers: Set<UUID> = []
+
+    /// The number of registered batch observers, while there are any the changes are only posted as batches.
+    fileprivate(set) var batchObserverCount = 0
+
     weak var managedObjectContext: NSManagedObjectContext?
 
     init(managedObjectContext: NSManagedObjectContext) {
@@ -143,46 +212,80 @@ public class SearchUserSnapshot {
     /// This needs to be called when tearing down the search directory
     public func reset() {
         snapshots = [:]
+        pendingSearchUsers = []
     }
 
     public func objectsDidChange(changes: [ClassIdentifier: [ObjectChangeInfo]]) {
-        guard let userChanges = changes[ZMUser.entityName()] as? [UserChangeInfo] else { return }
-        userChanges.forEach {usersDidChange(info: $0)}
+        guard !snapshots.isEmpty, let userChanges = changes[ZMUser.entityName()] as? [UserChangeInfo] else { return }
+        post(userChanges.compactMap(usersDidChange))
     }
 
-    /// Matches the userChangeInfo with the searchUser snapshots and updates those if needed
-    func usersDidChange(info: UserChangeInfo) {
-        guard snapshots.count > 0 else { return }
+    /// Matches the userChangeInfo with the searchUser snapshots and updates those if needed,
+    /// returns the change info of the search user if it changed
+    func usersDidChange(info: UserChangeInfo) -> UserChangeInfo? {
+        guard snapshots.count > 0 else { return nil }
 
         guard info.nameChanged || info.imageMediumDataChanged || info.imageSmallProfileDataChanged || info.connectionStateChanged,
             let user = info.user as? ZMUser,
             let remoteID = user.remoteIdentifier,
             let snapshot = snapshots[remoteID]
         else {
-                return
+                return nil
         }
 
         guard let searchUser = snapshot.searchUser else {
             snapshots.removeValue(forKey: remoteID)
-            return
+            return nil
         }
 
         guard searchUser.user != nil else {
             // When inserting a connection with a remote user, the user is first inserted into the sync context, then merged into the UI context
             // Only then the relationship is set between searchUser and user. Therefore we might receive the userChange notification about the updated connectionState BEFORE the relationship is set.
             // We will wait until we get notified via `notifyUpdatedSearchUser:`
-            return
+            return nil
         }
-        snapshot.updateAndNotify()
+        return snapshot.update()
     }
 
-    /// Updates the snapshot of the given searchUser
+    /// Updates the snapshot of the given searchUser.
+    ///
+    /// Updates are coalesced until the current changes have been processed, so e.g. the images of
+    /// a page of search results arriving together are posted as one batch.
     public func notifyUpdatedSearchUser(_ searchUser: ZMSearchUser) {
         guard let remoteID = searchUser.remoteIdentifier,
-              let snapshot = snapshots[remoteID]
+              snapshots[remoteID] != nil,
+              let moc = managedObjectContext
         else { return }
 
-        snapshot.updateAndNotify()
+        let isFlushScheduled = !pendingSearchUsers.isEmpty
+        pendingSearchUsers.insert(remoteID)
+
+        guard !isFlushScheduled else { return }
+
+        moc.performGroupedBlock { [weak self] in
+            self?.flushPendingSearchUsers()
+        }
+    }
+
+    private func flushPendingSearchUsers() {
+        let remoteIDs = pendingSearchUsers
+        pendingSearchUsers = []
+        post(remoteIDs.compactMap { snapshots[$0]?.update() })
+    }
+
+    /// Posts one notification for the whole batch if batch observers are registered, and a notification for
+    /// each changed search user otherwise. The observers of single search users pick their changes from the batch.
+    private func post(_ changeInfos: [UserChangeInfo]) {
+        guard !changeInfos.isEmpty, let moc = managedObjectContext else { return }
+
+        guard batchObserverCount > 0 else {
+            changeInfos.forEach { SearchUserSnapshot.post($0, in: moc) }
+            return
+        }
+
+        NotificationInContext(name: .SearchUserBatchChange,
+                              context: moc.notificationContext,
+                              userInfo: [SearchUserObserverCenter.changeInfosKey: changeInfos]).post()
     }
 
     public func stopObserving() {
@@ -194,3 +297,24 @@ public class SearchUserSnapshot {
     }
 
 }
+
+/// Keeps the notification observers of a search user observer registered. The token of a batch observer
+/// also counts it in the observer center, so the center knows whether to post batches.
+final class SearchUserObserverToken: NSObject {
+
+    private let tokens: [ManagedObjectObserverToken]
+    private weak var batchObserverCenter: SearchUserObserverCenter?
+
+    init(tokens: [ManagedObjectObserverToken], batchObserverCenter: SearchUserObserverCenter? = nil) {
+        self.tokens = tokens
+        self.batchObserverCenter = batchObserverCenter
+        super.init()
+
+        batchObserverCenter?.batchObserverCount += 1
+    }
+
+    deinit {
+        batchObserverCenter?.batchObserverCount -= 1
+    }
+
+}
@@ -0,0 +1,406 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// The assets downloaded for users and teams, as opposed to the assets of messages.
+public enum AssetDownloadKind: CaseIterable {
+    case userPreviewImage
+    case userCompleteImage
+    case teamLogo
+
+    init(_ size: ProfileImageSize) {
+        switch size {
+        case .preview:
+            self = .userPreviewImage
+        case .complete:
+            self = .userCompleteImage
+        }
+    }
+
+    fileprivate static func kinds(of object: NSManagedObject) -> [AssetDownloadKind] {
+        switch object {
+        case is ZMUser:
+            return [.userPreviewImage, .userCompleteImage]
+        case is Team:
+            return [.teamLogo]
+        default:
+            return []
+        }
+    }
+
+    fileprivate var entityName: String {
+        switch self {
+        case .userPreviewImage, .userCompleteImage:
+            return ZMUser.entityName()
+        case .teamLogo:
+            return Team.entityName()
+        }
+    }
+
+    fileprivate var assetIdentifierKey: String {
+        switch self {
+        case .userPreviewImage:
+            return ZMUser.previewProfileAssetIdentifierKey
+        case .userCompleteImage:
+            return ZMUser.completeProfileAssetIdentifierKey
+        case .teamLogo:
+            return Team.pictureAssetIdKey
+        }
+    }
+
+    /// Matches the objects which have an asset of this kind that isn't cached yet.
+    var downloadFilter: NSPredicate {
+        let assetIdExists = NSPredicate(format: "(%K != nil)", assetIdentifierKey)
+        let needsDownload = NSPredicate { (object, _) -> Bool in
+            guard let object = object as? NSManagedObject, let context = object.managedObjectContext else { return false }
+            return context.assetDownloadWorkIndex.needsDownload(object, kind: self)
+        }
+        return NSCompoundPredicate(andPredicateWithSubpredicates: [assetIdExists, needsDownload])
+    }
+
+    // MARK: - Asset state
+
+    /// Whether the object has a downloadable asset of this kind.
+    fileprivate func hasAsset(_ object: NSManagedObject) -> Bool {
+        switch (self, object) {
+        case (.userPreviewImage, let user as ZMUser):
+            return user.previewProfileAssetIdentifier?.isValidAssetID ?? false
+        case (.userCompleteImage, let user as ZMUser):
+            return user.completeProfileAssetIdentifier?.isValidAssetID ?? false
+        case (.teamLogo, let team as Team):
+            return team.pictureAssetId != nil
+        default:
+            return false
+        }
+    }
+
+    /// The key under which the asset of the object is cached.
+    fileprivate func cacheKey(of object: NSManagedObject) -> String? {
+        switch (self, object) {
+        case (.userPreviewImage, let user as ZMUser):
+            return user.imageCacheKey(for: .preview)
+        case (.userCompleteImage, let user as ZMUser):
+            return user.imageCacheKey(for: .complete)
+        case (.teamLogo, let team as Team):
+            return FileAssetCache.cacheKeyForAsset(for: team, format: Team.defaultLogoFormat)
+        default:
+            return nil
+        }
+    }
+
+    /// Whether the cache contains the asset of the object, the asset itself isn't read.
+    fileprivate func isCached(_ object: NSManagedObject) -> Bool {
+        switch (self, object) {
+        case (.userPreviewImage, let user as ZMUser):
+            return user.managedObjectContext?.zm_userImageCache?.hasUserImage(user, size: .preview) ?? false
+        case (.userCompleteImage, let user as ZMUser):
+            return user.managedObjectContext?.zm_userImageCache?.hasUserImage(user, size: .complete) ?? false
+        case (.teamLogo, let team as Team):
+            return team.managedObjectContext?.zm_fileAssetCache?.hasDataOnDisk(for: team, format: Team.defaultLogoFormat, encrypted: false) ?? false
+        default:
+            return false
+        }
+    }
+
+    fileprivate func needsDownload(_ object: NSManagedObject) -> Bool {
+        return hasAsset(object) && !isCached(object)
+    }
+
+}
+
+extension Notification.Name {
+
+    /// Posted by `UserImageLocalCache` and `FileAssetCache` when they store or drop assets of users and teams.
+    /// The object is the cache, `AssetDownloadWorkIndex.cacheKeysKey` holds the affected cache keys
+    /// and is missing when the whole cache was dropped.
+    static let assetCacheDidChange = Notification.Name("AssetCacheDidChangeNotification")
+
+}
+
+extension NSManagedObjectContext {
+
+    static let AssetDownloadWorkIndexKey = "AssetDownloadWorkIndexKey"
+
+    var assetDownloadWorkIndex: AssetDownloadWorkIndex {
+        if let index = userInfo[NSManagedObjectContext.AssetDownloadWorkIndexKey] as? AssetDownloadWorkIndex {
+            return index
+        }
+
+        let index = AssetDownloadWorkIndex(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.AssetDownloadWorkIndexKey] = index
+        return index
+    }
+
+}
+
+/// Keeps track of the users and teams whose assets need to be downloaded, by kind of asset.
+///
+/// The objects of a kind are collected the first time pending work of that kind is looked up, checking
+/// whether the caches contain their assets without reading them. They're then updated when asset
+/// identifiers change and when the caches report stored or dropped assets, so looking up pending work
+/// touches neither the caches nor the objects. Objects which aren't saved yet are checked on every lookup.
+
+final class AssetDownloadWorkIndex: NSObject, TearDownCapable {
+
+    static let cacheKeysKey = "cacheKeys"
+
+    private final class Bucket {
+
+        var pending: Set<NSManagedObjectID> = []
+        var objectIDsByCacheKey: [String: NSManagedObjectID] = [:]
+        var cacheKeysByObjectID: [NSManagedObjectID: String] = [:]
+
+        func set(_ objectID: NSManagedObjectID, cacheKey: String?, needsDownload: Bool) {
+            remove(objectID)
+
+            if let cacheKey = cacheKey {
+                objectIDsByCacheKey[cacheKey] = objectID
+                cacheKeysByObjectID[objectID] = cacheKey
+            }
+
+            if needsDownload {
+                pending.insert(objectID)
+            }
+        }
+
+        func remove(_ objectID: NSManagedObjectID) {
+            pending.remove(objectID)
+
+            if let cacheKey = cacheKeysByObjectID.removeValue(forKey: objectID) {
+                objectIDsByCacheKey.removeValue(forKey: cacheKey)
+            }
+        }
+
+    }
+
+    private var buckets: [AssetDownloadKind: Bucket] = [:]
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        super.init()
+
+        let center = NotificationCenter.default
+
+        observerTokens.append(center.addObserver(forName: .NSManagedObjectContextObjectsDidChange,
+                                                 object: managedObjectContext,
+                                                 queue: nil) { [weak self] note in
+            self?.objectsDidChange(note)
+        })
+
+        observerTokens.append(center.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                 object: managedObjectContext,
+                                                 queue: nil) { [weak self] note in
+            self?.contextDidSave(note)
+        })
+
+        // The caches are shared between contexts and report changes from any queue
+        observerTokens.append(center.addObserver(forName: .assetCacheDidChange,
+                                                 object: nil,
+                                                 queue: nil) { [weak self] note in
+            let cache = note.object as AnyObject?
+            let cacheKeys = note.userInfo?[AssetDownloadWorkIndex.cacheKeysKey] as? [String]
+
+            self?.managedObjectContext?.performGroupedBlock {
+                self?.cacheDidChange(cache, cacheKeys: cacheKeys)
+            }
+        })
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    func tearDown() {
+        observerTokens.forEach(NotificationCenter.default.removeObserver)
+        observerTokens = []
+        buckets = [:]
+    }
+
+    static func notifyCacheDidChange(_ cache: AnyObject, cacheKeys: [String]?) {
+        let userInfo = cacheKeys.map { [AssetDownloadWorkIndex.cacheKeysKey: $0] }
+        NotificationCenter.default.post(name: .assetCacheDidChange, object: cache, userInfo: userInfo)
+    }
+
+    // MARK: - Lookup
+
+    /// Whether the asset of the given kind needs to be downloaded for the object.
+    func needsDownload(_ object: NSManagedObject, kind: AssetDownloadKind) -> Bool {
+        guard !object.objectID.isTemporaryID else {
+            return kind.needsDownload(object)
+        }
+
+        return bucket(for: kind).pending.contains(object.objectID)
+    }
+
+    /// The objects with an asset of the given kind which isn't cached yet.
+    func pendingObjects(of kind: AssetDownloadKind) -> [NSManagedObject] {
+        guard let context = managedObjectContext else { return [] }
+
+        let saved = bucket(for: kind).pending.compactMap { try? context.existingObject(with: $0) }
+        let inserted = context.insertedObjects.filter {
+            $0.objectID.isTemporaryID && AssetDownloadKind.kinds(of: $0).contains(kind) && kind.needsDownload($0)
+        }
+
+        return saved + inserted
+    }
+
+    private func bucket(for kind: AssetDownloadKind) -> Bucket {
+        if let bucket = buckets[kind] {
+            return bucket
+        }
+
+        let bucket = Bucket()
+        buckets[kind] = bucket
+
+        guard let context = managedObjectContext else { return bucket }
+
+        let request = NSFetchRequest<NSManagedObject>(entityName: kind.entityName)
+        request.predicate = NSPredicate(format: "%K != nil", kind.assetIdentifierKey)
+
+        for object in context.fetchOrAssert(request: request) where !object.objectID.isTemporaryID {
+            bucket.set(object.objectID, cacheKey: kind.cacheKey(of: object), needsDownload: kind.needsDownload(object))
+        }
+
+        return bucket
+    }
+
+    // MARK: - Updates
+
+    /// Checks again whether the asset of the given kind needs to be downloaded for the object,
+    /// e.g. after its asset identifier changed or its asset was stored.
+    func update(_ object: NSManagedObject, kind: AssetDownloadKind) {
+        guard let bucket = buckets[kind], !object.objectID.isTemporaryID else { return }
+
+        guard !object.isDeleted else {
+            bucket.remove(object.objectID)
+            return
+        }
+
+        bucket.set(object.objectID, cacheKey: kind.cacheKey(of: object), needsDownload: kind.needsDownload(object))
+    }
+
+    func update(_ object: NSManagedObject) {
+        AssetDownloadKind.kinds(of: object).forEach { update(object, kind: $0) }
+    }
+
+    /// Updates the object only if its cache key changed, the caches report changes to the cached assets.
+    private func updateIfCacheKeyChanged(_ object: NSManagedObject) {
+        for kind in AssetDownloadKind.kinds(of: object) {
+            guard let bucket = buckets[kind] else { continue }
+
+            let cacheKey = kind.cacheKey(of: object)
+            if cacheKey == nil || cacheKey != bucket.cacheKeysByObjectID[object.objectID] {
+                update(object, kind: kind)
+            }
+        }
+    }
+
+    func invalidateAll() {
+        buckets = [:]
+    }
+
+    private func cacheDidChange(_ cache: AnyObject?, cacheKeys: [String]?) {
+        guard
+            !buckets.isEmpty,
+            let context = managedObjectContext,
+            cache === context.zm_userImageCache || cache === context.zm_fileAssetCache
+        else { return }
+
+        guard let cacheKeys = cacheKeys else {
+            invalidateAll()
+            return
+        }
+
+        for (kind, bucket) in buckets {
+            for cacheKey in cacheKeys {
+                guard
+                    let objectID = bucket.objectIDsByCacheKey[cacheKey],
+                    let object = try? context.existingObject(with: objectID)
+                else { continue }
+
+                update(object, kind: kind)
+            }
+        }
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        guard userInfo[NSInvalidatedAllObjectsKey] == nil else {
+            invalidateAll()
+            return
+        }
+
+        guard !buckets.isEmpty else { return }
+
+        // Changes made in this context are applied by the model hooks, merged changes show up as refreshed objects
+        if let refreshed = userInfo[NSRefreshedObjectsKey] as? Set<NSManagedObject> {
+            refreshed.forEach(updateIfCacheKeyChanged)
+        }
+
+        for key in [NSDeletedObjectsKey, NSInvalidatedObjectsKey] {
+            guard let objects = userInfo[key] as? Set<NSManagedObject> else { continue }
+
+            for object in objects {
+                AssetDownloadKind.kinds(of: object).forEach { buckets[$0]?.remove(object.objectID) }
+            }
+        }
+    }
+
+    private func contextDidSave(_ note: Notification) {
+        guard !buckets.isEmpty, let inserted = note.userInfo?[NSInsertedObjectsKey] as? Set<NSManagedObject> else { return }
+
+        // Inserted objects are only indexed once they have a permanent object ID
+        inserted.forEach(update)
+    }
+
+}
+
+// MARK: - Pending downloads
+
+extension ZMUser {
+
+    /// The users whose profile image of the given size needs to be downloaded.
+    public static func usersWithPendingImageDownload(size: ProfileImageSize, in context: NSManagedObjectContext) -> [ZMUser] {
+        return context.assetDownloadWorkIndex.pendingObjects(of: AssetDownloadKind(size)).compactMap { $0 as? ZMUser }
+    }
+
+}
+
+extension Team {
+
+    /// The teams whose logo needs to be downloaded.
+    public static func teamsWithPendingLogoDownload(in context: NSManagedObjectContext) -> [Team] {
+        return context.assetDownloadWorkIndex.pendingObjects(of: .teamLogo).compactMap { $0 as? Team }
+    }
+
+    public override func didChangeValue(forKey key: String) {
+        super.didChangeValue(forKey: key)
+
+        switch key {
+        case #keyPath(Team.pictureAssetId), "remoteIdentifier_data":
+            managedObjectContext?.assetDownloadWorkIndex.update(self, kind: .teamLogo)
+        default:
+            break
+        }
+    }
+
+}
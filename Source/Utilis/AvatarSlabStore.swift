@@ -0,0 +1,355 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+private let zmLog = ZMSLog(tag: "AvatarSlabStore")
+
+/// Stores small images packed into a single file, with a bounded memory tier in front of it.
+///
+/// The slab is an append-only sequence of records, each made of a header with the key and data lengths,
+/// the key and the data. Removing an image appends a record without data. The index of the records is
+/// rebuilt from the headers the first time the slab is used, and the slab is compacted, keeping the most
+/// recently written images, once it grows over its byte limit.
+///
+/// Each store keeps its own index and length of the slab, so there must only be one store per slab:
+/// stores are obtained through `store(for:byteLimit:memoryCostLimit:)`, which shares them by file URL.
+
+final class AvatarSlabStore {
+
+    private static let lock = NSLock()
+    private static let stores = NSMapTable<NSURL, AvatarSlabStore>.strongToWeakObjects()
+
+    /// Returns the store of the slab at the given URL, creating it if there is none yet.
+    static func store(for fileURL: URL, byteLimit: UInt64, memoryCostLimit: Int) -> AvatarSlabStore {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let key = fileURL.standardizedFileURL as NSURL
+
+        if let store = stores.object(forKey: key) {
+            return store
+        }
+
+        let store = AvatarSlabStore(fileURL: fileURL, byteLimit: byteLimit, memoryCostLimit: memoryCostLimit)
+        stores.setObject(store, forKey: key)
+        return store
+    }
+
+    private struct Record {
+        let offset: UInt64
+        let length: Int
+    }
+
+    private static let headerLength = 6
+    private static let removedLength = UInt32.max
+
+    let fileURL: URL
+    let byteLimit: UInt64
+
+    private let memoryTier = NSCache<NSString, NSData>()
+
+    /// The queue the slab is read and written on, compacting runs asynchronously on it.
+    let queue: DispatchQueue
+
+    // Only accessed on `queue`
+    private var index: [String: Record]?
+    private var fileLength: UInt64 = 0
+    private var isCompactionScheduled = false
+    private var evictionHandlers: [(owner: () -> AnyObject?, handler: ([String]) -> Void)] = []
+
+    init(fileURL: URL, byteLimit: UInt64, memoryCostLimit: Int) {
+        self.fileURL = fileURL
+        self.byteLimit = byteLimit
+        self.queue = DispatchQueue(label: "AvatarSlabStore \(fileURL.lastPathComponent)", qos: .userInitiated)
+        memoryTier.totalCostLimit = memoryCostLimit
+    }
+
+    /// Registers a block called on the store's queue with the keys of the images dropped by compacting
+    /// the slab, for as long as the owner is alive.
+    func addEvictionHandler(for owner: AnyObject, _ handler: @escaping ([String]) -> Void) {
+        queue.sync {
+            evictionHandlers.append((owner: { [weak owner] in owner }, handler: handler))
+        }
+    }
+
+    // MARK: - Access
+
+    func data(forKey key: String) -> Data? {
+        if let data = memoryTier.object(forKey: key as NSString) {
+            return data as Data
+        }
+
+        return queue.sync {
+            read(keys: [key])[key]
+        }
+    }
+
+    func data(forKey key: String, queue completionQueue: DispatchQueue, completion: @escaping (Data?) -> Void) {
+        if let data = memoryTier.object(forKey: key as NSString) {
+            completionQueue.async { completion(data as Data) }
+            return
+        }
+
+        queue.async {
+            let data = self.read(keys: [key])[key]
+            completionQueue.async { completion(data) }
+        }
+    }
+
+    func contains(key: String) -> Bool {
+        if memoryTier.object(forKey: key as NSString) != nil {
+            return true
+        }
+
+        return queue.sync {
+            loadIndexIfNeeded()[key] != nil
+        }
+    }
+
+    /// Loads the images with the given keys into the memory tier, reading the slab once in file order.
+    func prefetch(keys: [String], completion: (() -> Void)? = nil) {
+        let missingKeys = keys.filter { memoryTier.object(forKey: $0 as NSString) == nil }
+
+        guard !missingKeys.isEmpty else {
+            completion?()
+            return
+        }
+
+        queue.async {
+            _ = self.read(keys: missingKeys)
+            completion?()
+        }
+    }
+
+    // MARK: - Updates
+
+    func set(_ data: Data, forKey key: String) {
+        guard data.count < Int(AvatarSlabStore.removedLength) else { return }
+
+        queue.sync {
+            guard append(key: key, data: data) else { return }
+            memoryTier.setObject(data as NSData, forKey: key as NSString, cost: data.count)
+            scheduleCompactionIfNeeded()
+        }
+    }
+
+    func removeData(forKey key: String) {
+        memoryTier.removeObject(forKey: key as NSString)
+
+        queue.sync {
+            guard loadIndexIfNeeded()[key] != nil else { return }
+            _ = append(key: key, data: nil)
+        }
+    }
+
+    func removeAll() {
+        memoryTier.removeAllObjects()
+
+        queue.sync {
+            try? FileManager.default.removeItem(at: fileURL)
+            index = [:]
+            fileLength = 0
+        }
+    }
+
+    // MARK: - Slab
+
+    @discardableResult
+    private func loadIndexIfNeeded() -> [String: Record] {
+        if let index = index {
+            return index
+        }
+
+        var index: [String: Record] = [:]
+        var offset: UInt64 = 0
+
+        if let handle = FileHandle(forReadingAtPath: fileURL.path) {
+            let length = handle.seekToEndOfFile()
+            handle.seek(toFileOffset: 0)
+
+            while offset + UInt64(AvatarSlabStore.headerLength) <= length {
+                let header = handle.readData(ofLength: AvatarSlabStore.headerLength)
+                guard header.count == AvatarSlabStore.headerLength else { break }
+
+                let keyLength = Int(header.littleEndianInteger(UInt16.self, at: 0))
+                let dataLength = header.littleEndianInteger(UInt32.self, at: 2)
+                let storedLength = dataLength == AvatarSlabStore.removedLength ? 0 : UInt64(dataLength)
+                let recordLength = UInt64(AvatarSlabStore.headerLength + keyLength) + storedLength
+
+                // A record cut short by a crash ends the slab, it's overwritten by the next write
+                guard
+                    offset + recordLength <= length,
+                    let key = String(data: handle.readData(ofLength: keyLength), encoding: .utf8)
+                else { break }
+
+                if dataLength == AvatarSlabStore.removedLength {
+                    index.removeValue(forKey: key)
+                } else {
+                    index[key] = Record(offset: offset + UInt64(AvatarSlabStore.headerLength + keyLength), length: Int(dataLength))
+                }
+
+                offset += recordLength
+                handle.seek(toFileOffset: offset)
+            }
+
+            handle.closeFile()
+        }
+
+        self.index = index
+        self.fileLength = offset
+        return index
+    }
+
+    /// Reads the data of the given keys from the slab in file order and adds them to the memory tier.
+    private func read(keys: [String]) -> [String: Data] {
+        let index = loadIndexIfNeeded()
+        let records = keys.compactMap { key in index[key].map { (key, $0) } }.sorted { $0.1.offset < $1.1.offset }
+
+        guard !records.isEmpty, let handle = FileHandle(forReadingAtPath: fileURL.path) else { return [:] }
+        defer { handle.closeFile() }
+
+        var result: [String: Data] = [:]
+
+        for (key, record) in records {
+            handle.seek(toFileOffset: record.offset)
+            let data = handle.readData(ofLength: record.length)
+            guard data.count == record.length else { continue }
+
+            result[key] = data
+            memoryTier.setObject(data as NSData, forKey: key as NSString, cost: data.count)
+        }
+
+        return result
+    }
+
+    private func append(key: String, data: Data?) -> Bool {
+        loadIndexIfNeeded()
+
+        let keyData = Data(key.utf8)
+        guard keyData.count <= Int(UInt16.max) else { return false }
+
+        if !FileManager.default.fileExists(atPath: fileURL.path) {
+            createSlab()
+        }
+
+        guard let handle = FileHandle(forWritingAtPath: fileURL.path) else {
+            zmLog.warn("Can't open avatar slab for writing")
+            return false
+        }
+        defer { handle.closeFile() }
+
+        var record = Data(capacity: AvatarSlabStore.headerLength + keyData.count + (data?.count ?? 0))
+        record.appendLittleEndian(UInt16(keyData.count))
+        record.appendLittleEndian(data.map { UInt32($0.count) } ?? AvatarSlabStore.removedLength)
+        record.append(keyData)
+        data.map { record.append($0) }
+
+        handle.truncateFile(atOffset: fileLength)
+        handle.write(record)
+
+        if let data = data {
+            index?[key] = Record(offset: fileLength + UInt64(AvatarSlabStore.headerLength + keyData.count), length: data.count)
+        } else {
+            index?.removeValue(forKey: key)
+        }
+
+        fileLength += UInt64(record.count)
+        return true
+    }
+
+    private func createSlab() {
+        let directory = fileURL.deletingLastPathComponent()
+
+        do {
+            try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true, attributes: nil)
+            FileManager.default.createFile(atPath: fileURL.path, contents: nil, attributes: nil)
+
+            var url = fileURL
+            var values = URLResourceValues()
+            values.isExcludedFromBackup = true
+            try url.setResourceValues(values)
+        } catch {
+            zmLog.warn("Can't create avatar slab: \(error)")
+        }
+    }
+
+    /// Compacts the slab after the current write once it grows over the byte limit, so rewriting it
+    /// doesn't block the caller.
+    private func scheduleCompactionIfNeeded() {
+        guard fileLength > byteLimit, !isCompactionScheduled else { return }
+
+        isCompactionScheduled = true
+        queue.async {
+            self.isCompactionScheduled = false
+            self.compactIfNeeded()
+        }
+    }
+
+    /// Rewrites the slab once it grows over the byte limit, keeping the most recently written images
+    /// which fit into three quarters of the limit.
+    private func compactIfNeeded() {
+        guard fileLength > byteLimit, let index = index else { return }
+
+        let newestFirst = index.sorted { $0.value.offset > $1.value.offset }
+        var kept: [(String, Record)] = []
+        var keptLength: UInt64 = 0
+
+        for (key, record) in newestFirst {
+            let recordLength = UInt64(AvatarSlabStore.headerLength + key.utf8.count + record.length)
+            guard keptLength + recordLength <= byteLimit / 4 * 3 else { break }
+            kept.append((key, record))
+            keptLength += recordLength
+        }
+
+        let retained = read(keys: kept.map(\.0))
+        let evicted = Set(index.keys).subtracting(retained.keys)
+
+        try? FileManager.default.removeItem(at: fileURL)
+        self.index = [:]
+        self.fileLength = 0
+
+        for (key, _) in kept.reversed() {
+            guard let data = retained[key] else { continue }
+            _ = append(key: key, data: data)
+        }
+
+        if !evicted.isEmpty {
+            evicted.forEach { memoryTier.removeObject(forKey: $0 as NSString) }
+            evictionHandlers.removeAll { $0.owner() == nil }
+            evictionHandlers.forEach { $0.handler(Array(evicted)) }
+        }
+    }
+
+}
+
+private extension Data {
+
+    func littleEndianInteger<T: FixedWidthInteger>(_ type: T.Type, at offset: Int) -> T {
+        var value: T = 0
+        for byte in 0..<MemoryLayout<T>.size {
+            value |= T(self[startIndex + offset + byte]) << (byte * 8)
+        }
+        return value
+    }
+
+    mutating func appendLittleEndian<T: FixedWidthInteger>(_ value: T) {
+        Swift.withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+
+}
@@ -0,0 +1,245 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+import os
+
+/// A timed phase of the data model hot paths.
+
+@objc(InstrumentationPhase)
+public enum InstrumentationPhase: Int, CaseIterable {
+    case fetch
+    case save
+    case mergeChanges
+    case changeDetection
+    case notification
+    case conversationListRecalculation
+}
+
+/// A counted event of the data model hot paths.
+
+@objc(InstrumentationCounter)
+public enum InstrumentationCounter: Int, CaseIterable {
+    case fetches
+    case rowsReturned
+    case faultsFired
+    case objectsMerged
+    case changeInfosProduced
+    case notificationsPosted
+}
+
+/// Receives the measurements of the hot paths, see `Instrumentation`.
+///
+/// Sink methods are called on the queue of the context being measured, so a sink
+/// which is shared between contexts must be thread safe.
+
+@objc
+public protocol InstrumentationSink: AnyObject {
+
+    /// Called when a phase ended, `entity` is the entity name if the phase is specific to one.
+    func record(_ phase: InstrumentationPhase, entity: String?, duration: TimeInterval)
+
+    /// Called when a counter is incremented, `entity` is the entity name if the event is specific to one.
+    func add(_ value: Int, to counter: InstrumentationCounter, entity: String?)
+
+}
+
+/// Entry point of the hot path instrumentation.
+///
+/// Nothing is measured until a sink is set, each instrumented call site then only costs reading the sink.
+/// The sink can be set from any queue, e.g. at launch or in the `setUp` of a test.
+
+@objcMembers
+public final class Instrumentation: NSObject {
+
+    private static let lock: UnsafeMutablePointer<os_unfair_lock> = {
+        let lock = UnsafeMutablePointer<os_unfair_lock>.allocate(capacity: 1)
+        lock.initialize(to: os_unfair_lock())
+        return lock
+    }()
+
+    private static var _sink: InstrumentationSink?
+
+    /// Checked before taking the lock, so call sites don't lock while instrumentation is disabled. A call
+    /// site reading a stale value either takes the lock and finds no sink, or misses a measurement right
+    /// after the sink was set.
+    private static var hasSink = false
+
+    /// The call sites read the sink on the queues of the contexts being measured, so it's guarded by a lock.
+    public static var sink: InstrumentationSink? {
+        get {
+            guard hasSink else { return nil }
+            os_unfair_lock_lock(lock)
+            defer { os_unfair_lock_unlock(lock) }
+            return _sink
+        }
+        set {
+            os_unfair_lock_lock(lock)
+            defer { os_unfair_lock_unlock(lock) }
+            _sink = newValue
+            hasSink = newValue != nil
+        }
+    }
+
+    public static var isEnabled: Bool {
+        return hasSink
+    }
+
+    /// Returns the current time to pass to `record(_:entity:since:)`, or 0 if disabled.
+    public static func timestamp() -> UInt64 {
+        guard hasSink else { return 0 }
+        return DispatchTime.now().uptimeNanoseconds
+    }
+
+    @objc(recordPhase:entity:since:)
+    public static func record(_ phase: InstrumentationPhase, entity: String? = nil, since start: UInt64) {
+        guard start > 0, let sink = sink else { return }
+        let elapsed = DispatchTime.now().uptimeNanoseconds - start
+        sink.record(phase, entity: entity, duration: TimeInterval(elapsed) / TimeInterval(NSEC_PER_SEC))
+    }
+
+    @objc(incrementCounter:entity:by:)
+    public static func increment(_ counter: InstrumentationCounter, entity: String? = nil, by value: Int = 1) {
+        guard value != 0, let sink = sink else { return }
+        sink.add(value, to: counter, entity: entity)
+    }
+
+    /// Runs the block and records its duration for the given phase.
+    @nonobjc
+    public static func measure<T>(_ phase: InstrumentationPhase, entity: String? = nil, _ block: () throws -> T) rethrows -> T {
+        let start = timestamp()
+        defer { record(phase, entity: entity, since: start) }
+        return try block()
+    }
+
+}
+
+// MARK: - Recorder
+
+/// A sink which accumulates counters and duration histograms in memory, to be read
+/// back by telemetry or asserted on in tests (e.g. "opening a conversation performs at most 3 fetches").
+
+@objcMembers
+public final class InstrumentationRecorder: NSObject, InstrumentationSink {
+
+    /// Durations bucketed by powers of two of microseconds, the last bucket collects everything above.
+    public struct Histogram: Equatable {
+
+        public static let bucketCount = 24
+
+        public private(set) var buckets = [Int](repeating: 0, count: Histogram.bucketCount)
+        public private(set) var count = 0
+        public private(set) var total: TimeInterval = 0
+        public private(set) var maximum: TimeInterval = 0
+
+        public var average: TimeInterval {
+            return count > 0 ? total / TimeInterval(count) : 0
+        }
+
+        /// The upper bound of the duration below which the given fraction of samples fall.
+        public func percentile(_ fraction: Double) -> TimeInterval {
+            guard count > 0 else { return 0 }
+            let rank = Int((Double(count) * fraction).rounded(.up))
+            var seen = 0
+
+            for (bucket, samples) in buckets.enumerated() {
+                seen += samples
+                if seen >= max(rank, 1) {
+                    return min(Histogram.upperBound(of: bucket), maximum)
+                }
+            }
+
+            return maximum
+        }
+
+        mutating func add(_ duration: TimeInterval) {
+            let microseconds = UInt64(max(duration, 0) * 1_000_000)
+            let bucket = min(64 - microseconds.leadingZeroBitCount, Histogram.bucketCount - 1)
+            buckets[bucket] += 1
+            count += 1
+            total += duration
+            maximum = max(maximum, duration)
+        }
+
+        mutating func merge(_ other: Histogram) {
+            buckets = zip(buckets, other.buckets).map(+)
+            count += other.count
+            total += other.total
+            maximum = max(maximum, other.maximum)
+        }
+
+        private static func upperBound(of bucket: Int) -> TimeInterval {
+            return TimeInterval(UInt64(1) << UInt64(bucket)) / 1_000_000
+        }
+
+    }
+
+    private struct Key: Hashable {
+        let kind: Int
+        let entity: String?
+    }
+
+    private let lock = NSLock()
+    private var counters: [Key: Int] = [:]
+    private var histograms: [Key: Histogram] = [:]
+
+    // MARK: InstrumentationSink
+
+    public func record(_ phase: InstrumentationPhase, entity: String?, duration: TimeInterval) {
+        lock.lock()
+        defer { lock.unlock() }
+        histograms[Key(kind: phase.rawValue, entity: entity), default: Histogram()].add(duration)
+    }
+
+    public func add(_ value: Int, to counter: InstrumentationCounter, entity: String?) {
+        lock.lock()
+        defer { lock.unlock() }
+        counters[Key(kind: counter.rawValue, entity: entity), default: 0] += value
+    }
+
+    // MARK: Reading
+
+    /// The value of a counter for the given entity, or summed over all entities if `entity` is nil.
+    public func count(of counter: InstrumentationCounter, entity: String? = nil) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return counters.reduce(0) { sum, element in
+            guard element.key.kind == counter.rawValue, entity == nil || element.key.entity == entity else { return sum }
+            return sum + element.value
+        }
+    }
+
+    /// The durations of a phase for the given entity, or of all entities if `entity` is nil.
+    @nonobjc
+    public func histogram(of phase: InstrumentationPhase, entity: String? = nil) -> Histogram {
+        lock.lock()
+        defer { lock.unlock() }
+        return histograms.reduce(into: Histogram()) { result, element in
+            guard element.key.kind == phase.rawValue, entity == nil || element.key.entity == entity else { return }
+            result.merge(element.value)
+        }
+    }
+
+    public func reset() {
+        lock.lock()
+        defer { lock.unlock() }
+        counters = [:]
+        histograms = [:]
+    }
+
+}
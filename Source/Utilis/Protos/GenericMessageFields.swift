@@ -0,0 +1,315 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// The fields of a `GenericMessage` needed to route an event, read straight from the protobuf wire format.
+///
+/// Scanning skips over the content of the message instead of decoding it, so only the strings that are
+/// returned are allocated. Use `GenericMessage(from:)` once the content is applied, a message that
+/// scans fine might still fail to decode or validate.
+
+public struct GenericMessageFields: Equatable {
+
+    /// Field numbers of the `content` oneof of `GenericMessage`, see `messages.proto`.
+    public enum ContentType: Int {
+        case text = 2
+        case image = 3
+        case knock = 4
+        case lastRead = 6
+        case cleared = 7
+        case external = 8
+        case clientAction = 9
+        case calling = 10
+        case asset = 11
+        case hidden = 12
+        case location = 13
+        case deleted = 14
+        case edited = 15
+        case confirmation = 16
+        case reaction = 17
+        case ephemeral = 18
+        case availability = 19
+        case composite = 20
+        case buttonAction = 21
+        case buttonActionConfirmation = 22
+        case dataTransfer = 23
+    }
+
+    public internal(set) var messageID: String?
+    public internal(set) var contentType: ContentType?
+
+    /// The content type of the message wrapped in an ephemeral message.
+    public internal(set) var ephemeralContentType: ContentType?
+    public internal(set) var legalHoldStatus: LegalHoldStatus = .unknown
+
+    /// The IDs of the messages confirmed by a confirmation message.
+    public internal(set) var confirmedMessageIDs: [String] = []
+
+    public var isEphemeral: Bool {
+        return contentType == .ephemeral
+    }
+
+    public var nonce: UUID? {
+        return messageID.flatMap(UUID.init(uuidString:))
+    }
+
+    /// Returns the fields of a serialized `GenericMessage`, or nil if the data isn't valid wire format.
+    public init?(serializedData data: Data) {
+        let scanned: GenericMessageFields? = data.withUnsafeBytes { bytes in
+            var reader = ProtobufReader(bytes: bytes)
+            var fields = GenericMessageFields()
+            return fields.scanGenericMessage(&reader) ? fields : nil
+        }
+
+        guard let fields = scanned else { return nil }
+        self = fields
+    }
+
+    init() {}
+
+}
+
+// MARK: - Scanning
+
+private extension GenericMessageFields {
+
+    mutating func scanGenericMessage(_ reader: inout ProtobufReader) -> Bool {
+        while !reader.isAtEnd {
+            guard let (fieldNumber, wireType) = reader.readTag() else { return false }
+
+            switch (fieldNumber, wireType) {
+            case (1, .lengthDelimited):
+                guard let value = reader.readString() else { return false }
+                messageID = value
+
+            case (_, .lengthDelimited):
+                guard var content = reader.readLengthDelimited() else { return false }
+                guard let contentType = ContentType(rawValue: fieldNumber) else { continue }
+
+                self.contentType = contentType
+                ephemeralContentType = nil
+                legalHoldStatus = .unknown
+                confirmedMessageIDs = []
+
+                guard scanContent(contentType, &content) else { return false }
+
+            case (_, .varint) where ContentType(rawValue: fieldNumber) == .clientAction:
+                guard reader.readVarint() != nil else { return false }
+                contentType = .clientAction
+
+            default:
+                guard reader.skip(wireType) else { return false }
+            }
+        }
+
+        return true
+    }
+
+    mutating func scanContent(_ contentType: ContentType, _ reader: inout ProtobufReader) -> Bool {
+        switch contentType {
+        case .ephemeral:
+            return scanEphemeral(&reader)
+        case .confirmation:
+            return scanConfirmation(&reader)
+        default:
+            guard let fieldNumber = GenericMessageFields.legalHoldStatusFieldNumber(of: contentType) else { return true }
+            return scanLegalHoldStatus(fieldNumber: fieldNumber, &reader)
+        }
+    }
+
+    mutating func scanEphemeral(_ reader: inout ProtobufReader) -> Bool {
+        // Ephemeral { expire_after_millis = 1; oneof content { text = 2; image = 3; knock = 4; asset = 5; location = 6 } }
+        let contentTypes: [Int: ContentType] = [2: .text, 3: .image, 4: .knock, 5: .asset, 6: .location]
+
+        while !reader.isAtEnd {
+            guard let (fieldNumber, wireType) = reader.readTag() else { return false }
+
+            if wireType == .lengthDelimited, let contentType = contentTypes[fieldNumber] {
+                guard var content = reader.readLengthDelimited() else { return false }
+                ephemeralContentType = contentType
+                legalHoldStatus = .unknown
+
+                if let legalHoldFieldNumber = GenericMessageFields.legalHoldStatusFieldNumber(of: contentType) {
+                    guard scanLegalHoldStatus(fieldNumber: legalHoldFieldNumber, &content) else { return false }
+                }
+            } else {
+                guard reader.skip(wireType) else { return false }
+            }
+        }
+
+        return true
+    }
+
+    mutating func scanConfirmation(_ reader: inout ProtobufReader) -> Bool {
+        // Confirmation { first_message_id = 1; type = 2; more_message_ids = 3 }
+        var firstMessageID: String?
+        var moreMessageIDs: [String] = []
+
+        while !reader.isAtEnd {
+            guard let (fieldNumber, wireType) = reader.readTag() else { return false }
+
+            switch (fieldNumber, wireType) {
+            case (1, .lengthDelimited):
+                guard let value = reader.readString() else { return false }
+                firstMessageID = value
+            case (3, .lengthDelimited):
+                guard let value = reader.readString() else { return false }
+                moreMessageIDs.append(value)
+            default:
+                guard reader.skip(wireType) else { return false }
+            }
+        }
+
+        confirmedMessageIDs = (firstMessageID.map { [$0] } ?? []) + moreMessageIDs
+        return true
+    }
+
+    mutating func scanLegalHoldStatus(fieldNumber legalHoldFieldNumber: Int, _ reader: inout ProtobufReader) -> Bool {
+        while !reader.isAtEnd {
+            guard let (fieldNumber, wireType) = reader.readTag() else { return false }
+
+            if fieldNumber == legalHoldFieldNumber, wireType == .varint {
+                guard let value = reader.readVarint() else { return false }
+                legalHoldStatus = LegalHoldStatus(rawValue: Int(truncatingIfNeeded: value)) ?? .unknown
+            } else {
+                guard reader.skip(wireType) else { return false }
+            }
+        }
+
+        return true
+    }
+
+    /// The field number of `legal_hold_status` in the messages which have one, see `messages.proto`.
+    static func legalHoldStatusFieldNumber(of contentType: ContentType) -> Int? {
+        switch contentType {
+        case .text:
+            return 7
+        case .knock:
+            return 3
+        case .location:
+            return 6
+        case .asset:
+            return 7
+        case .reaction:
+            return 3
+        default:
+            return nil
+        }
+    }
+
+}
+
+// MARK: - Wire format
+
+/// Reads protobuf wire format from a buffer without copying it.
+private struct ProtobufReader {
+
+    enum WireType: UInt64 {
+        case varint = 0
+        case fixed64 = 1
+        case lengthDelimited = 2
+        case startGroup = 3
+        case endGroup = 4
+        case fixed32 = 5
+    }
+
+    private let bytes: UnsafeRawBufferPointer
+    private var position: Int
+    private let end: Int
+
+    init(bytes: UnsafeRawBufferPointer) {
+        self.init(bytes: bytes, range: 0..<bytes.count)
+    }
+
+    private init(bytes: UnsafeRawBufferPointer, range: Range<Int>) {
+        self.bytes = bytes
+        self.position = range.lowerBound
+        self.end = range.upperBound
+    }
+
+    var isAtEnd: Bool {
+        return position >= end
+    }
+
+    mutating func readVarint() -> UInt64? {
+        var value: UInt64 = 0
+        var shift: UInt64 = 0
+
+        while position < end, shift < 64 {
+            let byte = bytes[position]
+            position += 1
+            value |= UInt64(byte & 0x7f) << shift
+
+            if byte & 0x80 == 0 {
+                return value
+            }
+
+            shift += 7
+        }
+
+        return nil
+    }
+
+    mutating func readTag() -> (fieldNumber: Int, wireType: WireType)? {
+        guard
+            let tag = readVarint(),
+            let wireType = WireType(rawValue: tag & 0x7),
+            tag >> 3 > 0, tag >> 3 <= UInt64(Int32.max)
+        else { return nil }
+
+        return (Int(tag >> 3), wireType)
+    }
+
+    /// Returns a reader for the next length delimited field and moves past it.
+    mutating func readLengthDelimited() -> ProtobufReader? {
+        guard let length = readVarint(), length <= UInt64(end - position) else { return nil }
+
+        let range = position..<(position + Int(length))
+        position = range.upperBound
+        return ProtobufReader(bytes: bytes, range: range)
+    }
+
+    mutating func readString() -> String? {
+        guard let field = readLengthDelimited() else { return nil }
+        return String(bytes: UnsafeRawBufferPointer(rebasing: bytes[field.position..<field.end]), encoding: .utf8)
+    }
+
+    mutating func skip(_ wireType: WireType) -> Bool {
+        switch wireType {
+        case .varint:
+            return readVarint() != nil
+        case .fixed64:
+            return advance(by: 8)
+        case .fixed32:
+            return advance(by: 4)
+        case .lengthDelimited:
+            return readLengthDelimited() != nil
+        case .startGroup, .endGroup:
+            // Groups aren't used by the messages
+            return false
+        }
+    }
+
+    private mutating func advance(by count: Int) -> Bool {
+        guard end - position >= count else { return false }
+        position += count
+        return true
+    }
+
+}
@@ -0,0 +1,471 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+private let zmLog = ZMSLog(tag: "SearchNameIndex")
+
+extension NSManagedObjectContext {
+
+    static let SearchNameIndexKey = "SearchNameIndexKey"
+
+    /// The token prefix index of user and conversation names in this context. The index is
+    /// built on first access and then kept up to date from the object changes of the context and
+    /// the saves of the other contexts of the store.
+    public var searchNameIndex: SearchNameIndex {
+        if let index = userInfo[NSManagedObjectContext.SearchNameIndexKey] as? SearchNameIndex {
+            return index
+        }
+
+        let index = SearchNameIndex(managedObjectContext: self)
+        userInfo[NSManagedObjectContext.SearchNameIndexKey] = index
+        return index
+    }
+
+}
+
+/// An in-memory index of the word prefixes of the searchable names of users and conversations.
+///
+/// Matching a query word against the index gives the same result as the `.*\bword.*` regular
+/// expression built by `NSPredicate(formatDictionary:matchingSearch:)`, but it's answered by a
+/// binary search in a sorted token table instead of evaluating the expression on every row.
+///
+/// Names are split into words like the query, so a word with inner punctuation, e.g. "o'neil", is a
+/// single word. The expression also matches at the word boundary after the punctuation, so the tail of
+/// such a word ("neil") is indexed as a token of its own.
+///
+/// Changes made in the index's context are indexed from its objects. Saves of other contexts of the
+/// same store are indexed by fetching the indexed properties of the saved objects, so users and
+/// conversations created elsewhere are found even if they were never registered in this context.
+public final class SearchNameIndex: NSObject, TearDownCapable {
+
+    public enum Field: Int, CaseIterable {
+        /// `ZMUser.normalizedName`
+        case userName
+        /// `ZMUser.handle`, indexed as a single token
+        case userHandle
+        /// `ZMConversation.normalizedUserDefinedName`
+        case conversationName
+    }
+
+    /// The largest number of matches the predicates answered by the index list in their `SELF IN` clause.
+    /// Queries matching more objects, e.g. a single letter, fall back to the regular expression predicates.
+    public static let maximumPredicateMatchCount = 500
+
+    private struct Entry {
+        let token: String
+        let objectID: NSManagedObjectID
+    }
+
+    /// The changes collected while updating the index, applied to the tables at the end of a batch.
+    private struct Batch {
+        var removed: [Field: Set<NSManagedObjectID>] = [:]
+        var added: [Field: [NSManagedObjectID: [String]]] = [:]
+    }
+
+    private static let userFields: [(String, Field)] = [(#keyPath(ZMUser.normalizedName), .userName),
+                                                        (#keyPath(ZMUser.handle), .userHandle)]
+    private static let conversationFields: [(String, Field)] = [(ZMNormalizedUserDefinedNameKey, .conversationName)]
+
+    /// One token table per field, each sorted by token.
+    private var tables: [[Entry]] = Field.allCases.map { _ in [] }
+    private var tokensByObjectID: [Field: [NSManagedObjectID: [String]]] = [:]
+    private var batch: Batch?
+    private weak var managedObjectContext: NSManagedObjectContext?
+    private weak var persistentStoreCoordinator: NSPersistentStoreCoordinator?
+    private var observerTokens: [NSObjectProtocol] = []
+
+    init(managedObjectContext: NSManagedObjectContext) {
+        self.managedObjectContext = managedObjectContext
+        self.persistentStoreCoordinator = managedObjectContext.persistentStoreCoordinator
+        super.init()
+
+        build()
+
+        // Inserted objects only get their permanent object IDs when saved, so they are picked up from
+        // the save notification rather than the change notification.
+        let notifications: [Notification.Name] = [.NSManagedObjectContextObjectsDidChange, .NSManagedObjectContextDidSave]
+
+        observerTokens = notifications.map { name in
+            NotificationCenter.default.addObserver(forName: name,
+                                                   object: managedObjectContext,
+                                                   queue: nil) { [weak self] note in
+                self?.objectsDidChange(note)
+            }
+        }
+
+        observerTokens.append(NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                                     object: nil,
+                                                                     queue: nil) { [weak self] note in
+            self?.otherContextDidSave(note)
+        })
+    }
+
+    deinit {
+        tearDown()
+    }
+
+    public func tearDown() {
+        observerTokens.forEach { NotificationCenter.default.removeObserver($0) }
+        observerTokens = []
+    }
+
+    // MARK: - Queries
+
+    /// Returns the objects which have a token starting with each of the words of the query in any of the given fields.
+    public func objectIDs(matching query: String, in fields: [Field]) -> Set<NSManagedObjectID> {
+        var result: Set<NSManagedObjectID>?
+
+        for word in SearchNameIndex.queryWords(query) {
+            let matches = fields.reduce(into: Set<NSManagedObjectID>()) { matches, field in
+                matches.formUnion(objectIDs(withTokenPrefix: word, in: field))
+            }
+
+            result = result?.intersection(matches) ?? matches
+
+            if result?.isEmpty == true {
+                break
+            }
+        }
+
+        return result ?? []
+    }
+
+    /// Returns the objects which have a token starting with any of the words of the query in the given field.
+    public func objectIDs(matchingAnyWordOf query: String, in field: Field) -> Set<NSManagedObjectID> {
+        return SearchNameIndex.queryWords(query).reduce(into: Set<NSManagedObjectID>()) { matches, word in
+            matches.formUnion(objectIDs(withTokenPrefix: word, in: field))
+        }
+    }
+
+    /// Returns the objects which have a token starting with the given prefix in the given field.
+    public func objectIDs(withTokenPrefix prefix: String, in field: Field) -> Set<NSManagedObjectID> {
+        let table = tables[field.rawValue]
+        var matches = Set<NSManagedObjectID>()
+        var index = lowerBound(of: prefix, in: table)
+
+        while index < table.count, table[index].token.hasPrefix(prefix) {
+            matches.insert(table[index].objectID)
+            index += 1
+        }
+
+        return matches
+    }
+
+    // MARK: - Updates
+
+    /// Replaces the indexed value of an object in the given field, passing `nil` removes the object.
+    public func update(_ objectID: NSManagedObjectID, value: String?, in field: Field) {
+        let tokens = SearchNameIndex.tokens(for: value, in: field)
+
+        guard tokensByObjectID[field]?[objectID] != tokens else { return }
+
+        performBatchUpdates {
+            remove(objectID, from: field)
+
+            guard !tokens.isEmpty else { return }
+
+            tokensByObjectID[field, default: [:]][objectID] = tokens
+            batch?.added[field, default: [:]][objectID] = tokens
+        }
+    }
+
+    private func remove(_ objectID: NSManagedObjectID, from field: Field) {
+        performBatchUpdates {
+            guard tokensByObjectID[field]?.removeValue(forKey: objectID) != nil else { return }
+
+            batch?.removed[field, default: []].insert(objectID)
+            batch?.added[field]?.removeValue(forKey: objectID)
+        }
+    }
+
+    private func remove(_ objectID: NSManagedObjectID) {
+        Field.allCases.forEach { remove(objectID, from: $0) }
+    }
+
+    /// Runs a block updating the index, the tables are updated once when the outermost block returns.
+    private func performBatchUpdates(_ block: () -> Void) {
+        guard batch == nil else { return block() }
+
+        batch = Batch()
+        block()
+
+        if let batch = batch {
+            apply(batch)
+        }
+        self.batch = nil
+    }
+
+    /// Drops the removed entries from the tables and merges the sorted added entries in, one pass per table.
+    private func apply(_ batch: Batch) {
+        for field in Field.allCases {
+            let removed = batch.removed[field] ?? []
+            let added = (batch.added[field] ?? [:])
+                .flatMap { objectID, tokens in tokens.map { Entry(token: $0, objectID: objectID) } }
+                .sorted { $0.token < $1.token }
+
+            guard !removed.isEmpty || !added.isEmpty else { continue }
+
+            let table = tables[field.rawValue]
+            var merged: [Entry] = []
+            merged.reserveCapacity(table.count + added.count)
+            var addedIndex = 0
+
+            for entry in table where !removed.contains(entry.objectID) {
+                while addedIndex < added.count, added[addedIndex].token < entry.token {
+                    merged.append(added[addedIndex])
+                    addedIndex += 1
+                }
+                merged.append(entry)
+            }
+
+            merged.append(contentsOf: added[addedIndex...])
+            tables[field.rawValue] = merged
+        }
+    }
+
+    private func index(_ user: ZMUser) {
+        update(user.objectID, value: user.normalizedName, in: .userName)
+        update(user.objectID, value: user.handle, in: .userHandle)
+    }
+
+    private func index(_ conversation: ZMConversation) {
+        update(conversation.objectID, value: conversation.normalizedUserDefinedName, in: .conversationName)
+    }
+
+    private func objectsDidChange(_ note: Notification) {
+        let userInfo = note.userInfo ?? [:]
+
+        if userInfo[NSInvalidatedAllObjectsKey] != nil {
+            build()
+            return
+        }
+
+        performBatchUpdates {
+            var faultedObjectIDs = Set<NSManagedObjectID>()
+
+            for key in [NSInsertedObjectsKey, NSUpdatedObjectsKey, NSRefreshedObjectsKey] {
+                guard let objects = userInfo[key] as? Set<NSManagedObject> else { continue }
+
+                for object in objects where !object.objectID.isTemporaryID {
+                    switch object {
+                    case let user as ZMUser where !user.isFault:
+                        index(user)
+                    case let conversation as ZMConversation where !conversation.isFault:
+                        index(conversation)
+                    case is ZMUser, is ZMConversation:
+                        // Faults refreshed by a merge are indexed from the save of the other context
+                        if key != NSRefreshedObjectsKey {
+                            faultedObjectIDs.insert(object.objectID)
+                        }
+                    default:
+                        break
+                    }
+                }
+            }
+
+            if let objects = userInfo[NSDeletedObjectsKey] as? Set<NSManagedObject> {
+                objects.forEach { remove($0.objectID) }
+            }
+
+            reindex(faultedObjectIDs)
+        }
+    }
+
+    /// Indexes the users and conversations saved by another context of the same store, whether or not
+    /// they're registered in the index's context.
+    ///
+    /// This is called on the queue of the saving context. The object IDs are read there and indexed
+    /// on the queue of the index's context.
+    private func otherContextDidSave(_ note: Notification) {
+        guard
+            let savingContext = note.object as? NSManagedObjectContext,
+            let managedObjectContext = managedObjectContext,
+            savingContext !== managedObjectContext,
+            let coordinator = persistentStoreCoordinator,
+            savingContext.persistentStoreCoordinator === coordinator
+        else {
+            return
+        }
+
+        let userInfo = note.userInfo ?? [:]
+
+        func indexedObjectIDs(forKeys keys: [String]) -> Set<NSManagedObjectID> {
+            let objects = keys.compactMap { userInfo[$0] as? Set<NSManagedObject> }.joined()
+            return Set(objects.lazy.map(\.objectID).filter(SearchNameIndex.isIndexed))
+        }
+
+        let changed = indexedObjectIDs(forKeys: [NSInsertedObjectsKey, NSUpdatedObjectsKey])
+        let deleted = indexedObjectIDs(forKeys: [NSDeletedObjectsKey])
+
+        guard !changed.isEmpty || !deleted.isEmpty else { return }
+
+        managedObjectContext.performGroupedBlock { [weak self] in
+            self?.performBatchUpdates {
+                deleted.forEach { self?.remove($0) }
+                self?.reindex(changed)
+            }
+        }
+    }
+
+    private static func isIndexed(_ objectID: NSManagedObjectID) -> Bool {
+        let entityName = objectID.entity.name
+        return entityName == ZMUser.entityName() || entityName == ZMConversation.entityName()
+    }
+
+    /// Indexes the given objects from the store, only fetching the indexed properties. Objects with
+    /// unsaved changes in the context are skipped, those changes are indexed when they're made.
+    private func reindex(_ objectIDs: Set<NSManagedObjectID>) {
+        guard let moc = managedObjectContext, !objectIDs.isEmpty else { return }
+
+        let objectIDs = objectIDs.filter { moc.registeredObject(for: $0)?.hasChanges != true }
+        let entities: [(String, [(String, Field)])] = [(ZMUser.entityName(), SearchNameIndex.userFields),
+                                                       (ZMConversation.entityName(), SearchNameIndex.conversationFields)]
+
+        performBatchUpdates {
+            for (entityName, fields) in entities {
+                let entityObjectIDs = objectIDs.filter { $0.entity.name == entityName }
+                guard !entityObjectIDs.isEmpty else { continue }
+
+                var missing = entityObjectIDs
+                let predicate = NSPredicate(format: "SELF IN %@", Array(entityObjectIDs))
+
+                for row in fetchRows(entityName, fields: fields, predicate: predicate, in: moc) {
+                    guard let objectID = row["objectID"] as? NSManagedObjectID else { continue }
+
+                    missing.remove(objectID)
+                    fields.forEach { key, field in update(objectID, value: row[key] as? String, in: field) }
+                }
+
+                // Objects which aren't in the store anymore
+                missing.forEach { remove($0) }
+            }
+        }
+    }
+
+    // MARK: - Building
+
+    /// Populates the index from the store, only fetching the indexed properties.
+    private func build() {
+        tables = Field.allCases.map { _ in [] }
+        tokensByObjectID = [:]
+
+        guard let moc = managedObjectContext else { return }
+
+        add(ZMUser.entityName(), fields: SearchNameIndex.userFields, in: moc)
+        add(ZMConversation.entityName(), fields: SearchNameIndex.conversationFields, in: moc)
+
+        for field in Field.allCases {
+            tables[field.rawValue].sort { $0.token < $1.token }
+        }
+    }
+
+    private func add(_ entityName: String, fields: [(String, Field)], in moc: NSManagedObjectContext) {
+        for row in fetchRows(entityName, fields: fields, predicate: nil, in: moc) {
+            guard let objectID = row["objectID"] as? NSManagedObjectID else { continue }
+
+            for (key, field) in fields {
+                let tokens = SearchNameIndex.tokens(for: row[key] as? String, in: field)
+                guard !tokens.isEmpty else { continue }
+
+                tokensByObjectID[field, default: [:]][objectID] = tokens
+                tables[field.rawValue].append(contentsOf: tokens.map { Entry(token: $0, objectID: objectID) })
+            }
+        }
+    }
+
+    private func fetchRows(_ entityName: String, fields: [(String, Field)], predicate: NSPredicate?, in moc: NSManagedObjectContext) -> [NSDictionary] {
+        let objectIDExpression = NSExpressionDescription()
+        objectIDExpression.name = "objectID"
+        objectIDExpression.expression = NSExpression.expressionForEvaluatedObject()
+        objectIDExpression.expressionResultType = .objectIDAttributeType
+
+        let request = NSFetchRequest<NSDictionary>(entityName: entityName)
+        request.resultType = .dictionaryResultType
+        request.predicate = predicate
+        request.propertiesToFetch = [objectIDExpression] + fields.map(\.0)
+
+        do {
+            return try moc.fetch(request)
+        } catch {
+            zmLog.error("Failed to fetch \(entityName) for the search index: \(error)")
+            return []
+        }
+    }
+
+    // MARK: - Tokenizing
+
+    private static func tokens(for value: String?, in field: Field) -> [String] {
+        guard let value = value, !value.isEmpty else { return [] }
+
+        switch field {
+        case .userHandle:
+            return [value]
+        case .userName, .conversationName:
+            return Set(value.words.flatMap(wordBoundaryTokens)).sorted()
+        }
+    }
+
+    /// The word and each of its tails starting at a word boundary inside it, e.g. "o'neil" and "neil".
+    private static func wordBoundaryTokens(of word: String) -> [String] {
+        var tokens = [word]
+        var previous: Character?
+
+        for index in word.indices {
+            let character = word[index]
+
+            if let previous = previous, !isWordCharacter(previous), isWordCharacter(character) {
+                tokens.append(String(word[index...]))
+            }
+            previous = character
+        }
+
+        return tokens
+    }
+
+    /// The characters matched by `\w` in a regular expression.
+    private static func isWordCharacter(_ character: Character) -> Bool {
+        return character.isLetter || character.isNumber || character == "_"
+    }
+
+    private static func queryWords(_ query: String) -> [String] {
+        var words: [String] = []
+        query.enumerateSubstrings(in: query.startIndex..., options: .byWords) { substring, _, _, _ in
+            guard let substring = substring else { return }
+            words.append(substring.normalizedString() as String)
+        }
+        return words.filter { !$0.isEmpty }
+    }
+
+    private func lowerBound(of token: String, in table: [Entry]) -> Int {
+        var low = 0
+        var high = table.count
+
+        while low < high {
+            let mid = (low + high) / 2
+            if table[mid].token < token {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+
+        return low
+    }
+
+}
@@ -63,9 +63,12 @@ extension NSManagedObjectContext {
     /// Cache for large user profile image
     fileprivate let largeUserImageCache: PINCache
 
-    /// Cache for small user profile image
+    /// Cache for small user profile image, only read from to move images into the avatar store
     fileprivate let smallUserImageCache: PINCache
 
+    /// Store for small user profile images
+    fileprivate let avatarStore: AvatarSlabStore
+
     /// Create UserImageLocalCache
     /// - parameter location: where cache is persisted on disk. Defaults to caches directory if nil.
     public init(location: URL? = nil) {
@@ -81,12 +84,28 @@ extension NSManagedObjectContext {
             smallUserImageCache = PINCache(name: smallUserImageCacheName)
         }
 
+        let avatarStoreURL = (location ?? FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask)[0])
+            .appendingPathComponent("smallUserImages.slab")
+        avatarStore = AvatarSlabStore.store(for: avatarStoreURL, byteLimit: UInt64(25 * MEGABYTE), memoryCostLimit: Int(5 * MEGABYTE))
+
         largeUserImageCache.configureLimits(50 * MEGABYTE)
         smallUserImageCache.configureLimits(25 * MEGABYTE)
 
         largeUserImageCache.makeURLSecure()
         smallUserImageCache.makeURLSecure()
         super.init()
+
+        // Images dropped by the caches themselves need to be downloaded again
+        largeUserImageCache.diskCache.didRemoveObjectBlock = { [weak self] _, key, _, _ in
+            self?.notifyChange(cacheKeys: [key])
+        }
+        avatarStore.addEvictionHandler(for: self) { [weak self] keys in
+            self?.notifyChange(cacheKeys: keys)
+        }
+    }
+
+    private func notifyChange(cacheKeys: [String]?) {
+        AssetDownloadWorkIndex.notifyCacheDidChange(self, cacheKeys: cacheKeys)
     }
 
     /// Stores image in cache and returns true if the data was stored
@@ -102,14 +121,16 @@ extension NSManagedObjectContext {
     open func removeAllUserImages(_ user: ZMUser) {
         user.imageCacheKey(for: .complete).apply(largeUserImageCache.removeObject)
         user.imageCacheKey(for: .preview).apply(smallUserImageCache.removeObject)
+        user.imageCacheKey(for: .preview).apply(avatarStore.removeData)
+        notifyChange(cacheKeys: [user.imageCacheKey(for: .preview), user.imageCacheKey(for: .complete)].compactMap { $0 })
     }
 
     open func setUserImage(_ user: ZMUser, imageData: Data, size: ProfileImageSize) {
         let key = user.imageCacheKey(for: size)
         switch size {
         case .preview:
-            let stored = setImage(inCache: smallUserImageCache, cacheKey: key, data: imageData)
-            if stored {
+            if let key = key {
+                avatarStore.set(imageData, forKey: key)
                 log.info("Setting [\(user.name ?? "")] preview image [\(imageData)] cache key: \(String(describing: key))")
             }
         case .complete:
@@ -118,16 +139,22 @@ extension NSManagedObjectContext {
                 log.info("Setting [\(user.name ?? "")] complete image [\(imageData)] cache key: \(String(describing: key))")
             }
         }
+
+        if let key = key {
+            notifyChange(cacheKeys: [key])
+        }
     }
 
     open func userImage(_ user: ZMUser, size: ProfileImageSize, queue: DispatchQueue, completion: @escaping (_ imageData: Data?) -> Void) {
         guard let cacheKey = user.imageCacheKey(for: size) else { return completion(nil) }
 
-        queue.async {
-            switch size {
-            case .preview:
-                completion(self.smallUserImageCache.object(forKey: cacheKey) as? Data)
-            case .complete:
+        switch size {
+        case .preview:
+            avatarStore.data(forKey: cacheKey, queue: queue) { data in
+                completion(data ?? self.migrateSmallUserImage(forKey: cacheKey))
+            }
+        case .complete:
+            queue.async {
                 completion(self.largeUserImageCache.object(forKey: cacheKey) as? Data)
             }
         }
@@ -138,7 +165,7 @@ extension NSManagedObjectContext {
         let data: Data?
         switch size {
         case .preview:
-            data = smallUserImageCache.object(forKey: cacheKey) as? Data
+            data = avatarStore.data(forKey: cacheKey) ?? migrateSmallUserImage(forKey: cacheKey)
         case .complete:
             data = largeUserImageCache.object(forKey: cacheKey) as? Data
         }
@@ -154,17 +181,44 @@ extension NSManagedObjectContext {
 
         switch size {
         case .preview:
-            return smallUserImageCache.containsObject(forKey: cacheKey)
+            return avatarStore.contains(key: cacheKey) || smallUserImageCache.containsObject(forKey: cacheKey)
         case .complete:
             return largeUserImageCache.containsObject(forKey: cacheKey)
         }
     }
 
+    /// Loads the images of the given users into memory, e.g. for the visible range of a list.
+    /// Preview images are read in a single pass over the avatar store.
+    open func prefetch(users: [ZMUser], size: ProfileImageSize, completion: (() -> Void)? = nil) {
+        let cacheKeys = users.compactMap { $0.imageCacheKey(for: size) }
+
+        switch size {
+        case .preview:
+            avatarStore.prefetch(keys: cacheKeys, completion: completion)
+        case .complete:
+            DispatchQueue.global(qos: .userInitiated).async {
+                cacheKeys.forEach { _ = self.largeUserImageCache.object(forKey: $0) }
+                completion?()
+            }
+        }
+    }
+
+    /// Moves a preview image stored by an earlier version into the avatar store
+    private func migrateSmallUserImage(forKey cacheKey: String) -> Data? {
+        guard let data = smallUserImageCache.object(forKey: cacheKey) as? Data else { return nil }
+
+        avatarStore.set(data, forKey: cacheKey)
+        smallUserImageCache.removeObject(forKey: cacheKey)
+        return data
+    }
+
 }
 
 public extension UserImageLocalCache {
     func wipeCache() {
         smallUserImageCache.removeAllObjects()
         largeUserImageCache.removeAllObjects()
+        avatarStore.removeAll()
+        notifyChange(cacheKeys: nil)
     }
 }
@@ -28,8 +28,12 @@ extension ZMUpdateEvent {
         case .conversationClientMessageAdd,
              .conversationOtrMessageAdd,
              .conversationOtrAssetAdd:
-            let message = GenericMessage(from: self)
-            guard let messageID = message?.messageID else {
+            if let fields = genericMessageFields {
+                return fields.nonce
+            }
+
+            // External messages need to be decrypted first
+            guard let messageID = GenericMessage(from: self)?.messageID else {
                 return nil
             }
             return UUID(uuidString: messageID)
@@ -0,0 +1,376 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+@testable import WireDataModel
+
+/// Generates a large account with realistic proportions, used by the performance regression suite.
+///
+/// The generator is deterministic: the same configuration always produces the same objects, identifiers,
+/// texts and timestamps, so results of different runs can be compared. Objects are inserted in batches,
+/// the context is saved and reset after each batch to keep the memory use of large accounts bounded.
+
+struct LargeAccountFixture {
+
+    struct Configuration: Codable, Equatable {
+
+        var conversations: Int
+        var users: Int
+        var messages: Int
+        var folders: Int
+        var participantsPerConversation: Int
+
+        /// One in `reactionInterval` messages has a reaction.
+        var reactionInterval: Int
+
+        /// One in `confirmationInterval` messages sent by the self user has a delivery confirmation.
+        var confirmationInterval: Int
+
+        var seed: UInt64
+
+        /// The size of a large account in production.
+        static let full = Configuration(conversations: 10_000,
+                                        users: 100_000,
+                                        messages: 5_000_000,
+                                        folders: 20,
+                                        participantsPerConversation: 12,
+                                        reactionInterval: 10,
+                                        confirmationInterval: 4,
+                                        seed: 1)
+
+        /// A smaller account with the same proportions, quick enough to be generated on every run.
+        static let quick = Configuration(conversations: 500,
+                                         users: 5_000,
+                                         messages: 50_000,
+                                         folders: 10,
+                                         participantsPerConversation: 12,
+                                         reactionInterval: 10,
+                                         confirmationInterval: 4,
+                                         seed: 1)
+
+        /// The configuration selected by the `WIRE_PERFORMANCE_FIXTURE` environment variable, `full` or `quick` (the default).
+        static var current: Configuration {
+            return ProcessInfo.processInfo.environment["WIRE_PERFORMANCE_FIXTURE"] == "full" ? .full : .quick
+        }
+
+        /// A name which identifies the generated account, e.g. for caching it and for its baselines.
+        var identifier: String {
+            return "c\(conversations)-u\(users)-m\(messages)-f\(folders)-s\(seed)"
+        }
+
+    }
+
+    /// Words the message texts are made of, common enough for text search queries to have many results.
+    static let vocabulary = [
+        "meeting", "release", "coffee", "review", "design", "budget", "weekend", "project",
+        "update", "launch", "holiday", "lunch", "deadline", "report", "client", "feedback"
+    ]
+
+    let configuration: Configuration
+
+    /// The remote identifiers of the generated conversations, the first conversation has the most messages.
+    private(set) var conversationIdentifiers: [UUID] = []
+
+    private var generator: SeededRandomNumberGenerator
+    private let batchSize: Int
+
+    init(configuration: Configuration = .current, batchSize: Int = 5_000) {
+        self.configuration = configuration
+        self.generator = SeededRandomNumberGenerator(seed: configuration.seed)
+        self.batchSize = batchSize
+    }
+
+    // MARK: - Generation
+
+    /// Inserts the account into the context, must be called on the context's queue.
+    mutating func populate(_ context: NSManagedObjectContext) {
+        let selfUser = ZMUser.selfUser(in: context)
+        selfUser.remoteIdentifier = generator.nextUUID()
+        selfUser.name = "Self User"
+
+        let team = Team.insertNewObject(in: context)
+        team.remoteIdentifier = generator.nextUUID()
+        team.name = "Large Team"
+        Role.create(managedObjectContext: context, name: "wire_admin", team: team)
+        Role.create(managedObjectContext: context, name: "wire_member", team: team)
+        let teamID = team.objectID
+
+        saveAndReset(context)
+
+        let userIDs = insertUsers(in: context, teamID: teamID)
+        let conversations = insertConversations(in: context, teamID: teamID, userIDs: userIDs)
+        insertFolders(in: context, conversationIDs: conversations.map(\.objectID))
+        insertMessages(in: context, conversations: conversations)
+    }
+
+    private mutating func insertUsers(in context: NSManagedObjectContext, teamID: NSManagedObjectID) -> [NSManagedObjectID] {
+        var users: [ZMUser] = []
+        var userIDs: [NSManagedObjectID] = []
+
+        for index in 0..<configuration.users {
+            let user = ZMUser.insertNewObject(in: context)
+            user.remoteIdentifier = generator.nextUUID()
+            user.name = "\(generator.element(of: LargeAccountFixture.vocabulary).capitalized) User \(index)"
+            user.handle = "user\(index)"
+
+            // Half of the users are members of the self user's team.
+            if index % 2 == 0, let team = context.object(with: teamID) as? Team {
+                let member = Member.insertNewObject(in: context)
+                member.user = user
+                member.team = team
+                member.remoteIdentifier = user.remoteIdentifier
+            }
+
+            users.append(user)
+
+            if users.count == batchSize {
+                userIDs += saveAndReset(context, returningIDsOf: users)
+                users = []
+            }
+        }
+
+        userIDs += saveAndReset(context, returningIDsOf: users)
+        return userIDs
+    }
+
+    private mutating func insertConversations(in context: NSManagedObjectContext,
+                                              teamID: NSManagedObjectID,
+                                              userIDs: [NSManagedObjectID]) -> [GeneratedConversation] {
+        var generated: [GeneratedConversation] = []
+        var pending: [(ZMConversation, [ZMUser])] = []
+
+        // Conversation sizes follow a long tail, a few conversations hold most of the messages.
+        let weights = (0..<configuration.conversations).map { 1 / pow(Double($0 + 1), 0.8) }
+        let totalWeight = weights.reduce(0, +)
+        var messageCounts = weights.map { Int(Double(configuration.messages) * $0 / totalWeight) }
+        if !messageCounts.isEmpty {
+            messageCounts[0] += configuration.messages - messageCounts.reduce(0, +)
+        }
+
+        func flush() {
+            let objectIDs = saveAndReset(context, returningIDsOf: pending.map(\.0))
+            for (objectID, (_, participants)) in zip(objectIDs, pending) {
+                generated.append(GeneratedConversation(objectID: objectID,
+                                                       participantIDs: participants.map(\.objectID),
+                                                       messageCount: messageCounts[generated.count]))
+            }
+            pending = []
+        }
+
+        for index in 0..<configuration.conversations {
+            guard
+                let team = context.object(with: teamID) as? Team,
+                let memberRole = team.roles.first(where: { $0.name == "wire_member" }),
+                let adminRole = team.roles.first(where: { $0.name == "wire_admin" })
+            else {
+                fatalError("The team of the fixture is missing")
+            }
+
+            let selfUser = ZMUser.selfUser(in: context)
+            let participants = (0..<configuration.participantsPerConversation).map { _ in
+                context.object(with: generator.element(of: userIDs)) as! ZMUser
+            }
+
+            let conversation = ZMConversation.insertNewObject(in: context)
+            conversation.remoteIdentifier = generator.nextUUID()
+            conversationIdentifiers.append(conversation.remoteIdentifier!)
+
+            // One in five conversations is a one to one conversation with a connected user.
+            if index % 5 == 4, let user = participants.first {
+                conversation.conversationType = .oneOnOne
+                let connection = ZMConnection.insertNewObject(in: context)
+                connection.to = user
+                connection.status = .accepted
+                connection.conversation = conversation
+                insertParticipantRoles(for: [selfUser, user], role: memberRole, in: conversation)
+            } else {
+                conversation.conversationType = .group
+                conversation.userDefinedName = "\(generator.element(of: LargeAccountFixture.vocabulary).capitalized) \(index)"
+                conversation.team = index % 2 == 0 ? team : nil
+                conversation.teamRemoteIdentifier = conversation.team?.remoteIdentifier
+                insertParticipantRoles(for: [selfUser], role: adminRole, in: conversation)
+                insertParticipantRoles(for: participants, role: memberRole, in: conversation)
+            }
+
+            conversation.isArchived = index % 50 == 49
+            pending.append((conversation, participants))
+
+            if pending.count * configuration.participantsPerConversation >= batchSize {
+                flush()
+            }
+        }
+
+        flush()
+        return generated
+    }
+
+    private func insertParticipantRoles(for users: [ZMUser], role: Role, in conversation: ZMConversation) {
+        guard let context = conversation.managedObjectContext else { return }
+
+        for user in Set(users) {
+            let participantRole = ParticipantRole.insertNewObject(in: context)
+            participantRole.conversation = conversation
+            participantRole.user = user
+            participantRole.role = role
+        }
+    }
+
+    private mutating func insertFolders(in context: NSManagedObjectContext, conversationIDs: [NSManagedObjectID]) {
+        guard !conversationIDs.isEmpty else { return }
+
+        for index in 0..<configuration.folders {
+            let folder = Label.insertNewObject(in: context)
+            folder.remoteIdentifier = generator.nextUUID()
+            folder.kind = .folder
+            folder.name = "Folder \(index)"
+
+            let conversations = (0..<min(50, conversationIDs.count)).map { _ in
+                context.object(with: generator.element(of: conversationIDs)) as! ZMConversation
+            }
+            folder.conversations = Set(conversations)
+        }
+
+        saveAndReset(context)
+    }
+
+    private mutating func insertMessages(in context: NSManagedObjectContext, conversations: [GeneratedConversation]) {
+        let startDate = Date(timeIntervalSince1970: 1_600_000_000)
+        var pendingMessages = 0
+
+        for (index, generated) in conversations.enumerated() {
+            var conversation = context.object(with: generated.objectID) as! ZMConversation
+            var timestamp = startDate.addingTimeInterval(Double(index))
+
+            for messageIndex in 0..<generated.messageCount {
+                timestamp = timestamp.addingTimeInterval(Double(1 + generator.nextInt(below: 600)))
+
+                let selfUser = ZMUser.selfUser(in: context)
+                let sender = messageIndex % 3 == 0 ? selfUser : context.object(with: generator.element(of: generated.participantIDs)) as! ZMUser
+
+                let message = ZMClientMessage(nonce: generator.nextUUID(), managedObjectContext: context)
+                try? message.setUnderlyingMessage(GenericMessage(content: Text(content: text(for: messageIndex)), nonce: message.nonce!))
+                message.sender = sender
+                message.serverTimestamp = timestamp
+                message.visibleInConversation = conversation
+
+                if messageIndex % configuration.reactionInterval == 0 {
+                    _ = Reaction.insertReaction("❤️", users: [sender], inMessage: message)
+                }
+
+                if sender == selfUser, messageIndex % configuration.confirmationInterval == 0 {
+                    let recipient = context.object(with: generator.element(of: generated.participantIDs)) as! ZMUser
+                    _ = ZMMessageConfirmation(type: .delivered, message: message, sender: recipient, serverTimestamp: timestamp, managedObjectContext: context)
+                }
+
+                conversation.lastServerTimeStamp = timestamp
+                conversation.lastModifiedDate = timestamp
+                pendingMessages += 1
+
+                if pendingMessages == batchSize {
+                    saveAndReset(context)
+                    conversation = context.object(with: generated.objectID) as! ZMConversation
+                    pendingMessages = 0
+                }
+            }
+        }
+
+        saveAndReset(context)
+    }
+
+    private mutating func text(for index: Int) -> String {
+        let words = (0..<(3 + generator.nextInt(below: 12))).map { _ in generator.element(of: LargeAccountFixture.vocabulary) }
+
+        // Some messages contain a link, so they show up in the asset collection.
+        if index % 25 == 0 {
+            return words.joined(separator: " ") + " https://wire.com/\(index)"
+        }
+
+        return words.joined(separator: " ")
+    }
+
+    // MARK: - Helpers
+
+    @discardableResult
+    private func saveAndReset(_ context: NSManagedObjectContext, returningIDsOf objects: [NSManagedObject] = []) -> [NSManagedObjectID] {
+        if !objects.isEmpty {
+            try? context.obtainPermanentIDs(for: objects)
+        }
+
+        let objectIDs = objects.map(\.objectID)
+        context.saveOrRollback()
+        context.reset()
+        return objectIDs
+    }
+
+}
+
+extension LargeAccountFixture {
+
+    private struct GeneratedConversation {
+        let objectID: NSManagedObjectID
+        let participantIDs: [NSManagedObjectID]
+        let messageCount: Int
+    }
+
+}
+
+/// A SplitMix64 generator, which produces the same sequence for the same seed on every platform.
+struct SeededRandomNumberGenerator: RandomNumberGenerator {
+
+    private var state: UInt64
+
+    init(seed: UInt64) {
+        state = seed
+    }
+
+    mutating func next() -> UInt64 {
+        state &+= 0x9E3779B97F4A7C15
+        var value = state
+        value = (value ^ (value >> 30)) &* 0xBF58476D1CE4E5B9
+        value = (value ^ (value >> 27)) &* 0x94D049BB133111EB
+        return value ^ (value >> 31)
+    }
+
+    /// Unlike `Int.random(in:using:)`, the result doesn't depend on the standard library's implementation.
+    mutating func nextInt(below upperBound: Int) -> Int {
+        return Int(next() % UInt64(upperBound))
+    }
+
+    mutating func element<T>(of array: [T]) -> T {
+        return array[nextInt(below: array.count)]
+    }
+
+    mutating func nextUUID() -> UUID {
+        let high = next()
+        let low = next()
+        var bytes = [UInt8](repeating: 0, count: 16)
+
+        for index in 0..<8 {
+            bytes[index] = UInt8(truncatingIfNeeded: high >> (index * 8))
+            bytes[index + 8] = UInt8(truncatingIfNeeded: low >> (index * 8))
+        }
+
+        // Version 4, variant 1
+        bytes[6] = (bytes[6] & 0x0F) | 0x40
+        bytes[8] = (bytes[8] & 0x3F) | 0x80
+
+        return UUID(uuid: (bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7],
+                           bytes[8], bytes[9], bytes[10], bytes[11], bytes[12], bytes[13], bytes[14], bytes[15]))
+    }
+
+}
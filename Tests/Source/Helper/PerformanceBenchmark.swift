@@ -0,0 +1,160 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+/// Times benchmarks, writes the results as JSON and compares them against stored baselines.
+///
+/// Results are appended to `PerformanceResults.json` in the directory given by `WIRE_PERFORMANCE_RESULTS`
+/// (the temporary directory by default). Baselines are read from the file given by `WIRE_PERFORMANCE_BASELINES`,
+/// the performance scheme points it at `Tests/Resources/PerformanceBaselines.json`. They're keyed by fixture
+/// and benchmark name. A benchmark whose median is slower than its baseline by more than the tolerance fails,
+/// a benchmark without a baseline is skipped. Setting `WIRE_PERFORMANCE_RECORD_BASELINES` writes the results
+/// as new baselines.
+
+final class PerformanceBenchmark {
+
+    struct Result: Codable, Equatable {
+        let fixture: String
+        let name: String
+        let median: TimeInterval
+        let samples: [TimeInterval]
+    }
+
+    struct Baselines: Codable {
+
+        /// The allowed slow down relative to the baseline, e.g. `0.2` for 20%.
+        var tolerance: Double
+
+        /// Median durations in seconds, by fixture identifier and benchmark name.
+        var medians: [String: [String: TimeInterval]]
+
+    }
+
+    static let shared = PerformanceBenchmark()
+
+    private let environment = ProcessInfo.processInfo.environment
+    private(set) var results: [Result] = []
+
+    private var resultsURL: URL {
+        let directory = environment["WIRE_PERFORMANCE_RESULTS"].map { URL(fileURLWithPath: $0) } ?? FileManager.default.temporaryDirectory
+        return directory.appendingPathComponent("PerformanceResults.json")
+    }
+
+    private var baselinesURL: URL? {
+        return environment["WIRE_PERFORMANCE_BASELINES"].map { URL(fileURLWithPath: $0) }
+    }
+
+    private lazy var baselines: Baselines = {
+        guard
+            let url = baselinesURL,
+            let data = try? Data(contentsOf: url),
+            let baselines = try? JSONDecoder().decode(Baselines.self, from: data)
+        else {
+            return Baselines(tolerance: 0.2, medians: [:])
+        }
+
+        return baselines
+    }()
+
+    // MARK: - Measuring
+
+    /// Runs the block the given number of times and records the median duration.
+    ///
+    /// - Parameters:
+    ///     - name: The name of the benchmark, unique per fixture.
+    ///     - fixture: The identifier of the data the benchmark runs on.
+    ///     - iterations: How often the block is measured.
+    ///     - setUp: Prepares an iteration, it isn't measured.
+    ///     - block: The work to measure.
+    ///
+    /// - Throws: The errors of the blocks, or `XCTSkip` if the benchmark has no baseline to compare against.
+
+    @discardableResult
+    func measure(_ name: String,
+                 fixture: String,
+                 iterations: Int = 5,
+                 setUp: () throws -> Void = {},
+                 file: StaticString = #file,
+                 line: UInt = #line,
+                 block: () throws -> Void) throws -> Result {
+        var samples: [TimeInterval] = []
+
+        for _ in 0..<iterations {
+            try setUp()
+            let start = CFAbsoluteTimeGetCurrent()
+            try block()
+            samples.append(CFAbsoluteTimeGetCurrent() - start)
+        }
+
+        let sorted = samples.sorted()
+        let result = Result(fixture: fixture, name: name, median: sorted[sorted.count / 2], samples: samples)
+        try record(result, file: file, line: line)
+        return result
+    }
+
+    private func record(_ result: Result, file: StaticString, line: UInt) throws {
+        results.append(result)
+        writeResults()
+
+        if environment["WIRE_PERFORMANCE_RECORD_BASELINES"] != nil {
+            baselines.medians[result.fixture, default: [:]][result.name] = result.median
+            writeBaselines()
+            return
+        }
+
+        guard let baseline = baselines.medians[result.fixture]?[result.name], baseline > 0 else {
+            throw XCTSkip("\(result.name) has no baseline for \(result.fixture), record it with WIRE_PERFORMANCE_RECORD_BASELINES",
+                          file: file,
+                          line: line)
+        }
+
+        let slowdown = result.median / baseline - 1
+        if slowdown > baselines.tolerance {
+            XCTFail("\(result.name) regressed by \(Int(slowdown * 100))%: \(result.median)s, baseline \(baseline)s", file: file, line: line)
+        }
+    }
+
+    private func writeResults() {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+
+        do {
+            try encoder.encode(results).write(to: resultsURL, options: .atomic)
+        } catch {
+            XCTFail("Can't write performance results: \(error)")
+        }
+    }
+
+    private func writeBaselines() {
+        guard let url = baselinesURL else {
+            XCTFail("Can't record performance baselines, WIRE_PERFORMANCE_BASELINES isn't set")
+            return
+        }
+
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+
+        do {
+            try encoder.encode(baselines).write(to: url, options: .atomic)
+        } catch {
+            XCTFail("Can't write performance baselines: \(error)")
+        }
+    }
+
+}
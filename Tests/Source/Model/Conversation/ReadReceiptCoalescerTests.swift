@@ -0,0 +1,159 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class ReadReceiptCoalescerTests: ZMConversationTestsBase {
+
+    private func createGroupConversation(withMessagesFrom senders: [ZMUser]) -> (ZMConversation, [ZMClientMessage]) {
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.conversationType = .group
+
+        let messages: [ZMClientMessage] = senders.enumerated().map { index, sender in
+            let message = try! conversation.appendText(content: "text\(index)") as! ZMClientMessage
+            message.expectsReadConfirmation = true
+            message.sender = sender
+            return message
+        }
+
+        return (conversation, messages)
+    }
+
+    private func confirmedMessageIds(of confirmationMessage: ZMClientMessage) -> [String] {
+        guard let confirmation = confirmationMessage.underlyingMessage?.confirmation else { return [] }
+        return [confirmation.firstMessageID] + confirmation.moreMessageIds
+    }
+
+    func testThatItMergesConfirmationsOfTheSameSenderAndConversation() {
+        // given
+        let user1 = createUser()
+        let user2 = createUser()
+        let (conversation, messages) = createGroupConversation(withMessagesFrom: [user1, user2, user1])
+        let sut = uiMOC.readReceiptCoalescer
+        sut.flushDelay = 0
+
+        // when
+        sut.enqueue([messages[0]], in: conversation)
+        sut.enqueue([messages[1], messages[2]], in: conversation)
+        let confirmationMessages = sut.flush()
+
+        // then
+        XCTAssertEqual(confirmationMessages.count, 2)
+        XCTAssertEqual(Set(confirmationMessages.map(confirmedMessageIds)), [
+            [messages[0].nonce!.transportString(), messages[2].nonce!.transportString()],
+            [messages[1].nonce!.transportString()]
+        ])
+        XCTAssertEqual(sut.metrics, ReadReceiptCoalescer.Metrics(requestedConfirmations: 3,
+                                                                 coalescedConfirmations: 1,
+                                                                 sentConfirmations: 2,
+                                                                 confirmedMessages: 3))
+        XCTAssertFalse(sut.hasPendingConfirmations)
+    }
+
+    func testThatItDoesNotConfirmAMessageTwice() {
+        // given
+        let (conversation, messages) = createGroupConversation(withMessagesFrom: [createUser()])
+        let sut = uiMOC.readReceiptCoalescer
+        sut.flushDelay = 0
+
+        // when
+        sut.enqueue(messages, in: conversation)
+        sut.enqueue(messages, in: conversation)
+        let confirmationMessages = sut.flush()
+
+        // then
+        XCTAssertEqual(confirmationMessages.map(confirmedMessageIds), [[messages[0].nonce!.transportString()]])
+    }
+
+    func testThatItLeavesConfirmationsOverTheLimitForTheNextFlush() {
+        // given
+        let (conversation1, messages1) = createGroupConversation(withMessagesFrom: [createUser(), createUser()])
+        let (conversation2, messages2) = createGroupConversation(withMessagesFrom: [createUser()])
+        let sut = uiMOC.readReceiptCoalescer
+        sut.maximumConfirmationsPerFlush = 2
+        sut.flushDelay = 0
+
+        // when
+        sut.enqueue(messages1, in: conversation1)
+        sut.enqueue(messages2, in: conversation2)
+        let firstConfirmationMessages = sut.flush()
+
+        // then
+        XCTAssertEqual(firstConfirmationMessages.count, 2)
+        XCTAssertTrue(firstConfirmationMessages.allSatisfy { $0.conversation == conversation1 })
+        XCTAssertTrue(sut.hasPendingConfirmations)
+
+        // when
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then
+        XCTAssertFalse(sut.hasPendingConfirmations)
+        XCTAssertEqual(sut.metrics.sentConfirmations, 3)
+        XCTAssertEqual(conversation2.hiddenMessages.count, 1)
+    }
+
+    func testThatASaveBeforeTheFlushDoesNotAppendConfirmationsOverTheLimit() {
+        // given
+        let conversationsAndMessages = (0..<3).map { _ in createGroupConversation(withMessagesFrom: [createUser()]) }
+        let sut = uiMOC.readReceiptCoalescer
+        sut.maximumConfirmationsPerFlush = 2
+        sut.flushDelay = 0
+        conversationsAndMessages.forEach { sut.enqueue($1, in: $0) }
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertTrue(sut.hasPendingConfirmations)
+        XCTAssertEqual(sut.metrics.sentConfirmations, 0)
+
+        // when
+        let confirmationMessages = sut.flush()
+
+        // then
+        XCTAssertEqual(confirmationMessages.count, 2)
+        XCTAssertEqual(conversationsAndMessages.reduce(0) { $0 + $1.0.hiddenMessages.count }, 2)
+    }
+
+    func testThatItDefersTheLastReadTimestampUntilTheConfirmationsAreFlushed() {
+        // given
+        let (conversation, messages) = createGroupConversation(withMessagesFrom: [createUser()])
+        let lastRead = Date()
+        let sut = uiMOC.readReceiptCoalescer
+        sut.flushDelay = 0
+        sut.enqueue(messages, in: conversation)
+
+        // when
+        sut.enqueueLastRead(lastRead, of: conversation)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertNotEqual(conversation.lastReadServerTimeStamp, lastRead)
+        XCTAssertEqual(conversation.hiddenMessages.count, 0)
+
+        // when
+        sut.flush()
+
+        // then
+        XCTAssertEqual(conversation.lastReadServerTimeStamp, lastRead)
+        XCTAssertEqual(conversation.hiddenMessages.count, 1)
+        XCTAssertFalse(uiMOC.hasChanges)
+    }
+
+}
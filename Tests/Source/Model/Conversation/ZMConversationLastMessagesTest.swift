@@ -113,4 +113,156 @@ public class ZMConversationLastMessagesTest: ZMBaseManagedObjectTest {
         XCTAssertEqual(conversation.lastEditableMessage, message)
     }
 
+
+    // MARK: - Cache
+
+    private func appendText(_ text: String, to conversation: ZMConversation, sender: ZMUser? = nil) -> ZMMessage {
+        let message = try! conversation.appendText(content: text) as! ZMMessage
+        if let sender = sender {
+            message.sender = sender
+        }
+        return message
+    }
+
+    func testThatTheCachedLastMessageIsUpdatedOnAppend() {
+        // GIVEN
+        let cache = uiMOC.conversationLastMessageCache
+        cache.isVerifying = true
+        let conversation = createConversation()
+        XCTAssertNil(conversation.lastMessage)
+
+        // WHEN
+        (0...10).forEach { i in
+            _ = appendText("\(i)", to: conversation)
+            XCTAssertEqual(conversation.lastMessage?.textMessageData?.messageText, "\(i)")
+        }
+
+        // THEN
+        XCTAssertEqual(cache.mismatches, [])
+    }
+
+    func testThatTheCachedLastMessageIsUpdatedOnDeleteAndHide() {
+        // GIVEN
+        let cache = uiMOC.conversationLastMessageCache
+        cache.isVerifying = true
+        let conversation = createConversation()
+        _ = appendText("first", to: conversation)
+        let second = appendText("second", to: conversation)
+        let third = appendText("third", to: conversation)
+        XCTAssertEqual(conversation.lastMessage as? ZMMessage, third)
+
+        // WHEN
+        uiMOC.delete(third)
+
+        // THEN
+        XCTAssertEqual(conversation.lastMessage as? ZMMessage, second)
+
+        // WHEN
+        second.visibleInConversation = nil
+        second.hiddenInConversation = conversation
+
+        // THEN
+        XCTAssertEqual(conversation.lastMessage?.textMessageData?.messageText, "first")
+        XCTAssertEqual(cache.mismatches, [])
+    }
+
+    func testThatTheCachedLastMessageIsRefetchedWhenTheConversationIsCleared() {
+        // GIVEN
+        let cache = uiMOC.conversationLastMessageCache
+        cache.isVerifying = true
+        let conversation = createConversation()
+        let message = appendText("first", to: conversation)
+        XCTAssertEqual(conversation.lastMessage as? ZMMessage, message)
+
+        // WHEN
+        conversation.clearedTimeStamp = message.serverTimestamp
+        uiMOC.delete(message)
+
+        // THEN
+        XCTAssertNil(conversation.lastMessage)
+        XCTAssertEqual(cache.mismatches, [])
+    }
+
+    func testThatTheCachedLastMessageOfASenderIsUpdated() {
+        // GIVEN
+        let cache = uiMOC.conversationLastMessageCache
+        cache.isVerifying = true
+        let conversation = createConversation()
+        let selfUser = ZMUser.selfUser(in: uiMOC)
+        let otherUser = ZMUser.insertNewObject(in: uiMOC)
+        XCTAssertNil(conversation.lastMessageSent(by: otherUser))
+
+        // WHEN
+        let first = appendText("first", to: conversation, sender: otherUser)
+        let second = appendText("second", to: conversation, sender: selfUser)
+
+        // THEN
+        XCTAssertEqual(conversation.lastMessageSent(by: otherUser), first)
+        XCTAssertEqual(conversation.lastMessageSent(by: selfUser), second)
+
+        // WHEN
+        second.sender = otherUser
+
+        // THEN
+        XCTAssertEqual(conversation.lastMessageSent(by: otherUser), second)
+        XCTAssertNil(conversation.lastMessageSent(by: selfUser))
+        XCTAssertEqual(cache.mismatches, [])
+    }
+
+    func testThatItKeepsTheLastMessageOfABoundedNumberOfSenders() {
+        // GIVEN
+        let cache = uiMOC.conversationLastMessageCache
+        cache.isVerifying = true
+        let conversation = createConversation()
+        let senders = (0...ConversationLastMessageCache.maximumSendersPerConversation).map { _ in ZMUser.insertNewObject(in: uiMOC) }
+        let messages = senders.map { appendText("Hello", to: conversation, sender: $0) }
+
+        // WHEN
+        let lastMessages = senders.compactMap { conversation.lastMessageSent(by: $0) }
+
+        // THEN
+        XCTAssertEqual(lastMessages, messages)
+        XCTAssertEqual(conversation.lastMessageSent(by: senders[0]), messages[0])
+        XCTAssertEqual(cache.mismatches, [])
+    }
+
+    func testThatTheCachedLastMessageIsKeptWhenTheContextSaves() {
+        // GIVEN
+        let conversation = createConversation()
+        let message = appendText("first", to: conversation)
+        XCTAssertEqual(conversation.lastMessage as? ZMMessage, message)
+        XCTAssertTrue(message.objectID.isTemporaryID)
+
+        let recorder = InstrumentationRecorder()
+        Instrumentation.sink = recorder
+        defer { Instrumentation.sink = nil }
+
+        // WHEN
+        uiMOC.saveOrRollback()
+        recorder.reset()
+
+        // THEN
+        XCTAssertFalse(message.objectID.isTemporaryID)
+        XCTAssertEqual(conversation.lastMessage as? ZMMessage, message)
+        XCTAssertEqual(recorder.count(of: .fetches, entity: ZMMessage.entityName()), 0)
+    }
+
+    func testThatItEvictsTheLeastRecentlyReadConversations() {
+        // GIVEN
+        let cache = ConversationLastMessageCache(managedObjectContext: uiMOC, maximumEntryCount: 4)
+        cache.isVerifying = true
+        let conversations = (0..<5).map { _ in createConversation() }
+        let messages = conversations.map { appendText("Hello", to: $0) }
+
+        // WHEN
+        conversations.forEach { _ = cache.lastMessage(in: $0) }
+
+        // THEN
+        XCTAssertEqual(cache.entryCount, 3)
+        XCTAssertEqual(cache.lastMessage(in: conversations[0]), messages[0])
+        XCTAssertEqual(cache.mismatches, [])
+
+        cache.tearDown()
+    }
+
 }
@@ -36,6 +36,31 @@ class ZMConversationPerformanceTests: ZMConversationTestsBase {
         }
     }
 
+    func testPerformanceWhenReadingSortedActiveParticipants() {
+        // Given
+        let conversation = createLargeTeamGroupConversation()
+
+        measure {
+            // When
+            for _ in 0..<100 {
+                _ = conversation.sortedActiveParticipants
+            }
+        }
+    }
+
+    func testPerformanceWhenReadingDisplayName() {
+        // Given
+        let conversation = createLargeTeamGroupConversation()
+        conversation.userDefinedName = nil
+
+        measure {
+            // When
+            for _ in 0..<100 {
+                _ = conversation.displayName
+            }
+        }
+    }
+
     private func createLargeTeamGroupConversation() -> ZMConversation {
         let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC), with: .member)
 
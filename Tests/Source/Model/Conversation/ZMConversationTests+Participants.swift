@@ -615,4 +615,147 @@ final class ConversationParticipantsTests: ZMConversationTestsBase {
             XCTAssertFalse(conversation.needsToDownloadRoles)
         }
     }
+
+    // MARK: - Participant index
+
+    func testThatSortedActiveParticipantsAreUpdated_WhenParticipantsAreAddedAndRemoved() {
+        // given
+        let sut = createConversation(in: uiMOC)
+        let user1 = createUser()
+        user1.name = "Zeta"
+        let user2 = createUser()
+        user2.name = "Alpha"
+        sut.addParticipantsAndUpdateConversationState(users: [user1, user2], role: nil)
+        XCTAssertEqual(sut.sortedActiveParticipants, [user2, user1])
+
+        // when
+        let user3 = createUser()
+        user3.name = "Beta"
+        sut.addParticipantAndUpdateConversationState(user: user3, role: nil)
+
+        // then
+        XCTAssertEqual(sut.sortedActiveParticipants, [user2, user3, user1])
+        XCTAssertEqual(sut.localParticipants, [user1, user2, user3])
+
+        // when
+        sut.removeParticipantAndUpdateConversationState(user: user2)
+
+        // then
+        XCTAssertEqual(sut.sortedActiveParticipants, [user3, user1])
+        XCTAssertEqual(sut.localParticipants, [user1, user3])
+    }
+
+    func testThatSortedActiveParticipantsAndDisplayNameAreUpdated_WhenAParticipantIsRenamed() {
+        // given
+        let sut = createConversation(in: uiMOC)
+        sut.conversationType = .group
+        let user1 = createUser()
+        user1.name = "Alpha"
+        let user2 = createUser()
+        user2.name = "Beta"
+        sut.addParticipantsAndUpdateConversationState(users: [user1, user2], role: nil)
+        XCTAssertEqual(sut.sortedActiveParticipants, [user1, user2])
+        XCTAssertEqual(sut.displayName, "Alpha, Beta")
+
+        // when
+        user1.name = "Gamma"
+
+        // then
+        XCTAssertEqual(sut.sortedActiveParticipants, [user2, user1])
+        XCTAssertEqual(sut.displayName, "Beta, Gamma")
+    }
+
+    func testThatSelfMembershipIsUpdated_WhenParticipantRoleIsCreatedDirectly() {
+        // given
+        let sut = createConversation(in: uiMOC)
+        XCTAssertFalse(sut.isSelfAnActiveMember)
+
+        // when
+        let participantRole = ParticipantRole.insertNewObject(in: uiMOC)
+        participantRole.conversation = sut
+        participantRole.user = selfUser
+
+        // then
+        XCTAssertTrue(sut.isSelfAnActiveMember)
+        XCTAssertTrue(sut.localParticipants.contains(selfUser))
+    }
+
+    func testThatParticipantIndexIsUpdated_WhenParticipantRolesAreMutatedAsASet() {
+        // given
+        let sut = createConversation(in: uiMOC)
+        let user = createUser()
+        XCTAssertFalse(sut.localParticipants.contains(user))
+
+        let participantRole = ParticipantRole.insertNewObject(in: uiMOC)
+        participantRole.user = user
+
+        // when
+        sut.mutableSetValue(forKey: #keyPath(ZMConversation.participantRoles)).add(participantRole)
+
+        // then
+        XCTAssertTrue(sut.localParticipants.contains(user))
+    }
+
+    func testThatParticipantIndexMatchesParticipantRoles_AfterSaving() {
+        // given
+        let sut = createConversation(in: uiMOC)
+        let users = (0..<10).map { index -> ZMUser in
+            let user = createUser()
+            user.name = "User \(10 - index)"
+            return user
+        }
+        sut.addParticipantsAndUpdateConversationState(users: Set(users), role: nil)
+        _ = sut.sortedActiveParticipants
+
+        // when
+        sut.removeParticipantsAndUpdateConversationState(users: Set(users.prefix(3)))
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        let expected = Set(sut.participantRoles.compactMap(\.user))
+        XCTAssertEqual(sut.localParticipants, expected)
+        XCTAssertEqual(sut.sortedActiveParticipants, sut.sortedUsers(expected))
+    }
+
+    func testThatParticipantIndexEvictsTheLeastRecentlyReadConversations() {
+        // given
+        let sut = ConversationParticipantIndex(managedObjectContext: uiMOC, maximumEntryCount: 4)
+        let conversations = (0..<5).map { _ in createConversation(in: uiMOC) }
+        let first = sut.entry(for: conversations[0])
+
+        // when
+        conversations[1...3].forEach { _ = sut.entry(for: $0) }
+        XCTAssertTrue(sut.entry(for: conversations[0]) === first)
+        _ = sut.entry(for: conversations[4])
+
+        // then
+        XCTAssertEqual(sut.entryCount, 3)
+        XCTAssertTrue(sut.entry(for: conversations[0]) === first)
+        sut.tearDown()
+    }
+
+    func testThatParticipantIndexKeepsEntriesOfNewConversations_AfterSaving() {
+        // given
+        let sut = createConversation(in: uiMOC)
+        let user1 = createUser()
+        user1.name = "Alpha"
+        let user2 = createUser()
+        user2.name = "Beta"
+        sut.addParticipantsAndUpdateConversationState(users: [user1, user2], role: nil)
+        XCTAssertTrue(sut.objectID.isTemporaryID)
+        let entry = uiMOC.conversationParticipantIndex.entry(for: sut)
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertFalse(sut.objectID.isTemporaryID)
+        XCTAssertTrue(uiMOC.conversationParticipantIndex.entry(for: sut) === entry)
+
+        // when
+        user1.name = "Gamma"
+
+        // then
+        XCTAssertEqual(sut.sortedActiveParticipants, [user2, user1])
+    }
 }
@@ -0,0 +1,154 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+class ZMConversationSystemMessageCompactionTests: ZMConversationTestsBase {
+
+    private func systemMessages(in conversation: ZMConversation) -> [ZMSystemMessage] {
+        return conversation.allMessages
+            .compactMap { $0 as? ZMSystemMessage }
+            .sorted { $0.serverTimestamp! < $1.serverTimestamp! }
+    }
+
+    private func compactClients(of message: ZMSystemMessage) -> Set<UserClient> {
+        return Set(message.clients.compactMap { $0 as? UserClient })
+    }
+
+    func testThatItCompactsTeamMembersLeavingInABurst() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let users = (0..<3).map { _ in createUser() }
+        let timestamp = Date()
+
+        // when
+        for (index, user) in users.enumerated() {
+            conversation.appendTeamMemberRemovedSystemMessage(user: user, at: timestamp.addingTimeInterval(Double(index)))
+        }
+
+        // then
+        let messages = systemMessages(in: conversation)
+        XCTAssertEqual(messages.count, 1)
+        XCTAssertEqual(messages.first?.systemMessageType, .teamMemberLeave)
+        XCTAssertEqual(messages.first?.sender, users[0])
+        XCTAssertEqual(messages.first?.users, Set(users))
+        XCTAssertEqual(messages.first?.serverTimestamp, timestamp)
+    }
+
+    func testThatItSplitsABurstAtTheMaximumNumberOfEntries() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let remover = createUser()
+        let users = (0...ZMSystemMessage.maximumCompactedEntries).map { _ in createUser() }
+        let timestamp = Date()
+
+        // when
+        for user in users {
+            conversation.appendParticipantRemovedSystemMessage(user: user, sender: remover, at: timestamp)
+        }
+
+        // then
+        let messages = conversation.allMessages.compactMap { $0 as? ZMSystemMessage }
+        XCTAssertEqual(messages.count, 2)
+        XCTAssertEqual(Set(messages.map(\.users.count)), [ZMSystemMessage.maximumCompactedEntries, 1])
+        XCTAssertEqual(messages.reduce(Set<ZMUser>()) { $0.union($1.users) }, Set(users))
+    }
+
+    func testThatItDoesNotCompactEventsOutsideOfTheWindowOrAfterAnotherMessage() throws {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let timestamp = Date()
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp)
+
+        // when
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp.addingTimeInterval(ZMSystemMessage.compactionWindow + 1))
+        let textMessage = try conversation.appendText(content: "foo") as! ZMMessage
+        textMessage.serverTimestamp = timestamp.addingTimeInterval(ZMSystemMessage.compactionWindow + 2)
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp.addingTimeInterval(ZMSystemMessage.compactionWindow + 3))
+
+        // then
+        XCTAssertEqual(systemMessages(in: conversation).count, 3)
+    }
+
+    func testThatItDoesNotCompactUsersLeavingByThemselves() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let timestamp = Date()
+
+        // when
+        conversation.appendParticipantRemovedSystemMessage(user: createUser(), at: timestamp)
+        conversation.appendParticipantRemovedSystemMessage(user: createUser(), at: timestamp)
+
+        // then
+        XCTAssertEqual(systemMessages(in: conversation).count, 2)
+    }
+
+    func testThatItCompactsSessionResetsOfTheSameUser() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let user = createUser()
+        let otherUser = createUser()
+        let clients: [UserClient] = [user, user, otherUser].map {
+            let client = UserClient.insertNewObject(in: uiMOC)
+            client.user = $0
+            return client
+        }
+        let timestamp = Date()
+
+        // when
+        conversation.appendSessionResetSystemMessage(user: user, client: clients[0], at: timestamp)
+        conversation.appendSessionResetSystemMessage(user: user, client: clients[1], at: timestamp.addingTimeInterval(1))
+        conversation.appendSessionResetSystemMessage(user: otherUser, client: clients[2], at: timestamp.addingTimeInterval(2))
+
+        // then
+        let messages = systemMessages(in: conversation)
+        XCTAssertEqual(messages.count, 2)
+        XCTAssertEqual(messages.first.map(compactClients), [clients[0], clients[1]])
+        XCTAssertEqual(messages.last.map(compactClients), [clients[2]])
+    }
+
+    func testThatItAdvancesTheConversationWhenCompacting() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let timestamp = Date()
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp)
+
+        // when
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp.addingTimeInterval(10))
+
+        // then
+        XCTAssertEqual(systemMessages(in: conversation).count, 1)
+        XCTAssertEqual(conversation.lastServerTimeStamp, timestamp.addingTimeInterval(10))
+    }
+
+    func testThatItDoesNotCompactIntoAMessageThatWasRead() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let timestamp = Date()
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp)
+        conversation.lastReadServerTimeStamp = timestamp
+
+        // when
+        conversation.appendTeamMemberRemovedSystemMessage(user: createUser(), at: timestamp.addingTimeInterval(1))
+
+        // then
+        XCTAssertEqual(systemMessages(in: conversation).count, 2)
+    }
+
+}
@@ -0,0 +1,173 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class ConversationListFilterTests: ModelObjectsTests {
+
+    // MARK: - Helpers
+
+    private func createFolder(name: String) -> Label {
+        var created = false
+        let label = Label.fetchOrCreate(remoteIdentifier: UUID(), create: true, in: uiMOC, created: &created)!
+        label.kind = .folder
+        label.name = name
+        return label
+    }
+
+    private func allFilters(folders: [Label]) -> [ConversationListFilter] {
+        return [
+            .conversationsExcludingArchived(),
+            .archivedConversations(),
+            .conversationsIncludingArchived(),
+            .pendingConversations(),
+            .clearedConversations(),
+            .oneToOneConversations(),
+            .groupConversations(),
+            .labeledConversations(Label.fetchOrCreateFavoriteLabel(in: uiMOC, create: true))
+        ] + folders.map(ConversationListFilter.labeledConversations)
+    }
+
+    /// Creates conversations covering every combination of state the list predicates look at.
+    private func createConversations(count: Int, folders: [Label]) -> [ZMConversation] {
+        let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC))
+        let selfUser = ZMUser.selfUser(in: uiMOC)
+        let otherUser = ZMUser.insertNewObject(in: uiMOC)
+        let types: [ZMConversationType] = [.group, .oneOnOne, .connection, .invalid, ZMConversationType(rawValue: 1)!]
+        let statuses: [ZMConnectionStatus?] = [nil, .accepted, .pending, .ignored, .blocked, .sent, .cancelled, .blockedMissingLegalholdConsent]
+        let now = Date()
+
+        return (0..<count).map { index in
+            let conversation = ZMConversation.insertNewObject(in: uiMOC)
+            conversation.conversationType = types[index % types.count]
+            conversation.lastModifiedDate = now.addingTimeInterval(Double(index))
+            conversation.isArchived = index % 3 == 0
+
+            if let status = statuses[index % statuses.count] {
+                let connection = ZMConnection.insertNewObject(in: uiMOC)
+                connection.status = status
+                conversation.connection = connection
+            }
+
+            switch index % 4 {
+            case 1:
+                conversation.clearedTimeStamp = now
+                conversation.lastServerTimeStamp = now
+            case 2:
+                conversation.clearedTimeStamp = now
+                conversation.lastServerTimeStamp = now.addingTimeInterval(10)
+            case 3:
+                conversation.clearedTimeStamp = now
+            default:
+                break
+            }
+
+            if index % 5 == 0 {
+                conversation.team = team
+                conversation.addParticipantsAndUpdateConversationState(users: [selfUser, otherUser], role: nil)
+            }
+
+            if index % 7 == 0 {
+                conversation.userDefinedName = "Conversation \(index)"
+            }
+
+            if index % 6 == 0 {
+                conversation.isFavorite = true
+            }
+
+            if !folders.isEmpty && index % 2 == 0 {
+                conversation.moveToFolder(folders[index % folders.count])
+            }
+
+            return conversation
+        }
+    }
+
+    // MARK: - Correctness
+
+    func testThatCompiledFiltersMatchTheirPredicates() {
+        // given
+        let folders = [createFolder(name: "folder 1"), createFolder(name: "folder 2")]
+        let conversations = createConversations(count: 840, folders: folders)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        for filter in allFilters(folders: folders) {
+            for conversation in conversations {
+                XCTAssertEqual(filter.matches(conversation),
+                               filter.predicate.evaluate(with: conversation),
+                               "\(filter) disagrees for conversation of type \(conversation.conversationType.rawValue)")
+            }
+        }
+    }
+
+    func testThatFilterCreatedFromPredicateEvaluatesThePredicate() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.userDefinedName = "Foo"
+        let sut = ConversationListFilter(predicate: NSPredicate(format: "%K == %@", ZMConversationUserDefinedNameKey, "Foo"))
+
+        // then
+        XCTAssertTrue(sut.matches(conversation))
+
+        // when
+        conversation.userDefinedName = "Bar"
+
+        // then
+        XCTAssertFalse(sut.matches(conversation))
+    }
+
+    // MARK: - Performance
+
+    // Membership is evaluated for 10k conversations against the 10 lists of a typical directory
+    // (8 fixed lists and 2 folders), once through `NSPredicate` and once through the compiled filters.
+
+    func testPerformanceOfEvaluatingPredicates() {
+        // given
+        let folders = [createFolder(name: "folder 1"), createFolder(name: "folder 2")]
+        let conversations = createConversations(count: 10_000, folders: folders)
+        let predicates = allFilters(folders: folders).map(\.predicate)
+
+        measure {
+            // when
+            for predicate in predicates {
+                for conversation in conversations {
+                    _ = predicate.evaluate(with: conversation)
+                }
+            }
+        }
+    }
+
+    func testPerformanceOfEvaluatingCompiledFilters() {
+        // given
+        let folders = [createFolder(name: "folder 1"), createFolder(name: "folder 2")]
+        let conversations = createConversations(count: 10_000, folders: folders)
+        let filters = allFilters(folders: folders)
+
+        measure {
+            // when
+            for filter in filters {
+                for conversation in conversations {
+                    _ = filter.matches(conversation)
+                }
+            }
+        }
+    }
+
+}
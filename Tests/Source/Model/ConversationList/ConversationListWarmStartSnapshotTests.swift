@@ -0,0 +1,129 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class ConversationListWarmStartSnapshotTests: ZMBaseManagedObjectTest {
+
+    var fileURL: URL!
+
+    override func setUp() {
+        super.setUp()
+        fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: fileURL)
+        fileURL = nil
+        super.tearDown()
+    }
+
+    private func createGroupConversation(name: String, lastModified: Date) -> ZMConversation {
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.conversationType = .group
+        conversation.userDefinedName = name
+        conversation.lastModifiedDate = lastModified
+        return conversation
+    }
+
+    func testThatSnapshotKeepsListOrderAndDisplayFields() {
+        // given
+        let now = Date()
+        let older = createGroupConversation(name: "Older", lastModified: now)
+        let newer = createGroupConversation(name: "Newer", lastModified: now.addingTimeInterval(10))
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        uiMOC.conversationListDirectory().refetchAllLists(in: uiMOC)
+
+        // when
+        let sut = ConversationListWarmStartSnapshot(directory: uiMOC.conversationListDirectory())
+
+        // then
+        let unarchived = sut.conversations(inList: uiMOC.conversationListDirectory().unarchivedConversations.identifier)
+        XCTAssertEqual(unarchived.map(\.displayName), ["Newer", "Older"])
+        XCTAssertEqual(unarchived.map(\.objectIDURI), [newer, older].map { $0.objectID.uriRepresentation().absoluteString })
+
+        // conversations shared between lists are only stored once
+        XCTAssertEqual(sut.conversations.count, 2)
+    }
+
+    func testThatSnapshotCanBeWrittenAndRead() throws {
+        // given
+        _ = createGroupConversation(name: "Foo", lastModified: Date())
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        uiMOC.conversationListDirectory().refetchAllLists(in: uiMOC)
+        let sut = ConversationListWarmStartSnapshot(directory: uiMOC.conversationListDirectory())
+
+        // when
+        try sut.write(to: fileURL)
+
+        // then
+        XCTAssertEqual(ConversationListWarmStartSnapshot.read(from: fileURL), sut)
+    }
+
+    func testThatStoreLoadsThePersistedSnapshotAndReplacesItWhenReconciling() throws {
+        // given
+        let persisted = ConversationListWarmStartSnapshot(conversations: [], lists: ["foo": []])
+        try persisted.write(to: fileURL)
+        _ = createGroupConversation(name: "Foo", lastModified: Date())
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // when
+        let sut = ConversationListWarmStartStore(fileURL: fileURL, managedObjectContext: uiMOC)
+
+        // then
+        XCTAssertEqual(sut.snapshot, persisted)
+        XCTAssertFalse(sut.isReconciled)
+
+        // when
+        sut.reconcile()
+        sut.writeQueue.sync {}
+
+        // then
+        XCTAssertTrue(sut.isReconciled)
+        XCTAssertEqual(sut.snapshot?.conversations.map(\.displayName), ["Foo"])
+        XCTAssertEqual(ConversationListWarmStartSnapshot.read(from: fileURL), sut.snapshot)
+    }
+
+    func testThatStoreCoalescesWritesWithinTheWriteDelay() {
+        // given
+        let sut = ConversationListWarmStartStore(fileURL: fileURL, managedObjectContext: uiMOC)
+        sut.reconcile()
+        sut.writeQueue.sync {}
+        sut.writeDelay = 0.1
+        _ = createGroupConversation(name: "Foo", lastModified: Date())
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        uiMOC.conversationListDirectory().refetchAllLists(in: uiMOC)
+
+        // when
+        sut.setNeedsWrite()
+        sut.setNeedsWrite()
+
+        // then
+        XCTAssertEqual(sut.snapshot?.conversations.map(\.displayName), [])
+
+        // when
+        spinMainQueue(withTimeout: 0.5)
+        sut.writeQueue.sync {}
+
+        // then
+        XCTAssertEqual(sut.snapshot?.conversations.map(\.displayName), ["Foo"])
+        XCTAssertEqual(ConversationListWarmStartSnapshot.read(from: fileURL), sut.snapshot)
+    }
+
+}
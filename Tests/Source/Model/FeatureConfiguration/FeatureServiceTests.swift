@@ -68,6 +68,123 @@ class FeatureServiceTests: ZMBaseManagedObjectTest {
         }
     }
 
+    // MARK: - Caching
+
+    func testThatStoredFeatureIsReadFromTheCacheSharedByAllContexts() {
+        // Given
+        let appLock = Feature.AppLock(status: .disabled, config: .init(enforceAppLock: true, inactivityTimeoutSecs: 10))
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchAppLock().status, .enabled)
+
+        // When
+        syncMOC.performGroupedAndWait { context in
+            FeatureService(context: context).storeAppLock(appLock)
+            XCTAssertTrue(context.saveOrRollback())
+        }
+
+        // Then
+        XCTAssertTrue(uiMOC.featureConfigCache === syncMOC.featureConfigCache)
+        let result = FeatureService(context: uiMOC).fetchAppLock()
+        XCTAssertEqual(result.status, appLock.status)
+        XCTAssertEqual(result.config.enforceAppLock, appLock.config.enforceAppLock)
+    }
+
+    func testThatStoredFeatureIsNotPublishedBeforeItIsSaved() {
+        // Given
+        let appLock = Feature.AppLock(status: .disabled, config: .init(enforceAppLock: true, inactivityTimeoutSecs: 10))
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchAppLock().status, .enabled)
+
+        // When
+        syncMOC.performGroupedAndWait { context in
+            FeatureService(context: context).storeAppLock(appLock)
+        }
+
+        // Then
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchAppLock().status, .enabled)
+    }
+
+    func testThatStoredFeatureIsDroppedWhenTheContextRollsBack() {
+        // Given
+        let appLock = Feature.AppLock(status: .disabled, config: .init(enforceAppLock: true, inactivityTimeoutSecs: 10))
+
+        // When
+        syncMOC.performGroupedAndWait { context in
+            FeatureService(context: context).storeAppLock(appLock)
+            context.rollback()
+            XCTAssertTrue(context.saveOrRollback())
+        }
+
+        // Then
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchAppLock().status, .enabled)
+        syncMOC.performGroupedAndWait { context in
+            XCTAssertEqual(FeatureService(context: context).fetchAppLock().status, .enabled)
+        }
+    }
+
+    func testThatChangingAFeatureInvalidatesItsCachedValue() {
+        syncMOC.performGroupedAndWait { context in
+            // Given
+            let sut = FeatureService(context: context)
+            XCTAssertEqual(sut.fetchFileSharing().status, .enabled)
+
+            // When
+            Feature.fetch(name: .fileSharing, context: context)?.status = .disabled
+
+            // Then
+            XCTAssertEqual(sut.fetchFileSharing().status, .disabled)
+        }
+    }
+
+    func testThatAFeatureReadBeforeAnotherContextSavedItsChangeIsReadAgain() {
+        // Given
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchFileSharing().status, .enabled)
+
+        var saveNotification: Notification?
+        let token = NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                           object: syncMOC,
+                                                           queue: nil) { saveNotification = $0 }
+        defer { NotificationCenter.default.removeObserver(token) }
+
+        syncMOC.performGroupedAndWait { context in
+            Feature.fetch(name: .fileSharing, context: context)?.status = .disabled
+        }
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchFileSharing().status, .enabled)
+
+        // When
+        syncMOC.performGroupedAndWait { context in
+            XCTAssertTrue(context.saveOrRollback())
+        }
+        uiMOC.mergeChanges(fromContextDidSave: saveNotification!)
+
+        // Then
+        XCTAssertEqual(FeatureService(context: uiMOC).fetchFileSharing().status, .disabled)
+    }
+
+    // MARK: - Performance
+
+    private func measureAppendingSelfDeletingMessages(invalidatingCache: Bool) {
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.conversationType = .group
+        conversation.setMessageDestructionTimeoutValue(.tenSeconds, for: .selfUser)
+
+        measure {
+            for index in 0..<200 {
+                if invalidatingCache {
+                    uiMOC.featureConfigCache.invalidateAll()
+                }
+                _ = try? conversation.appendText(content: "message \(index)", fetchLinkPreview: false)
+            }
+        }
+    }
+
+    func testPerformanceOfAppendingMessagesWithCachedFeatures() {
+        measureAppendingSelfDeletingMessages(invalidatingCache: false)
+    }
+
+    /// The baseline, every append fetches and decodes the self deleting messages feature.
+    func testPerformanceOfAppendingMessagesWithoutCachedFeatures() {
+        measureAppendingSelfDeletingMessages(invalidatingCache: true)
+    }
+
 }
 
 private extension Feature.AppLock {
@@ -0,0 +1,339 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+import WireTesting
+@testable import WireDataModel
+
+/// Benchmarks the key paths of the data model on a large account stored on disk, like in production.
+///
+/// The account is generated by `LargeAccountFixture` the first time the suite runs and kept in the caches
+/// directory, each test runs on a copy of it. Results are recorded and compared to the stored baselines
+/// by `PerformanceBenchmark`.
+///
+/// The suite is skipped by the `WireDataModel` scheme and runs in the `WireDataModelPerformance` scheme,
+/// without the Core Data concurrency debugging of the unit tests.
+
+final class LargeAccountPerformanceTests: ZMTBaseTest {
+
+    private struct Manifest: Codable {
+        let configuration: LargeAccountFixture.Configuration
+        let conversationIdentifiers: [UUID]
+    }
+
+    private static let configuration = LargeAccountFixture.Configuration.current
+    private static let accountIdentifier = UUID(uuidString: "5A6F1E0C-9A1B-4C57-9F4E-2D3C4B5A6978")!
+    private static var manifest: Manifest?
+
+    private static var fixtureContainer: URL {
+        return FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first!
+            .appendingPathComponent("LargeAccountFixture")
+            .appendingPathComponent(configuration.identifier)
+    }
+
+    private static var manifestURL: URL {
+        return fixtureContainer.appendingPathComponent("manifest.json")
+    }
+
+    private var applicationContainer: URL!
+    private var coreDataStack: CoreDataStack!
+
+    private var uiMOC: NSManagedObjectContext {
+        return coreDataStack.viewContext
+    }
+
+    private var syncMOC: NSManagedObjectContext {
+        return coreDataStack.syncContext
+    }
+
+    private var fixture: String {
+        return LargeAccountPerformanceTests.configuration.identifier
+    }
+
+    private var manifest: Manifest {
+        return LargeAccountPerformanceTests.manifest!
+    }
+
+    // MARK: - Life cycle
+
+    override func setUp() {
+        super.setUp()
+
+        prepareFixtureIfNeeded()
+
+        applicationContainer = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        XCTAssertNoThrow(try FileManager.default.copyItem(at: LargeAccountPerformanceTests.fixtureContainer, to: applicationContainer))
+        coreDataStack = openStack(in: applicationContainer)
+    }
+
+    override func tearDown() {
+        closeStack(coreDataStack)
+        coreDataStack = nil
+        try? FileManager.default.removeItem(at: applicationContainer)
+        applicationContainer = nil
+        super.tearDown()
+    }
+
+    private func prepareFixtureIfNeeded() {
+        let manifestURL = LargeAccountPerformanceTests.manifestURL
+
+        if LargeAccountPerformanceTests.manifest == nil,
+           let data = try? Data(contentsOf: manifestURL),
+           let manifest = try? JSONDecoder().decode(Manifest.self, from: data),
+           manifest.configuration == LargeAccountPerformanceTests.configuration {
+            LargeAccountPerformanceTests.manifest = manifest
+        }
+
+        guard LargeAccountPerformanceTests.manifest == nil else { return }
+
+        try? FileManager.default.removeItem(at: LargeAccountPerformanceTests.fixtureContainer)
+
+        let stack = openStack(in: LargeAccountPerformanceTests.fixtureContainer)
+        var generator = LargeAccountFixture(configuration: LargeAccountPerformanceTests.configuration)
+
+        stack.syncContext.performGroupedBlockAndWait {
+            generator.populate(stack.syncContext)
+        }
+
+        closeStack(stack)
+
+        let manifest = Manifest(configuration: generator.configuration, conversationIdentifiers: generator.conversationIdentifiers)
+        XCTAssertNoThrow(try JSONEncoder().encode(manifest).write(to: manifestURL))
+        LargeAccountPerformanceTests.manifest = manifest
+    }
+
+    private func openStack(in applicationContainer: URL) -> CoreDataStack {
+        let account = Account(userName: "", userIdentifier: LargeAccountPerformanceTests.accountIdentifier)
+        let stack = CoreDataStack(account: account,
+                                  applicationContainer: applicationContainer,
+                                  inMemoryStore: false,
+                                  dispatchGroup: dispatchGroup)
+
+        stack.loadStores { error in
+            XCTAssertNil(error)
+        }
+
+        XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 60))
+        return stack
+    }
+
+    private func closeStack(_ stack: CoreDataStack) {
+        let coordinator = stack.viewContext.persistentStoreCoordinator
+        coordinator?.persistentStores.forEach { try? coordinator?.remove($0) }
+    }
+
+    // MARK: - Helpers
+
+    private func benchmark(_ name: String,
+                           iterations: Int = 5,
+                           setUp: () throws -> Void = {},
+                           file: StaticString = #file,
+                           line: UInt = #line,
+                           block: () throws -> Void) throws {
+        try PerformanceBenchmark.shared.measure(name,
+                                                fixture: fixture,
+                                                iterations: iterations,
+                                                setUp: setUp,
+                                                file: file,
+                                                line: line,
+                                                block: block)
+    }
+
+    /// The conversation with the most messages.
+    private var largestConversation: ZMConversation? {
+        return manifest.conversationIdentifiers.first.flatMap { ZMConversation.fetch(with: $0, in: uiMOC) }
+    }
+
+    // MARK: - Conversation lists
+
+    func testPerformanceOfBuildingTheConversationListDirectory() throws {
+        try benchmark("conversation list directory build", setUp: {
+            uiMOC.refreshAllObjects()
+        }, block: {
+            uiMOC.conversationListDirectory().refetchAllLists(in: uiMOC)
+        })
+    }
+
+    func testPerformanceOfDiffingTheConversationList() throws {
+        // Given
+        let conversations = (uiMOC.conversationListDirectory().unarchivedConversations as Array).compactMap { $0 as? ZMConversation }
+        XCTAssertFalse(conversations.isEmpty)
+
+        // Every tenth conversation receives a message and moves to the top of the list.
+        let moved = conversations.enumerated().filter { $0.offset % 10 == 9 }.map(\.element)
+        let reordered = moved + conversations.filter { !moved.contains($0) }
+
+        let start = OrderedSetState(array: conversations)
+        let end = OrderedSetState(array: reordered)
+
+        try benchmark("conversation list diff") {
+            let changes = ChangedIndexes(start: start, end: end, updated: Set(moved))
+            XCTAssertFalse(changes.movedIndexes.isEmpty)
+        }
+    }
+
+    // MARK: - Messages
+
+    func testPerformanceOfTextSearch() throws {
+        guard let conversation = largestConversation else { return XCTFail("No conversation") }
+
+        try benchmark("text search") {
+            let delegate = TextSearchQueryDelegateMock(expectation: expectation(description: "Search finished"))
+            let query = TextSearchQuery(conversation: conversation, query: "coffee deadline", delegate: delegate)
+            query?.execute()
+            XCTAssert(waitForCustomExpectations(withTimeout: 120))
+            XCTAssertFalse(delegate.matches.isEmpty)
+        }
+    }
+
+    func testPerformanceOfFetchingTheAssetCollection() throws {
+        guard let conversation = largestConversation else { return XCTFail("No conversation") }
+
+        try benchmark("asset collection") {
+            let delegate = AssetCollectionDelegateMock(expectation: expectation(description: "Fetching finished"))
+            let collection = AssetCollectionBatched(conversation: conversation,
+                                                    matchingCategories: [CategoryMatch(including: .link, excluding: .none)],
+                                                    delegate: delegate)
+            XCTAssert(waitForCustomExpectations(withTimeout: 120))
+            collection.tearDown()
+        }
+    }
+
+    func testPerformanceOfIngestingEvents() throws {
+        var events: [ZMUpdateEvent] = []
+        let conversationIdentifiers = Array(manifest.conversationIdentifiers.prefix(100))
+
+        try benchmark("event ingestion", setUp: {
+            events = (0..<1_000).map { index in
+                let nonce = UUID()
+                let message = GenericMessage(content: Text(content: "event \(index)"), nonce: nonce)
+                let payload: [String: Any] = [
+                    "conversation": conversationIdentifiers[index % conversationIdentifiers.count].transportString(),
+                    "from": UUID().transportString(),
+                    "time": Date().transportString(),
+                    "data": [
+                        "text": (try? message.serializedData().base64String()) ?? "",
+                        "sender": "123456789abcdef"
+                    ],
+                    "type": "conversation.otr-message-add"
+                ]
+                return ZMUpdateEvent(fromEventStreamPayload: payload as ZMTransportData, uuid: nonce)!
+            }
+        }, block: {
+            syncMOC.performGroupedBlockAndWait {
+                for event in events {
+                    _ = ZMOTRMessage.createOrUpdate(from: event, in: self.syncMOC, prefetchResult: nil)
+                }
+                self.syncMOC.saveOrRollback()
+            }
+        })
+    }
+
+    func testPerformanceOfMigratingToEncryptionAtRest() throws {
+        let encryptionKeys = validEncryptionKeys
+
+        try benchmark("encryption at rest migration", iterations: 1) {
+            syncMOC.performGroupedBlockAndWait {
+                XCTAssertNoThrow(try self.syncMOC.enableEncryptionAtRest(encryptionKeys: encryptionKeys))
+            }
+        }
+    }
+
+    // MARK: - Change notifications
+
+    func testPerformanceOfMergingAndNotifyingChanges() throws {
+        // Given
+        let dispatcher = NotificationDispatcher(managedObjectContext: uiMOC)
+        dispatcher.mergeTimeBudget = .infinity
+        defer { dispatcher.tearDown() }
+
+        let conversations = manifest.conversationIdentifiers.prefix(1_000).compactMap { ZMConversation.fetch(with: $0, in: uiMOC) }
+        let observer = ConversationObserver()
+        let tokens = conversations.map { ConversationChangeInfo.add(observer: observer, for: $0) }
+
+        var saveNotification: Notification?
+        let saveToken = NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave, object: syncMOC, queue: nil) {
+            saveNotification = $0
+        }
+        defer { NotificationCenter.default.removeObserver(saveToken) }
+
+        var iteration = 0
+
+        try benchmark("merge and notification", setUp: {
+            iteration += 1
+            let identifiers = Array(manifest.conversationIdentifiers.prefix(1_000))
+
+            syncMOC.performGroupedBlockAndWait {
+                for identifier in identifiers {
+                    ZMConversation.fetch(with: identifier, in: self.syncMOC)?.userDefinedName = "Renamed \(iteration)"
+                }
+                self.syncMOC.saveOrRollback()
+            }
+
+            observer.clearNotifications()
+        }, block: {
+            guard let note = saveNotification else { return XCTFail("No save notification") }
+            let changedObjectIDs = ((note.userInfo?[NSUpdatedObjectsKey] as? Set<NSManagedObject>) ?? []).map(\.objectID)
+
+            uiMOC.mergeChanges(fromContextDidSave: note)
+            dispatcher.didMergeChanges(Set(changedObjectIDs))
+
+            XCTAssertEqual(observer.notifications.count, conversations.count)
+        })
+
+        withExtendedLifetime(tokens) {}
+    }
+
+}
+
+// MARK: - Helper types
+
+private final class TextSearchQueryDelegateMock: TextSearchQueryDelegate {
+
+    private let expectation: XCTestExpectation
+    private(set) var matches: [ZMMessage] = []
+
+    init(expectation: XCTestExpectation) {
+        self.expectation = expectation
+    }
+
+    func textSearchQueryDidReceive(result: TextQueryResult) {
+        matches = result.matches
+
+        if !result.hasMore {
+            expectation.fulfill()
+        }
+    }
+
+}
+
+private final class AssetCollectionDelegateMock: NSObject, AssetCollectionDelegate {
+
+    private let expectation: XCTestExpectation
+
+    init(expectation: XCTestExpectation) {
+        self.expectation = expectation
+    }
+
+    func assetCollectionDidFetch(collection: ZMCollection, messages: [CategoryMatch: [ZMConversationMessage]], hasMore: Bool) {}
+
+    func assetCollectionDidFinishFetching(collection: ZMCollection, result: AssetFetchResult) {
+        expectation.fulfill()
+    }
+
+}
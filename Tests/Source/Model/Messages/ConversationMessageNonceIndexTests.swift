@@ -0,0 +1,119 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class ConversationMessageNonceIndexTests: ZMBaseManagedObjectTest {
+
+    var conversation: ZMConversation!
+
+    override func setUp() {
+        super.setUp()
+        ZMUser.selfUser(in: uiMOC).remoteIdentifier = UUID()
+        conversation = createConversation()
+        XCTAssertTrue(uiMOC.saveOrRollback())
+    }
+
+    override func tearDown() {
+        conversation = nil
+        super.tearDown()
+    }
+
+    private func createConversation() -> ZMConversation {
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.conversationType = .group
+        conversation.remoteIdentifier = UUID.create()
+        return conversation
+    }
+
+    func testThatItIndexesAppendedMessages() throws {
+        // given
+        let message = try XCTUnwrap(conversation.appendText(content: "Hello") as? ZMMessage)
+        let nonce = try XCTUnwrap(message.nonce)
+
+        // then
+        XCTAssertEqual(uiMOC.conversationMessageNonceIndex.message(withNonce: nonce, in: conversation), message)
+        XCTAssertEqual(ZMMessage.fetch(withNonce: nonce, for: conversation, in: uiMOC), message)
+    }
+
+    func testThatItKeepsFindingMessagesAfterTheyAreSaved() throws {
+        // given
+        let message = try XCTUnwrap(conversation.appendText(content: "Hello") as? ZMMessage)
+        let nonce = try XCTUnwrap(message.nonce)
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertFalse(message.objectID.isTemporaryID)
+        XCTAssertEqual(uiMOC.conversationMessageNonceIndex.message(withNonce: nonce, in: conversation), message)
+    }
+
+    func testThatItDoesNotReturnMessagesWhichMovedToAnotherConversation() throws {
+        // given
+        let message = try XCTUnwrap(conversation.appendText(content: "Hello") as? ZMMessage)
+        let nonce = try XCTUnwrap(message.nonce)
+        let otherConversation = createConversation()
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // when
+        message.visibleInConversation = otherConversation
+
+        // then
+        XCTAssertNil(uiMOC.conversationMessageNonceIndex.message(withNonce: nonce, in: conversation))
+        XCTAssertNil(ZMMessage.fetch(withNonce: nonce, for: conversation, in: uiMOC))
+        XCTAssertEqual(ZMMessage.fetch(withNonce: nonce, for: otherConversation, in: uiMOC), message)
+    }
+
+    func testThatItRemovesDeletedMessages() throws {
+        // given
+        let message = try XCTUnwrap(conversation.appendText(content: "Hello") as? ZMMessage)
+        let nonce = try XCTUnwrap(message.nonce)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let entryCount = uiMOC.conversationMessageNonceIndex.entryCount
+
+        // when
+        uiMOC.delete(message)
+        uiMOC.processPendingChanges()
+
+        // then
+        XCTAssertEqual(uiMOC.conversationMessageNonceIndex.entryCount, entryCount - 1)
+        XCTAssertNil(ZMMessage.fetch(withNonce: nonce, for: conversation, in: uiMOC))
+    }
+
+    func testThatItEvictsTheLeastRecentlyUsedConversations() throws {
+        // given
+        let sut = ConversationMessageNonceIndex(managedObjectContext: uiMOC, maximumEntryCount: 8)
+        let otherConversation = createConversation()
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        let messages = try (0..<6).map { _ in try XCTUnwrap(conversation.appendText(content: "Hello") as? ZMMessage) }
+        messages.forEach(sut.add)
+
+        // when
+        let otherMessages = try (0..<4).map { _ in try XCTUnwrap(otherConversation.appendText(content: "Hello") as? ZMMessage) }
+        otherMessages.forEach(sut.add)
+
+        // then
+        XCTAssertLessThanOrEqual(sut.entryCount, 8)
+        XCTAssertNil(sut.message(withNonce: messages[0].nonce!, in: conversation))
+        XCTAssertEqual(sut.message(withNonce: otherMessages[3].nonce!, in: otherConversation), otherMessages[3])
+    }
+
+}
@@ -0,0 +1,124 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import WireTesting
+
+@testable import WireDataModel
+
+class GenericMessageFieldsTests: BaseZMClientMessageTests {
+
+    private func scan(_ message: GenericMessage) throws -> GenericMessageFields? {
+        return GenericMessageFields(serializedData: try message.serializedData())
+    }
+
+    func testThatItReadsTheMessageIDAndContentType() throws {
+        // given
+        let nonce = UUID.create()
+        var text = Text(content: "foo")
+        text.legalHoldStatus = .enabled
+        let message = GenericMessage(content: text, nonce: nonce)
+
+        // when
+        let sut = try scan(message)
+
+        // then
+        XCTAssertEqual(sut?.nonce, nonce)
+        XCTAssertEqual(sut?.contentType, .text)
+        XCTAssertEqual(sut?.legalHoldStatus, .enabled)
+        XCTAssertEqual(sut?.isEphemeral, false)
+    }
+
+    func testThatItReadsTheLegalHoldStatusOfAllContentTypes() throws {
+        // given
+        var knock = WireProtos.Knock.with { $0.hotKnock = true }
+        knock.legalHoldStatus = .disabled
+        var location = WireProtos.Location.with { $0.latitude = 1; $0.longitude = 2 }
+        location.legalHoldStatus = .enabled
+        var reaction = WireProtos.Reaction.createReaction(emoji: "🤠", messageID: UUID.create())
+        reaction.legalHoldStatus = .enabled
+
+        // then
+        XCTAssertEqual(try scan(GenericMessage(content: knock))?.legalHoldStatus, .disabled)
+        XCTAssertEqual(try scan(GenericMessage(content: location))?.legalHoldStatus, .enabled)
+        XCTAssertEqual(try scan(GenericMessage(content: reaction))?.legalHoldStatus, .enabled)
+        XCTAssertEqual(try scan(GenericMessage(content: reaction))?.contentType, .reaction)
+    }
+
+    func testThatItReadsTheContentOfEphemeralMessages() throws {
+        // given
+        var text = Text(content: "foo")
+        text.legalHoldStatus = .disabled
+        let message = GenericMessage(content: text, nonce: UUID.create(), expiresAfterTimeInterval: 10)
+
+        // when
+        let sut = try scan(message)
+
+        // then
+        XCTAssertEqual(sut?.contentType, .ephemeral)
+        XCTAssertEqual(sut?.isEphemeral, true)
+        XCTAssertEqual(sut?.ephemeralContentType, .text)
+        XCTAssertEqual(sut?.legalHoldStatus, .disabled)
+    }
+
+    func testThatItReadsConfirmedMessageIDs() throws {
+        // given
+        let confirmed = [UUID.create(), UUID.create(), UUID.create()]
+        var confirmation = Confirmation(messageId: confirmed[0], type: .read)
+        confirmation.moreMessageIds = confirmed.dropFirst().map { $0.transportString() }
+
+        // when
+        let sut = try scan(GenericMessage(content: confirmation))
+
+        // then
+        XCTAssertEqual(sut?.contentType, .confirmation)
+        XCTAssertEqual(sut?.confirmedMessageIDs, confirmed.map { $0.transportString() })
+    }
+
+    func testThatItRejectsTruncatedData() throws {
+        // given
+        let data = try GenericMessage(content: Text(content: "foo bar baz"), nonce: UUID.create()).serializedData()
+
+        // then
+        XCTAssertNil(GenericMessageFields(serializedData: data.prefix(data.count - 3)))
+        XCTAssertNotNil(GenericMessageFields(serializedData: data))
+    }
+
+    func testThatTheMessageNonceOfAnUpdateEventIsScanned() {
+        // given
+        let nonce = UUID.create()
+        let message = GenericMessage(content: Text(content: "foo"), nonce: nonce)
+        let event = createUpdateEvent(nonce, conversationID: UUID.create(), genericMessage: message)
+
+        // then
+        XCTAssertEqual(event.genericMessageFields?.contentType, .text)
+        XCTAssertEqual(event.messageNonce, nonce)
+    }
+
+    func testPerformanceOfScanningTheMessageNonce() throws {
+        // given
+        let data = try GenericMessage(content: Text(content: String(repeating: "foo ", count: 200)), nonce: UUID.create()).serializedData()
+
+        // then
+        measure {
+            for _ in 0..<10_000 {
+                _ = GenericMessageFields(serializedData: data)?.nonce
+            }
+        }
+    }
+
+}
@@ -0,0 +1,97 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class MessageTextAnalysisTests: ZMBaseManagedObjectTest {
+
+    var conversation: ZMConversation!
+
+    override func setUp() {
+        super.setUp()
+        conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.conversationType = .group
+        conversation.remoteIdentifier = UUID.create()
+        ZMUser.selfUser(in: uiMOC).remoteIdentifier = UUID()
+    }
+
+    override func tearDown() {
+        conversation = nil
+        super.tearDown()
+    }
+
+    func testThatItFindsLinkRangesInUTF16Offsets() {
+        // given
+        let text = "👨‍👩‍👧 see https://wire.com"
+
+        // when
+        let sut = MessageTextAnalysis(text: text)
+
+        // then
+        XCTAssertEqual(sut.linkRanges.count, 1)
+        XCTAssertEqual((text as NSString).substring(with: sut.linkRanges[0]), "https://wire.com")
+        XCTAssertEqual(sut.category, [.text, .link])
+    }
+
+    func testThatTextWithoutLinksIsCategorizedAsText() {
+        // when
+        let sut = MessageTextAnalysis(text: "ramble on")
+
+        // then
+        XCTAssertFalse(sut.containsLinks)
+        XCTAssertEqual(sut.category, .text)
+        XCTAssertEqual(sut.normalizedText, "ramble on")
+    }
+
+    func testThatTheAnalysisIsReusedUntilTheTextChanges() throws {
+        // given
+        let message = try XCTUnwrap(conversation.appendText(content: "ramble on") as? ZMClientMessage)
+        let analysis = try XCTUnwrap(message.textAnalysis)
+
+        // then
+        XCTAssertTrue(message.textAnalysis === analysis)
+
+        // when
+        try message.setUnderlyingMessage(GenericMessage(content: Text(content: "ramble on https://wire.com"), nonce: message.nonce!))
+
+        // then
+        XCTAssertFalse(message.textAnalysis === analysis)
+        XCTAssertEqual(message.textAnalysis?.containsLinks, true)
+        XCTAssertEqual(message.cachedCategory, [.text, .link])
+    }
+
+    func testThatItDoesNotScheduleALinkPreviewForTextWithoutLinks() throws {
+        // when
+        let message = try XCTUnwrap(conversation.appendText(content: "ramble on") as? ZMClientMessage)
+
+        // then
+        XCTAssertEqual(message.linkPreviewState, .done)
+        XCTAssertFalse(message.needsLinkAttachmentsUpdate)
+    }
+
+    func testThatItSchedulesALinkPreviewForTextWithLinks() throws {
+        // when
+        let message = try XCTUnwrap(conversation.appendText(content: "ramble on https://wire.com") as? ZMClientMessage)
+
+        // then
+        XCTAssertEqual(message.linkPreviewState, .waitingToBeProcessed)
+        XCTAssertTrue(message.needsLinkAttachmentsUpdate)
+    }
+
+}
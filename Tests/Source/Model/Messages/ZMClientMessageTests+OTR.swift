@@ -144,6 +144,88 @@ extension ClientMessageTests_OTR {
         }
     }
 
+    func testThatMinimumPayloadSizeIsALowerBoundOfTheEncryptedPayloadSize() {
+        self.syncMOC.performGroupedBlockAndWait {
+
+            // given
+            let message = try! self.syncConversation.appendText(content: self.name) as! ZMClientMessage
+            let genericMessage = message.underlyingMessage!
+            let selfUser = ZMUser.selfUser(in: self.syncMOC)
+            let (users, _) = genericMessage.recipientUsersForMessage(in: self.syncConversation, selfUser: selfUser)
+            let recipients = users.mapToDictionary { $0.clients }
+            let plaintextSize = try! genericMessage.serializedData().count
+
+            // when
+            guard let payloadAndStrategy = genericMessage.encryptForTransport(for: self.syncConversation) else {
+                XCTFail()
+                return
+            }
+
+            // then
+            var minimumSize: UInt = 0
+            self.syncSelfClient1.keysStore.encryptionContext.perform { sessionsDirectory in
+                minimumSize = GenericMessage.minimumEncryptedPayloadSize(plaintextSize: plaintextSize,
+                                                                         recipients: recipients,
+                                                                         selfClient: self.syncSelfClient1,
+                                                                         sessionDirectory: sessionsDirectory)
+            }
+            XCTAssertGreaterThan(minimumSize, 0)
+            XCTAssertLessThanOrEqual(minimumSize, UInt(payloadAndStrategy.data.count))
+        }
+    }
+
+    func testThatMinimumPayloadSizeOnlyCountsClientsWhichGetACiphertext() {
+        self.syncMOC.performGroupedBlockAndWait {
+
+            // given
+            let plaintextSize = Int(ZMClientMessage.byteSizeExternalThreshold / 6)
+            let message = try! self.syncConversation.appendText(content: String(repeating: "a", count: plaintextSize)) as! ZMClientMessage
+            let (users, _) = message.underlyingMessage!.recipientUsersForMessage(in: self.syncConversation, selfUser: self.syncSelfUser)
+            let recipients = users.mapToDictionary { $0.clients }
+            let numberOfClients = recipients.values.reduce(0) { $0 + $1.count }
+
+            // The recipients include the self client and clients without a session, counting them would exceed the threshold
+            XCTAssertTrue(recipients[self.syncSelfUser]?.contains(self.syncSelfClient1) ?? false)
+            XCTAssertTrue(recipients[self.syncUser2]?.contains(self.syncUser2Client2) ?? false)
+            XCTAssertGreaterThan(UInt(numberOfClients * (plaintextSize + GenericMessage.minimumEncryptionOverheadPerClient)),
+                                 ZMClientMessage.byteSizeExternalThreshold)
+
+            // when
+            guard let payloadAndStrategy = message.encryptForTransport() else {
+                XCTFail()
+                return
+            }
+
+            // then
+            let createdMessage = Proteus_NewOtrMessage.with {
+                try? $0.merge(serializedData: payloadAndStrategy.data)
+            }
+            XCTAssertFalse(createdMessage.hasBlob)
+            XCTAssertLessThanOrEqual(UInt(payloadAndStrategy.data.count), ZMClientMessage.byteSizeExternalThreshold)
+        }
+    }
+
+    func testThatItGoesStraightToExternalMessageWhenMinimumPayloadSizeIsTooBig() {
+        self.syncMOC.performGroupedBlockAndWait {
+
+            // given
+            let message = try! self.syncConversation.appendText(content: self.textMessageRequiringExternalMessage(2)) as! ZMClientMessage
+
+            // when
+            guard let payloadAndStrategy = message.encryptForTransport() else {
+                XCTFail()
+                return
+            }
+
+            // then
+            let createdMessage = Proteus_NewOtrMessage.with {
+                try? $0.merge(serializedData: payloadAndStrategy.data)
+            }
+            XCTAssertTrue(createdMessage.hasBlob)
+            XCTAssertLessThan(UInt(payloadAndStrategy.data.count), ZMClientMessage.byteSizeExternalThreshold)
+        }
+    }
+
     func testThatItCreatesPayloadDataForEphemeralTextMessage_Group() {
         self.syncMOC.performGroupedBlockAndWait {
 
@@ -17,6 +17,7 @@
 //
 
 import WireTesting
+@testable import WireDataModel
 
 class ZMClientMessageTests_Reaction: BaseZMClientMessageTests {
 
@@ -141,4 +142,149 @@ extension ZMClientMessageTests_Reaction {
         XCTAssertTrue(message.cachedCategory.contains(.text))
         XCTAssertFalse(message.cachedCategory.contains(.liked))
     }
+
+    // MARK: - Summary
+
+    private func insertUsers(_ count: Int) -> [ZMUser] {
+        return (0..<count).map { _ in
+            let user = ZMUser.insertNewObject(in: uiMOC)
+            user.remoteIdentifier = .create()
+            return user
+        }
+    }
+
+    func testThatItCountsReactionsPerEmoji() {
+        // given
+        let message = insertMessage()
+        let users = insertUsers(3)
+
+        // when
+        users.forEach { message.addReaction("❤️", forUser: $0) }
+        message.addReaction("👍", forUser: users[0])
+
+        // then
+        XCTAssertEqual(message.reactionCounts, ["❤️": 2, "👍": 1])
+        XCTAssertEqual(message.reaction(of: users[0]), "👍")
+        XCTAssertEqual(message.reaction(of: users[1]), "❤️")
+        XCTAssertEqual(Set(message.usersReaction["❤️"]?.compactMap { $0 as? ZMUser } ?? []), Set(users[1...]))
+    }
+
+    func testThatItRemovesAReactionFromTheSummary() {
+        // given
+        let message = insertMessage()
+        let users = insertUsers(2)
+        users.forEach { message.addReaction("❤️", forUser: $0) }
+
+        // when
+        message.addReaction(nil, forUser: users[0])
+        message.addReaction("", forUser: users[1])
+
+        // then
+        XCTAssertEqual(message.reactionCounts, [:])
+        XCTAssertEqual(message.usersReaction.count, 0)
+    }
+
+    func testThatTheSummaryIsRebuiltAfterReactionsAreCleared() {
+        // given
+        let message = insertMessage()
+        message.addReaction("❤️", forUser: message.sender!)
+        XCTAssertEqual(message.reactionCounts, ["❤️": 1])
+
+        // when
+        message.clearAllReactions()
+
+        // then
+        XCTAssertEqual(message.reactionCounts, [:])
+
+        // when
+        message.addReaction("❤️", forUser: message.sender!)
+
+        // then
+        XCTAssertEqual(message.reactionCounts, ["❤️": 1])
+        XCTAssertEqual(message.reactions.count, 1)
+    }
+
+    func testThatTheSummaryIsRebuiltAfterReactionUsersAreMutatedAsASet() {
+        // given
+        let message = insertMessage()
+        let users = insertUsers(2)
+        message.addReaction("❤️", forUser: users[0])
+        XCTAssertEqual(message.reactionCounts, ["❤️": 1])
+
+        // when
+        message.reactions.first!.mutableSetValue(forKey: ZMReactionUsersValueKey).add(users[1])
+
+        // then
+        XCTAssertEqual(message.reactionCounts, ["❤️": 2])
+        XCTAssertEqual(message.reaction(of: users[1]), "❤️")
+    }
+
+    func testThatTheSummaryIsRebuiltAfterTheMessageIsEdited() {
+        // given
+        let message = insertMessage()
+        message.sender = ZMUser.selfUser(in: uiMOC)
+        message.markAsSent()
+        let user = insertUsers(1)[0]
+        message.addReaction("❤️", forUser: user)
+        XCTAssertEqual(message.reactionCounts, ["❤️": 1])
+
+        // when
+        message.textMessageData?.editText("JCVD, full split", mentions: [], fetchLinkPreview: false)
+
+        // then
+        XCTAssertEqual(message.reactions.count, 0)
+        XCTAssertEqual(message.reactionCounts, [:])
+        XCTAssertNil(message.reaction(of: user))
+    }
+
+    func testThatItFindsAReactionAddedBeforeTheContextWasSaved() {
+        // given
+        let message = insertMessage()
+        let users = insertUsers(2)
+        message.addReaction("❤️", forUser: users[0])
+        XCTAssertEqual(message.reactionCounts, ["❤️": 1])
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        message.addReaction("❤️", forUser: users[1])
+        message.addReaction(nil, forUser: users[0])
+
+        // then
+        XCTAssertEqual(message.reactionCounts, ["❤️": 1])
+        XCTAssertNil(message.reaction(of: users[0]))
+        XCTAssertEqual(message.reaction(of: users[1]), "❤️")
+        XCTAssertEqual(message.reactions.count, 1)
+    }
+
+    func testThatItAppliesABatchOfReactions() {
+        // given
+        let message = insertMessage()
+        let otherMessage = insertMessage()
+        let selfUser = ZMUser.selfUser(in: uiMOC)
+        selfUser.remoteIdentifier = .create()
+        let users = insertUsers(10)
+
+        var reactions = users.map { (reaction: WireProtos.Reaction.createReaction(emoji: "❤️", messageID: message.nonce!), senderID: $0.remoteIdentifier!) }
+        reactions.append((reaction: WireProtos.Reaction.createReaction(emoji: "", messageID: message.nonce!), senderID: users[0].remoteIdentifier!))
+        reactions.append((reaction: WireProtos.Reaction.createReaction(emoji: "❤️", messageID: otherMessage.nonce!), senderID: selfUser.remoteIdentifier!))
+
+        // when
+        ZMMessage.add(reactions: reactions, conversation: conversation, inContext: uiMOC)
+
+        // then
+        XCTAssertEqual(message.reactionCounts, ["❤️": 9])
+        XCTAssertEqual(otherMessage.reactionCounts, ["❤️": 1])
+        XCTAssertFalse(message.cachedCategory.contains(.liked))
+        XCTAssertTrue(otherMessage.cachedCategory.contains(.liked))
+    }
+
+    func testPerformanceOfAddingReactionsToAPopularMessage() {
+        let message = insertMessage()
+        let users = insertUsers(2_000)
+
+        measure {
+            users.forEach { message.addReaction("❤️", forUser: $0) }
+            users.forEach { message.addReaction(nil, forUser: $0) }
+        }
+    }
 }
@@ -67,7 +67,7 @@ class ZMOTRMessage_SecurityDegradationTests: BaseZMClientMessageTests {
             // THEN
             XCTAssertTrue(message.causedSecurityLevelDegradation)
             XCTAssertTrue(convo.messagesThatCausedSecurityLevelDegradation.contains(message))
-            XCTAssertTrue(self.syncMOC.zm_hasChanges)
+            XCTAssertFalse(self.syncMOC.zm_hasChanges)
 
         }
     }
@@ -114,7 +114,7 @@ class ZMOTRMessage_SecurityDegradationTests: BaseZMClientMessageTests {
             // THEN
             XCTAssertFalse(message.causedSecurityLevelDegradation)
             XCTAssertTrue(convo.messagesThatCausedSecurityLevelDegradation.isEmpty)
-            XCTAssertTrue(self.syncMOC.zm_hasChanges)
+            XCTAssertFalse(self.syncMOC.zm_hasChanges)
 
         }
     }
@@ -145,7 +145,7 @@ class ZMOTRMessage_SecurityDegradationTests: BaseZMClientMessageTests {
             // THEN
             XCTAssertFalse(message2.causedSecurityLevelDegradation)
             XCTAssertTrue(convo.messagesThatCausedSecurityLevelDegradation.isEmpty)
-            XCTAssertTrue(self.syncMOC.zm_hasChanges)
+            XCTAssertFalse(self.syncMOC.zm_hasChanges)
 
         }
     }
@@ -168,7 +168,7 @@ class ZMOTRMessage_SecurityDegradationTests: BaseZMClientMessageTests {
             XCTAssertFalse(message1.causedSecurityLevelDegradation)
             XCTAssertFalse(message2.causedSecurityLevelDegradation)
             XCTAssertTrue(convo.messagesThatCausedSecurityLevelDegradation.isEmpty)
-            XCTAssertTrue(self.syncMOC.zm_hasUserInfoChanges)
+            XCTAssertFalse(self.syncMOC.zm_hasUserInfoChanges)
         }
     }
 
@@ -194,7 +194,7 @@ class ZMOTRMessage_SecurityDegradationTests: BaseZMClientMessageTests {
             XCTAssertFalse(message1.causedSecurityLevelDegradation)
             XCTAssertFalse(message2.causedSecurityLevelDegradation)
             XCTAssertTrue(convo.messagesThatCausedSecurityLevelDegradation.isEmpty)
-            XCTAssertTrue(self.syncMOC.zm_hasUserInfoChanges)
+            XCTAssertFalse(self.syncMOC.zm_hasUserInfoChanges)
 
             XCTAssertFalse(otherConvo.messagesThatCausedSecurityLevelDegradation.isEmpty)
             XCTAssertTrue(otherMessage.causedSecurityLevelDegradation)
@@ -243,6 +243,35 @@ extension ZMOTRMessage_SecurityDegradationTests {
         XCTAssertTrue(message.causedSecurityLevelDegradation)
     }
 
+    func testThatMessageIsMarkedOnUIMOCWithoutSaving() {
+        // GIVEN
+        let convo = createConversation(moc: self.uiMOC)
+        let message = try! convo.appendText(content: "Foo") as! ZMOTRMessage
+        self.uiMOC.saveOrRollback()
+
+        // WHEN
+        self.syncMOC.performGroupedBlockAndWait {
+            let syncMessage = try! self.syncMOC.existingObject(with: message.objectID) as! ZMOTRMessage
+            syncMessage.causedSecurityLevelDegradation = true
+            XCTAssertFalse(self.syncMOC.zm_hasChanges)
+        }
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // THEN
+        XCTAssertTrue(message.causedSecurityLevelDegradation)
+        XCTAssertEqual(convo.messagesThatCausedSecurityLevelDegradation, [message])
+
+        // WHEN
+        self.syncMOC.performGroupedBlockAndWait {
+            let syncConversation = try! self.syncMOC.existingObject(with: convo.objectID) as! ZMConversation
+            syncConversation.clearMessagesThatCausedSecurityLevelDegradation()
+        }
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // THEN
+        XCTAssertFalse(message.causedSecurityLevelDegradation)
+    }
+
     func testThatItPreservesMessagesMargedOnSyncMOCAfterMerge() {
         self.syncMOC.performGroupedBlockAndWait {
             // GIVEN
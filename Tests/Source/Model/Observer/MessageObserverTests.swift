@@ -76,6 +76,7 @@ class MessageObserverTests: NotificationDispatcherTestBase {
                 #keyPath(MessageChangeInfo.linkPreviewChanged),
                 #keyPath(MessageChangeInfo.isObfuscatedChanged),
                 #keyPath(MessageChangeInfo.childMessagesChanged),
+                #keyPath(MessageChangeInfo.systemMessageUsersChanged),
                 #keyPath(MessageChangeInfo.reactionsChanged),
                 #keyPath(MessageChangeInfo.transferStateChanged),
                 #keyPath(MessageChangeInfo.confirmationsChanged),
@@ -295,6 +296,22 @@ class MessageObserverTests: NotificationDispatcherTestBase {
         )
     }
 
+    func testThatItNotifiesWhenAnEventIsCompactedIntoASystemMessage() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        let user = ZMUser.insertNewObject(in: uiMOC)
+        let otherUser = ZMUser.insertNewObject(in: uiMOC)
+        let timestamp = Date()
+        conversation.appendTeamMemberRemovedSystemMessage(user: user, at: timestamp)
+        let message = conversation.lastMessage as! ZMSystemMessage
+
+        checkThatItNotifiesTheObserverOfAChange(
+            message,
+            modifier: { _ in conversation.appendTeamMemberRemovedSystemMessage(user: otherUser, at: timestamp.addingTimeInterval(1)) },
+            expectedChangedField: #keyPath(MessageChangeInfo.systemMessageUsersChanged)
+        )
+    }
+
     func testThatItNotifiesWhenUserReadsTheMessage() {
         let conversation = ZMConversation.insertNewObject(in: self.uiMOC)
         let message = try! conversation.appendText(content: "foo") as! ZMClientMessage
@@ -566,16 +566,127 @@ class NotificationDispatcherTests: NotificationDispatcherTestBase {
         }
     }
 
+    private func renameInSyncContext(_ objectIDs: [NSManagedObjectID]) {
+        syncMOC.performGroupedBlockAndWait {
+            for objectID in objectIDs {
+                switch try? self.syncMOC.existingObject(with: objectID) {
+                case let user as ZMUser:
+                    user.name = "renamed"
+                case let conversation as ZMConversation:
+                    conversation.userDefinedName = "renamed"
+                default:
+                    XCTFail()
+                }
+            }
+            self.syncMOC.saveOrRollback()
+        }
+        XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+    }
+
+    func testThatItSlicesMergedChangesWhenTheTimeBudgetRunsOut() {
+        // given
+        let users: [ZMUser] = (0..<120).map { index in
+            let user = ZMUser.insertNewObject(in: uiMOC)
+            user.name = "user \(index)"
+            return user
+        }
+        uiMOC.saveOrRollback()
+        sut.mergeTimeBudget = 0
+
+        let observer = UserObserver()
+        withExtendedLifetime(UserChangeInfo.add(userObserver: observer, in: uiMOC)) { () -> Void in
+            renameInSyncContext(users.map(\.objectID))
+            let mergedObjectIDs = mergeLastChangesWithoutNotifying()
+            XCTAssertEqual(observer.notifications.count, 0)
+
+            // when
+            sut.didMergeChanges(Set(mergedObjectIDs))
+
+            // then
+            XCTAssertEqual(observer.notifications.count, 50)
+            XCTAssertTrue(sut.hasPendingMergedChanges)
+
+            // when
+            XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+            // then
+            XCTAssertEqual(observer.notifications.count, users.count)
+            XCTAssertEqual(Set(observer.notifications.compactMap { $0.user as? ZMUser }), Set(users))
+            XCTAssertFalse(sut.hasPendingMergedChanges)
+        }
+    }
+
+    func testThatItProcessesMergedChangesOfPrioritizedConversationsFirst() {
+        // given
+        let users: [ZMUser] = (0..<60).map { _ in ZMUser.insertNewObject(in: uiMOC) }
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        uiMOC.saveOrRollback()
+        sut.mergeTimeBudget = 0
+        sut.prioritizedConversations = [conversation.objectID]
+
+        withExtendedLifetime(ConversationChangeInfo.add(observer: conversationObserver, for: conversation)) { () -> Void in
+            renameInSyncContext(users.map(\.objectID) + [conversation.objectID])
+            let mergedObjectIDs = mergeLastChangesWithoutNotifying()
+
+            // when
+            sut.didMergeChanges(Set(mergedObjectIDs))
+
+            // then
+            XCTAssertTrue(sut.hasPendingMergedChanges)
+            XCTAssertEqual(conversationObserver.notifications.count, 1)
+            XCTAssertEqual(conversationObserver.notifications.first?.nameChanged, true)
+        }
+    }
+
+    func testThatItPostsLocalChangesAheadOfPendingMergedChanges() {
+        // given
+        let users: [ZMUser] = (0..<120).map { _ in ZMUser.insertNewObject(in: uiMOC) }
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        uiMOC.saveOrRollback()
+        sut.mergeTimeBudget = 0
+
+        withExtendedLifetime(ConversationChangeInfo.add(observer: conversationObserver, for: conversation)) { () -> Void in
+            renameInSyncContext(users.map(\.objectID))
+            sut.didMergeChanges(Set(mergeLastChangesWithoutNotifying()))
+            XCTAssertTrue(sut.hasPendingMergedChanges)
+
+            // when
+            conversation.userDefinedName = "foo"
+            uiMOC.saveOrRollback()
+
+            // then
+            XCTAssertTrue(sut.hasPendingMergedChanges)
+            XCTAssertEqual(conversationObserver.notifications.count, 1)
+            XCTAssertEqual(conversationObserver.notifications.first?.nameChanged, true)
+        }
+    }
+
+    func testThatItDiscardsPendingMergedChangesWhenDisabled() {
+        // given
+        let users: [ZMUser] = (0..<60).map { _ in ZMUser.insertNewObject(in: uiMOC) }
+        uiMOC.saveOrRollback()
+        sut.mergeTimeBudget = 0
+        users.forEach { $0.name = "foo" }
+        sut.didMergeChanges(Set(users.map(\.objectID)))
+        XCTAssertTrue(sut.hasPendingMergedChanges)
+
+        // when
+        sut.isEnabled = false
+
+        // then
+        XCTAssertFalse(sut.hasPendingMergedChanges)
+    }
+
     // MARK: - Operation Mode
 
-    func testThatItCollectsMinimalChangesWhileInEconomicalMode() {
+    func testThatItCollectsPreciseChangesWhileInEconomicalMode() {
         // Given
-        sut.operationMode = .economical
-
         let conversation = ZMConversation.insertNewObject(in: uiMOC)
         uiMOC.saveOrRollback()
         XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
 
+        sut.operationMode = .economical
+
         withExtendedLifetime(ConversationChangeInfo.add(observer: conversationObserver, for: conversation)) { () -> Void in
             // When the conversation changes
             conversation.userDefinedName = "foo"
@@ -586,12 +697,69 @@ class NotificationDispatcherTests: NotificationDispatcherTestBase {
             // Go back to normal mode to trigger notification.
             sut.operationMode = .normal
 
-            // Then there is a notification with minimal changes.
+            // Then there is a single notification with the changed keys.
+            let changeInfos = conversationObserver.notifications
+            XCTAssertEqual(changeInfos.count, 1)
+
+            guard let changeInfo = changeInfos.first else { return XCTFail() }
+            XCTAssertFalse(changeInfo.considerAllKeysChanged)
+            XCTAssertTrue(changeInfo.nameChanged)
+            XCTAssertTrue(changeInfo.mutedMessageTypesChanged)
+        }
+    }
+
+    func testThatItCollectsPreciseMergedChangesWhileInEconomicalMode() {
+        // Given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        uiMOC.saveOrRollback()
+        XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        sut.operationMode = .economical
+
+        withExtendedLifetime(ConversationChangeInfo.add(observer: conversationObserver, for: conversation)) { () -> Void in
+            // When the conversation changes in the sync context and is merged
+            syncMOC.performGroupedBlockAndWait {
+                let syncConversation = self.syncMOC.object(with: conversation.objectID) as! ZMConversation
+                syncConversation.userDefinedName = "foo"
+                self.syncMOC.saveOrRollback()
+            }
+            mergeLastChanges()
+
+            // Go back to normal mode to trigger notification.
+            sut.operationMode = .normal
+
+            // Then there is a single notification with the changed keys.
+            let changeInfos = conversationObserver.notifications
+            XCTAssertEqual(changeInfos.count, 1)
+
+            guard let changeInfo = changeInfos.first else { return XCTFail() }
+            XCTAssertFalse(changeInfo.considerAllKeysChanged)
+            XCTAssertTrue(changeInfo.nameChanged)
+            XCTAssertFalse(changeInfo.mutedMessageTypesChanged)
+        }
+    }
+
+    func testThatItReportsUnknownChangesForObjectsInsertedInEconomicalMode() {
+        // Given
+        sut.operationMode = .economical
+
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        uiMOC.saveOrRollback()
+        XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        withExtendedLifetime(ConversationChangeInfo.add(observer: conversationObserver, for: conversation)) { () -> Void in
+            // When the conversation changes
+            conversation.userDefinedName = "foo"
+            uiMOC.saveOrRollback()
+            XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+            sut.operationMode = .normal
+
+            // Then
             let changeInfos = conversationObserver.notifications
             XCTAssertEqual(changeInfos.count, 1)
 
             guard let changeInfo = changeInfos.first else { return XCTFail() }
-            XCTAssertTrue(changeInfo.changedKeys.isEmpty)
             XCTAssertTrue(changeInfo.considerAllKeysChanged)
         }
     }
@@ -623,12 +791,12 @@ class NotificationDispatcherTests: NotificationDispatcherTestBase {
 
     func testThatItOperatesNormalWhenAfterReturningToNormalMode() {
         // Given
-        sut.operationMode = .economical
-
         let conversation = ZMConversation.insertNewObject(in: uiMOC)
         uiMOC.saveOrRollback()
         XCTAssert(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
 
+        sut.operationMode = .economical
+
         withExtendedLifetime(ConversationChangeInfo.add(observer: conversationObserver, for: conversation)) { () -> Void in
             // Make some changes
             conversation.userDefinedName = "foo"
@@ -643,8 +811,8 @@ class NotificationDispatcherTests: NotificationDispatcherTestBase {
             XCTAssertEqual(changeInfos.count, 1)
 
             guard let changeInfo = changeInfos.first else { return XCTFail() }
-            XCTAssertTrue(changeInfo.changedKeys.isEmpty)
-            XCTAssertTrue(changeInfo.considerAllKeysChanged)
+            XCTAssertEqual(changeInfo.changedKeys, [#keyPath(ZMConversation.displayName)])
+            XCTAssertFalse(changeInfo.considerAllKeysChanged)
 
             conversationObserver.notifications.removeAll()
 
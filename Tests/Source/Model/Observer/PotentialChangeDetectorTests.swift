@@ -26,15 +26,32 @@ final class PotentialChangeDetectorTests: BaseZMMessageTests {
 
     // MARK: - Helpers
 
+    func createSut() -> Sut {
+        return Sut(classIdentifiers: [ZMConversation.classIdentifier], managedObjectContext: uiMOC)
+    }
+
     func createObject() -> ZMManagedObject {
         return ZMConversation.insertNewObject(in: uiMOC)
     }
 
+    func createSavedConversation() -> ZMConversation {
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        return conversation
+    }
+
+    /// A saved object turned into a fault, like objects refreshed by a merge.
+    func createFault() -> ZMManagedObject {
+        let object = createSavedConversation()
+        uiMOC.refresh(object, mergeChanges: false)
+        return object
+    }
+
     // MARK: - Tests
 
     func test_it_consumes_changes() {
         // Given
-        let sut = Sut()
+        let sut = createSut()
         sut.detectChanges(for: ModifiedObjects(inserted: [createObject()]))
 
         // When
@@ -48,7 +65,7 @@ final class PotentialChangeDetectorTests: BaseZMMessageTests {
 
     func test_it_resets() {
         // Given
-        let sut = Sut()
+        let sut = createSut()
         sut.detectChanges(for: ModifiedObjects(inserted: [createObject()]))
 
         // When
@@ -61,9 +78,9 @@ final class PotentialChangeDetectorTests: BaseZMMessageTests {
 
     func test_it_detects_modified_objects() {
         // Given
-        let sut = Sut()
-        let updatedObject = createObject()
-        let refreshedObject = createObject()
+        let sut = createSut()
+        let updatedObject = createFault()
+        let refreshedObject = createFault()
         let insertedObject = createObject()
         let deletedObject = createObject()
 
@@ -90,9 +107,9 @@ final class PotentialChangeDetectorTests: BaseZMMessageTests {
 
     func test_it_accumulates_detected_changes() {
         // Given
-        let sut = Sut()
-        let object1 = createObject()
-        let object2 = createObject()
+        let sut = createSut()
+        let object1 = createFault()
+        let object2 = createFault()
         let object3 = createObject()
         let object4 = createObject()
 
@@ -124,11 +141,10 @@ final class PotentialChangeDetectorTests: BaseZMMessageTests {
 
     func test_it_adds_changes() {
         // Given
-        let sut = Sut()
+        let sut = createSut()
         let object = createObject()
 
         // When
-        // Changed keys are irrelevant because we're only interested that there was a change.
         sut.add(changes: Changes(changedKeys: []), for: object)
 
         // Then
@@ -139,4 +155,76 @@ final class PotentialChangeDetectorTests: BaseZMMessageTests {
         XCTAssertTrue(changes[0].object === object)
     }
 
+
+    func test_it_adds_changes_with_known_keys() {
+        // Given
+        let sut = createSut()
+        let conversation = createSavedConversation()
+
+        // When
+        sut.add(changes: Changes(changedKeys: [#keyPath(ZMConversation.mutedStatus)]), for: conversation)
+
+        // Then
+        let changes = sut.consumeChanges()
+
+        XCTAssertEqual(changes.count, 1)
+        XCTAssertFalse(changes[0].considerAllKeysChanged)
+        XCTAssertEqual(changes[0].changedKeys, [#keyPath(ZMConversation.mutedStatus)])
+    }
+
+    func test_it_detects_changed_keys_of_updated_objects() {
+        // Given
+        let sut = createSut()
+        let conversation = createSavedConversation()
+
+        // When
+        conversation.userDefinedName = "foo"
+        sut.detectChanges(for: ModifiedObjects(updated: [conversation]))
+
+        // Then
+        let changes = sut.consumeChanges()
+
+        XCTAssertEqual(changes.count, 1)
+        XCTAssertTrue(changes[0].object === conversation)
+        XCTAssertFalse(changes[0].considerAllKeysChanged)
+        XCTAssertEqual(changes[0].changedKeys, [#keyPath(ZMConversation.displayName)])
+    }
+
+    func test_it_coalesces_repeated_changes_of_an_object() {
+        // Given
+        let sut = createSut()
+        let conversation = createSavedConversation()
+
+        // When
+        conversation.userDefinedName = "foo"
+        sut.detectChanges(for: ModifiedObjects(updated: [conversation]))
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        conversation.mutedMessageTypes = .all
+        sut.detectChanges(for: ModifiedObjects(updated: [conversation]))
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // Then
+        let changes = sut.consumeChanges()
+
+        XCTAssertEqual(changes.count, 1)
+        XCTAssertFalse(changes[0].considerAllKeysChanged)
+        XCTAssertTrue(changes[0].changedKeys.isSuperset(of: [#keyPath(ZMConversation.displayName), #keyPath(ZMConversation.mutedStatus)]))
+    }
+
+    func test_it_reports_unknown_changes_of_faults() {
+        // Given
+        let sut = createSut()
+        let object = createFault()
+
+        // When
+        sut.detectChanges(for: ModifiedObjects(refreshed: [object]))
+
+        // Then
+        let changes = sut.consumeChanges()
+
+        XCTAssertEqual(changes.count, 1)
+        XCTAssertTrue(changes[0].considerAllKeysChanged)
+    }
+
 }
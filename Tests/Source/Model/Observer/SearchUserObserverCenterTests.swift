@@ -35,11 +35,13 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
         let sut = SearchUserSnapshot(searchUser: searchUser, managedObjectContext: self.uiMOC)
 
         // then
-        XCTAssertEqual(searchUser.completeImageData, sut.snapshotValues[ #keyPath(ZMSearchUser.completeImageData)] as? Data)
-        XCTAssertEqual(searchUser.previewImageData, sut.snapshotValues[ #keyPath(ZMSearchUser.previewImageData)] as? Data)
-        XCTAssertEqual(searchUser.user, sut.snapshotValues[ #keyPath(ZMSearchUser.user)] as? ZMUser)
-        XCTAssertEqual(searchUser.isConnected, sut.snapshotValues[ #keyPath(ZMSearchUser.isConnected)] as? Bool)
-        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.snapshotValues[ #keyPath(ZMSearchUser.isPendingApprovalByOtherUser)] as? Bool)
+        XCTAssertEqual(sut.stamp.name, "Bernd")
+        XCTAssertNil(sut.stamp.previewImage.cacheKey)
+        XCTAssertFalse(sut.stamp.previewImage.isCached)
+        XCTAssertNil(sut.stamp.completeImage.cacheKey)
+        XCTAssertNil(sut.stamp.user)
+        XCTAssertEqual(searchUser.isConnected, sut.stamp.isConnected)
+        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.stamp.isPendingApprovalByOtherUser)
     }
 
     func testThatItCreatesASnapshotOfAllValues_withUser() {
@@ -47,6 +49,7 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
         let user = ZMUser.insertNewObject(in: uiMOC)
         user.name = "Bernd"
         user.remoteIdentifier = UUID()
+        user.previewProfileAssetIdentifier = "preview-asset"
         user.setImage(data: verySmallJPEGData(), size: .preview)
         let searchUser = ZMSearchUser(contextProvider: coreDataStack, name: "", handle: "", accentColor: .undefined, remoteIdentifier: UUID(), user: user)
 
@@ -54,11 +57,38 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
         let sut = SearchUserSnapshot(searchUser: searchUser, managedObjectContext: self.uiMOC)
 
         // then
-        XCTAssertEqual(searchUser.completeImageData, sut.snapshotValues[ #keyPath(ZMSearchUser.completeImageData)] as? Data)
-        XCTAssertEqual(searchUser.previewImageData, sut.snapshotValues[ #keyPath(ZMSearchUser.previewImageData)] as? Data)
-        XCTAssertEqual(searchUser.user, sut.snapshotValues[ #keyPath(ZMSearchUser.user)] as? ZMUser)
-        XCTAssertEqual(searchUser.isConnected, sut.snapshotValues[ #keyPath(ZMSearchUser.isConnected)] as? Bool)
-        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.snapshotValues[ #keyPath(ZMSearchUser.isPendingApprovalByOtherUser)] as? Bool)
+        XCTAssertEqual(sut.stamp.name, "Bernd")
+        XCTAssertEqual(sut.stamp.previewImage.cacheKey, user.imageCacheKey(for: .preview))
+        XCTAssertTrue(sut.stamp.previewImage.isCached)
+        XCTAssertFalse(sut.stamp.completeImage.isCached)
+        XCTAssertEqual(sut.stamp.user, user.objectID)
+        XCTAssertEqual(searchUser.isConnected, sut.stamp.isConnected)
+        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.stamp.isPendingApprovalByOtherUser)
+    }
+
+    func testThatItDoesNotReadImageDataWhenCreatingOrUpdatingTheSnapshot() {
+        // given
+        let imageCache = CountingUserImageLocalCache()
+        uiMOC.zm_userImageCache = imageCache
+
+        let user = ZMUser.insertNewObject(in: uiMOC)
+        user.name = "Bernd"
+        user.remoteIdentifier = UUID()
+        user.previewProfileAssetIdentifier = "preview-asset"
+        user.completeProfileAssetIdentifier = "complete-asset"
+        user.setImage(data: verySmallJPEGData(), size: .preview)
+        user.setImage(data: verySmallJPEGData(), size: .complete)
+        let searchUser = ZMSearchUser(contextProvider: coreDataStack, name: "", handle: "", accentColor: .undefined, remoteIdentifier: UUID(), user: user)
+
+        // when
+        let sut = SearchUserSnapshot(searchUser: searchUser, managedObjectContext: self.uiMOC)
+        user.name = "Horst"
+        sut.updateAndNotify()
+
+        // then
+        XCTAssertEqual(imageCache.imageReadCount, 0)
+        XCTAssertTrue(sut.stamp.previewImage.isCached)
+        XCTAssertTrue(sut.stamp.completeImage.isCached)
     }
 
     func testThatItPostsANotificationWhenUserImageChanged() {
@@ -90,7 +120,7 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
 
         // then
         XCTAssert(waitForCustomExpectations(withTimeout: 0.5))
-        XCTAssertEqual(searchUser.previewImageData, sut.snapshotValues[ #keyPath(ZMSearchUser.previewImageData)] as? Data)
+        XCTAssertTrue(sut.stamp.previewImage.isCached)
     }
 
     func testThatItPostsANotificationWhenConnectionChanged() {
@@ -122,7 +152,7 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
 
         // then
         XCTAssert(waitForCustomExpectations(withTimeout: 0.5))
-        XCTAssertEqual(searchUser.isConnected, sut.snapshotValues[ #keyPath(ZMSearchUser.isConnected)] as? Bool)
+        XCTAssertEqual(searchUser.isConnected, sut.stamp.isConnected)
     }
 
     func testThatItPostsANotificationWhenPendingApprovalChanged() {
@@ -155,8 +185,8 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
 
         // then
         XCTAssert(waitForCustomExpectations(withTimeout: 0.5))
-        XCTAssertEqual(searchUser.isConnected, sut.snapshotValues[ #keyPath(ZMSearchUser.isConnected)] as? Bool)
-        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.snapshotValues[ #keyPath(ZMSearchUser.isPendingApprovalByOtherUser)] as? Bool)
+        XCTAssertEqual(searchUser.isConnected, sut.stamp.isConnected)
+        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.stamp.isPendingApprovalByOtherUser)
     }
 
     func testThatItPostsANotificationWhenTheUserIsAdded() {
@@ -184,8 +214,8 @@ class SearchUserSnapshotTests: ZMBaseManagedObjectTest {
 
         // then
         XCTAssert(waitForCustomExpectations(withTimeout: 0.5))
-        XCTAssertEqual(searchUser.isConnected, sut.snapshotValues[ #keyPath(ZMSearchUser.isConnected)] as? Bool)
-        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.snapshotValues[ #keyPath(ZMSearchUser.isPendingApprovalByOtherUser)] as? Bool)
+        XCTAssertEqual(searchUser.isConnected, sut.stamp.isConnected)
+        XCTAssertEqual(searchUser.isPendingApprovalByOtherUser, sut.stamp.isPendingApprovalByOtherUser)
     }
 }
 
@@ -303,4 +333,82 @@ class SearchUserObserverCenterTests: ModelObjectsTests {
             XCTAssert(waitForCustomExpectations(withTimeout: 0.5))
         }
     }
+
+    func testThatItPostsOneBatchNotificationForSearchUserUpdates() {
+        // given
+        let searchUsers = (0..<10).map { _ in
+            ZMSearchUser(contextProvider: coreDataStack, name: "Bernd", handle: "dasBrot", accentColor: .brightOrange, remoteIdentifier: UUID())
+        }
+        searchUsers.forEach(sut.addSearchUser)
+
+        let observer = SearchUserBatchObserver()
+        let token = UserChangeInfo.add(searchUserBatchObserver: observer, in: uiMOC)
+
+        withExtendedLifetime(token) { () -> Void in
+            // when
+            searchUsers.forEach { $0.updateImageData(for: .preview, imageData: verySmallJPEGData()) }
+            XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+            // then
+            XCTAssertEqual(observer.changeInfos.count, 1)
+            XCTAssertEqual(observer.changeInfos.first?.count, searchUsers.count)
+            XCTAssertEqual(observer.changeInfos.first?.allSatisfy(\.imageSmallProfileDataChanged), true)
+        }
+    }
+
+    func testThatItOnlyPostsTheBatchNotification_WhenABatchObserverIsRegistered() {
+        // given
+        let searchUsers = (0..<10).map { _ in
+            ZMSearchUser(contextProvider: coreDataStack, name: "Bernd", handle: "dasBrot", accentColor: .brightOrange, remoteIdentifier: UUID())
+        }
+        searchUsers.forEach(sut.addSearchUser)
+
+        let batchObserver = SearchUserBatchObserver()
+        let batchToken = UserChangeInfo.add(searchUserBatchObserver: batchObserver, in: uiMOC)
+        let userObserver = UserObserver()
+        let userToken = UserChangeInfo.add(observer: userObserver, for: searchUsers[0], in: uiMOC)
+
+        var singleNotificationCount = 0
+        let notificationToken = NotificationInContext.addObserver(name: .SearchUserChange, context: uiMOC.notificationContext) { _ in
+            singleNotificationCount += 1
+        }
+
+        withExtendedLifetime([batchToken, userToken, notificationToken] as [Any?]) { () -> Void in
+            // when
+            searchUsers.forEach { $0.updateImageData(for: .preview, imageData: verySmallJPEGData()) }
+            XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+            // then
+            XCTAssertEqual(singleNotificationCount, 0)
+            XCTAssertEqual(batchObserver.changeInfos.count, 1)
+            XCTAssertEqual(userObserver.notifications.count, 1)
+            XCTAssertEqual(userObserver.notifications.first?.user as? ZMSearchUser, searchUsers[0])
+        }
+    }
+}
+
+private final class SearchUserBatchObserver: ZMSearchUserBatchObserver {
+
+    var changeInfos: [[UserChangeInfo]] = []
+
+    func searchUsersDidChange(_ changeInfos: [UserChangeInfo]) {
+        self.changeInfos.append(changeInfos)
+    }
+
+}
+
+private final class CountingUserImageLocalCache: UserImageLocalCache {
+
+    var imageReadCount = 0
+
+    override func userImage(_ user: ZMUser, size: ProfileImageSize) -> Data? {
+        imageReadCount += 1
+        return super.userImage(user, size: size)
+    }
+
+    override func userImage(_ user: ZMUser, size: ProfileImageSize, queue: DispatchQueue, completion: @escaping (Data?) -> Void) {
+        imageReadCount += 1
+        super.userImage(user, size: size, queue: queue, completion: completion)
+    }
+
 }
@@ -157,6 +157,26 @@ final class TeamTests: ZMConversationTestsBase {
         XCTAssertEqual(result, [member1, member2])
     }
 
+    func testThatMembersMatchingQueryAreSortedLikeTheSortDescriptorOnNormalizedName() {
+        // given
+        let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC), with: .member)
+        let users = ["\u{FF21}nna", "😀 Smile", "Zoe", "Émile", "emil"].map { name -> ZMUser in
+            let (user, _) = createUserAndAddMember(to: team)
+            user.name = name
+            return user
+        }
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        let sortDescriptor = NSSortDescriptor(key: "normalizedName", ascending: true)
+        let expectedUsers = (users as NSArray).sortedArray(using: [sortDescriptor]) as! [ZMUser]
+
+        // when
+        let result = team.members(matchingQuery: "")
+
+        // then
+        XCTAssertEqual(result.compactMap(\.user), expectedUsers)
+    }
+
     func testThatMembersMatchingQueryReturnCorrectMember() {
         // given
         let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC), with: .member)
@@ -212,4 +232,68 @@ final class TeamTests: ZMConversationTestsBase {
         XCTAssertEqual(result, [membership])
     }
 
+    func testThatMembersMatchingQueryCanBeReadInPages() {
+        // given
+        let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC), with: .member)
+        let members = ["Anna", "Bert", "Carl", "Dora", "Emil"].map { name -> Member in
+            let (user, member) = createUserAndAddMember(to: team)
+            user.name = name
+            return member
+        }
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(team.numberOfMembers(matchingQuery: ""), 5)
+        XCTAssertEqual(team.members(matchingQuery: "", offset: 0, limit: 2), Array(members[0..<2]))
+        XCTAssertEqual(team.members(matchingQuery: "", offset: 2, limit: 2), Array(members[2..<4]))
+        XCTAssertEqual(team.members(matchingQuery: "", offset: 4, limit: 2), [members[4]])
+        XCTAssertEqual(team.members(matchingQuery: "d", offset: 0, limit: 2), [members[3]])
+        XCTAssertEqual(team.numberOfMembers(matchingQuery: "d"), 1)
+    }
+
+    func testThatMembersMatchingQueryAreUpdatedWhenUsersAreRenamedOrRemoved() {
+        // given
+        let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC), with: .member)
+        let (user1, member1) = createUserAndAddMember(to: team)
+        let (user2, member2) = createUserAndAddMember(to: team)
+        user1.name = "Abacus Allison"
+        user2.name = "Zygfried Watson"
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        XCTAssertEqual(team.members(matchingQuery: ""), [member1, member2])
+
+        // when
+        user1.name = "Zyta Allison"
+        user2.name = "Brian Watson"
+
+        // then
+        XCTAssertEqual(team.members(matchingQuery: ""), [member2, member1])
+
+        // when
+        uiMOC.delete(member2)
+        uiMOC.processPendingChanges()
+
+        // then
+        XCTAssertEqual(team.members(matchingQuery: ""), [member1])
+        XCTAssertEqual(team.numberOfMembers(matchingQuery: ""), 1)
+    }
+
+    func testThatMembersMatchingQueryAreKeptWhenUnsavedMembersAreSaved() {
+        // given
+        let (team, _) = createTeamAndMember(for: .selfUser(in: uiMOC), with: .member)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let (user1, member1) = createUserAndAddMember(to: team)
+        let (user2, member2) = createUserAndAddMember(to: team)
+        user1.name = "Abacus Allison"
+        user2.name = "Zygfried Watson"
+        XCTAssertEqual(team.members(matchingQuery: "", offset: 1, limit: 1), [member2])
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(team.members(matchingQuery: "", offset: 1, limit: 1), [member2])
+        XCTAssertEqual(team.members(matchingQuery: "abacus"), [member1])
+        XCTAssertEqual(team.numberOfMembers(matchingQuery: ""), 2)
+    }
+
 }
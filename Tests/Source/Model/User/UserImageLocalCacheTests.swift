@@ -146,6 +146,36 @@ extension UserImageLocalCacheTests {
 
 }
 
+// MARK: - Prefetching
+extension UserImageLocalCacheTests {
+
+    func testThatPrefetchedPreviewImagesCanBeRetrieved() {
+        // given
+        let users: [ZMUser] = (0..<5).map { _ in
+            let user = ZMUser.insertNewObject(in: self.uiMOC)
+            user.remoteIdentifier = UUID.create()
+            user.setV3PictureIdentifiers()
+            return user
+        }
+        users.forEach { sut.setUserImage($0, imageData: Data($0.remoteIdentifier!.transportString().utf8), size: .preview) }
+        sut = UserImageLocalCache(location: nil)
+
+        // when
+        let prefetched = expectation(description: "prefetched")
+        sut.prefetch(users: users, size: .preview) {
+            prefetched.fulfill()
+        }
+
+        // then
+        XCTAssertTrue(waitForCustomExpectations(withTimeout: 0.5))
+        users.forEach {
+            XCTAssertTrue(sut.hasUserImage($0, size: .preview))
+            XCTAssertEqual(sut.userImage($0, size: .preview), Data($0.remoteIdentifier!.transportString().utf8))
+        }
+    }
+
+}
+
 // MARK: - Removal
 extension UserImageLocalCacheTests {
     func testThatItRemovesAllImagesFromCache() {
@@ -488,6 +488,178 @@ extension ZMUserTests_Permissions {
         XCTAssertFalse(ZMUser.selfUser(in: uiMOC).canModifyAccessControlSettings(in: conversation))
     }
 
+    // MARK: Cached permissions
+
+    func testThatCachedPermissionIsUpdated_WhenRoleActionsChange() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+        XCTAssertFalse(selfUser.canAddUser(to: conversation))
+
+        // when
+        let role = selfUser.role(in: conversation)!
+        let action = Action.insertNewObject(in: uiMOC)
+        action.name = "add_conversation_member"
+        role.actions.insert(action)
+
+        // then
+        XCTAssertTrue(selfUser.canAddUser(to: conversation))
+    }
+
+    func testThatCachedPermissionIsUpdated_WhenRoleActionsAreMutatedAsASet() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        XCTAssertFalse(selfUser.canAddUser(to: conversation))
+
+        // when
+        let action = Action.insertNewObject(in: uiMOC)
+        action.name = "add_conversation_member"
+        selfUser.role(in: conversation)!.mutableSetValue(forKey: Role.actionsKey).add(action)
+
+        // then
+        XCTAssertTrue(selfUser.canAddUser(to: conversation))
+    }
+
+    func testThatCachedPermissionIsUpdated_WhenRoleActionsChangeInAnotherContext() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        XCTAssertFalse(selfUser.canAddUser(to: conversation))
+        let roleID = selfUser.role(in: conversation)!.objectID
+
+        var saveNotification: Notification?
+        let token = NotificationCenter.default.addObserver(forName: .NSManagedObjectContextDidSave,
+                                                           object: syncMOC,
+                                                           queue: nil) { saveNotification = $0 }
+
+        // when
+        syncMOC.performGroupedBlockAndWait {
+            let action = Action.insertNewObject(in: self.syncMOC)
+            action.name = "add_conversation_member"
+            action.role = self.syncMOC.object(with: roleID) as! Role
+            XCTAssertTrue(self.syncMOC.saveOrRollback())
+        }
+        NotificationCenter.default.removeObserver(token)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+        uiMOC.mergeChanges(fromContextDidSave: saveNotification!)
+
+        // then
+        XCTAssertTrue(selfUser.canAddUser(to: conversation))
+    }
+
+    func testThatCachedPermissionIsUpdated_WhenParticipantRoleChanges() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+
+        // when
+        let memberRole = Role.insertNewObject(in: uiMOC)
+        memberRole.name = "wire_member"
+        selfUser.participantRoles.first?.role = memberRole
+
+        // then
+        XCTAssertFalse(selfUser.canModifyTitle(in: conversation))
+    }
+
+    func testThatCachedPermissionIsUpdated_WhenSelfUserLeaves() {
+        // given
+        conversation.conversationType = .group
+        conversation.addParticipantAndUpdateConversationState(user: selfUser, role: createRole(with: "modify_conversation_name"))
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+
+        // when
+        conversation.removeParticipantAndUpdateConversationState(user: selfUser)
+
+        // then
+        XCTAssertFalse(selfUser.canModifyTitle(in: conversation))
+    }
+
+    func testThatCachedPermissionIsKept_WhenAMessageIsAppended() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+
+        // when
+        try! conversation.appendText(content: "Hello")
+        uiMOC.processPendingChanges()
+        // Changing the primitive value doesn't notify the cache, a cached mask stays stale
+        selfUser.role(in: conversation)!.setPrimitiveValue(Set<Action>(), forKey: Role.actionsKey)
+
+        // then
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+    }
+
+    func testThatCachedPermissionIsKept_WhenTheActionsOfAnotherRoleChange() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        let otherConversation = ZMConversation.insertNewObject(in: uiMOC)
+        otherConversation.remoteIdentifier = .create()
+        otherConversation.conversationType = .group
+        otherConversation.addParticipantAndUpdateConversationState(user: selfUser, role: createRole(with: "modify_conversation_name"))
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+        XCTAssertTrue(selfUser.canModifyTitle(in: otherConversation))
+        XCTAssertFalse(selfUser.canAddUser(to: conversation))
+
+        // when
+        selfUser.role(in: otherConversation)!.setPrimitiveValue(Set<Action>(), forKey: Role.actionsKey)
+        let action = Action.insertNewObject(in: uiMOC)
+        action.name = "add_conversation_member"
+        selfUser.role(in: conversation)!.actions.insert(action)
+        uiMOC.processPendingChanges()
+
+        // then
+        XCTAssertTrue(selfUser.canAddUser(to: conversation))
+        XCTAssertTrue(selfUser.canModifyTitle(in: otherConversation))
+    }
+
+    func testThatCachedPermissionsUnderTemporaryIDsAreDropped_WhenTheContextSaves() {
+        // given
+        conversation.conversationType = .group
+        createARoleForSelfUserWith("modify_conversation_name")
+        XCTAssertTrue(selfUser.canModifyTitle(in: conversation))
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        selfUser.role(in: conversation)!.setPrimitiveValue(Set<Action>(), forKey: Role.actionsKey)
+
+        // then
+        XCTAssertFalse(selfUser.canModifyTitle(in: conversation))
+    }
+
+    func testPerformanceOfRepeatedPermissionChecks() {
+        // given
+        conversation.conversationType = .group
+        let users = (0..<200).map { _ in ZMUser.insertNewObject(in: uiMOC) }
+        conversation.addParticipantsAndUpdateConversationState(users: Set(users), role: createRole(with: "add_conversation_member"))
+        createARoleForSelfUserWith("modify_conversation_name")
+
+        measure {
+            // when
+            for _ in 0..<1_000 {
+                _ = selfUser.canModifyTitle(in: conversation)
+                _ = selfUser.canAddUser(to: conversation)
+                _ = selfUser.canRemoveUser(from: conversation)
+                _ = selfUser.canModifyReadReceiptSettings(in: conversation)
+            }
+        }
+    }
+
+    private func createRole(with actionName: String) -> Role {
+        let action = Action.insertNewObject(in: uiMOC)
+        action.name = actionName
+
+        let role = Role.insertNewObject(in: uiMOC)
+        role.name = defaultAdminRoleName
+        role.actions = Set([action])
+        return role
+    }
+
     private func createARoleForSelfUserWith(_ actionName: String) {
         let participantRole = ParticipantRole.insertNewObject(in: uiMOC)
         participantRole.conversation = conversation
@@ -783,6 +783,65 @@ extension ZMUserTests_Swift {
         XCTAssertEqual(recipients, Set(expectedRecipients))
     }
 
+    func testThatTheBroadcastRosterInsertsTeamMembersJoiningAConversationWithTheSelfUser() {
+        // given
+        let selfUserTeam = createTeam(in: uiMOC)
+        createMembership(in: uiMOC, user: selfUser, team: selfUserTeam)
+
+        let (teamUser1, _) = createUserAndAddMember(to: selfUserTeam)
+        let (teamUser2, _) = createUserAndAddMember(to: selfUserTeam)
+        let (teamUser3, _) = createUserAndAddMember(to: selfUserTeam)
+
+        let conversation = createConversation(in: uiMOC, with: [selfUser, teamUser1])
+        XCTAssertEqual(uiMOC.availabilityBroadcastRoster.knownTeamMembers.users, [teamUser1])
+
+        // when
+        conversation.addParticipantsAndUpdateConversationState(users: [teamUser2, teamUser3], role: nil)
+
+        // then
+        let expected = [teamUser1, teamUser2, teamUser3].sorted {
+            $0.remoteIdentifier.transportString() < $1.remoteIdentifier.transportString()
+        }
+        XCTAssertEqual(uiMOC.availabilityBroadcastRoster.knownTeamMembers.users, expected)
+        XCTAssertEqual(Set(uiMOC.availabilityBroadcastRoster.knownTeamMembers.users), ZMUser.knownTeamMembers(in: uiMOC))
+    }
+
+    func testThatTheBroadcastRosterDropsTeamMembersLeavingTheConversationsOfTheSelfUser() {
+        // given
+        let selfUserTeam = createTeam(in: uiMOC)
+        createMembership(in: uiMOC, user: selfUser, team: selfUserTeam)
+
+        let (teamUser1, _) = createUserAndAddMember(to: selfUserTeam)
+        let (teamUser2, _) = createUserAndAddMember(to: selfUserTeam)
+
+        let conversation = createConversation(in: uiMOC, with: [selfUser, teamUser1, teamUser2])
+        XCTAssertEqual(Set(uiMOC.availabilityBroadcastRoster.knownTeamMembers.users), [teamUser1, teamUser2])
+
+        // when
+        conversation.removeParticipantAndUpdateConversationState(user: teamUser2)
+
+        // then
+        XCTAssertEqual(uiMOC.availabilityBroadcastRoster.knownTeamMembers.users, [teamUser1])
+    }
+
+    func testThatTheBroadcastRosterIsUpdatedWhenAConnectionIsAccepted() {
+        // given
+        let selfUserTeam = createTeam(in: uiMOC)
+        createMembership(in: uiMOC, user: selfUser, team: selfUserTeam)
+
+        let otherTeam = createTeam(in: uiMOC)
+        let (otherTeamUser, _) = createUserAndAddMember(to: otherTeam)
+        let connection = ZMConnection.insertNewSentConnection(to: otherTeamUser)
+        connection.status = .pending
+        XCTAssertEqual(uiMOC.availabilityBroadcastRoster.knownTeamUsers.users, [])
+
+        // when
+        connection.status = .accepted
+
+        // then
+        XCTAssertEqual(uiMOC.availabilityBroadcastRoster.knownTeamUsers.users, [otherTeamUser])
+    }
+
 }
 
 // MARK: - Bot support
@@ -1232,6 +1232,27 @@ static NSString *const ImageSmallProfileDataKey = @"imageSmallProfileData";
     XCTAssertEqualObjects(user.keysThatHaveLocalModifications, expectedChangedKeys);
 }
 
+- (void)testThatModifiedDataFieldsAreTrackedPerUserWhenSavedTogether
+{
+    // given
+    ZMUser *user = [ZMUser insertNewObjectInManagedObjectContext:self.uiMOC];
+    ZMUser<ZMEditableUser> *selfUser = [ZMUser selfUserInContext:self.uiMOC];
+    user.name = @"Test";
+    selfUser.name = @"Self";
+    XCTAssertTrue([self.uiMOC saveOrRollback]);
+    
+    // when
+    user.name = @"Other";
+    user.accentColorValue = ZMAccentColorBrightOrange;
+    selfUser.accentColorValue = ZMAccentColorBrightOrange;
+    XCTAssertTrue([self.uiMOC saveOrRollback]);
+    
+    // then
+    XCTAssertEqualObjects(user.keysThatHaveLocalModifications, [NSSet set]);
+    NSSet *expectedChangedKeys = [NSSet setWithObjects:@"name", @"accentColorValue", nil];
+    XCTAssertEqualObjects(selfUser.keysThatHaveLocalModifications, expectedChangedKeys);
+}
+
 - (void)testThatSpecialKeysAreNotPartOfTheLocallyModifiedKeys
 {
     // when
@@ -78,3 +78,50 @@ extension ZMCallStateTests {
         XCTAssertTrue(syncSut.isIgnoringCall)
     }
 }
+
+// Propagation across contexts
+
+extension ZMCallStateTests {
+
+    func testThatCallStateChangesReachTheSyncContextWithoutSaving() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        uiMOC.saveOrRollback()
+
+        // when
+        conversation.isIgnoringCall = true
+        conversation.isCallDeviceActive = true
+        XCTAssertFalse(uiMOC.zm_hasChanges)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then
+        syncMOC.performGroupedBlockAndWait {
+            let syncConversation = try! self.syncMOC.existingObject(with: conversation.objectID) as! ZMConversation
+            XCTAssertTrue(syncConversation.isIgnoringCall)
+            XCTAssertTrue(syncConversation.isCallDeviceActive)
+        }
+    }
+
+    func testThatCallStateChangesAreNotAppliedTwice() {
+        // given
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        uiMOC.saveOrRollback()
+        conversation.isIgnoringCall = true
+
+        // when
+        syncMOC.performGroupedBlockAndWait {
+            self.syncMOC.mergeCallStateChanges(fromUserInfo: self.uiMOC.userInfo.asDictionary() as! [String: Any])
+            let syncConversation = try! self.syncMOC.existingObject(with: conversation.objectID) as! ZMConversation
+            XCTAssertTrue(syncConversation.isIgnoringCall)
+            syncConversation.isIgnoringCall = false
+        }
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then the scheduled pull finds the journal empty
+        syncMOC.performGroupedBlockAndWait {
+            let syncConversation = try! self.syncMOC.existingObject(with: conversation.objectID) as! ZMConversation
+            XCTAssertFalse(syncConversation.isIgnoringCall)
+        }
+    }
+
+}
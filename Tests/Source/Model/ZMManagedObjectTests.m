@@ -266,6 +266,54 @@
     XCTAssertEqualObjects(expectedKeys, keysWithLocalModifications);
 }
 
+- (void)testThatItAddsKeysChangedByLaterSavesToTheLocalChanges
+{
+    // given
+    [self.testMOC markAsUIContext];
+    __block MockEntity *mockEntity;
+    [self.testMOC performGroupedBlockThenWaitForReasonableTimeout:^{
+        mockEntity = [MockEntity insertNewObjectInManagedObjectContext:self.testMOC];
+        mockEntity.field = 1;
+        [self.testMOC save:nil];
+    }];
+
+    // when
+    __block NSSet *keysAfterSameKeyChanged;
+    __block NSSet *keysAfterIgnoredKeyChanged;
+    __block NSSet *keysAfterOtherKeyChanged;
+    [self.testMOC performGroupedBlockThenWaitForReasonableTimeout:^{
+        mockEntity.field = 2;
+        [self.testMOC save:nil];
+        keysAfterSameKeyChanged = mockEntity.keysThatHaveLocalModifications;
+
+        mockEntity.needsToBeUpdatedFromBackend = YES;
+        [self.testMOC save:nil];
+        keysAfterIgnoredKeyChanged = mockEntity.keysThatHaveLocalModifications;
+
+        mockEntity.field2 = @"Joe Doe";
+        [self.testMOC save:nil];
+        keysAfterOtherKeyChanged = mockEntity.keysThatHaveLocalModifications;
+    }];
+
+    // then
+    XCTAssertEqualObjects(keysAfterSameKeyChanged, [NSSet setWithObject:@"field"]);
+    XCTAssertEqualObjects(keysAfterIgnoredKeyChanged, [NSSet setWithObject:@"field"]);
+    XCTAssertEqualObjects(keysAfterOtherKeyChanged, ([NSSet setWithObjects:@"field", @"field2", nil]));
+}
+
+- (void)testThatObjectsOfAnEntityShareTheTrackedKeys
+{
+    // given
+    MockEntity *mockEntity1 = [MockEntity insertNewObjectInManagedObjectContext:self.testMOC];
+    MockEntity *mockEntity2 = [MockEntity insertNewObjectInManagedObjectContext:self.testMOC];
+
+    // then
+    XCTAssertEqual(mockEntity1.keysTrackedForLocalModifications, mockEntity2.keysTrackedForLocalModifications);
+    XCTAssertTrue([mockEntity1.keysTrackedForLocalModifications containsObject:@"field"]);
+    XCTAssertFalse([mockEntity1.keysTrackedForLocalModifications containsObject:@"needsToBeUpdatedFromBackend"]);
+    XCTAssertFalse([mockEntity1.keysTrackedForLocalModifications containsObject:@"modifiedKeys"]);
+}
+
 - (void)testThatChangesInSyncContextAreNotPersisted
 {
     // given
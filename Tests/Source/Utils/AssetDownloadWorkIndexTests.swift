@@ -0,0 +1,123 @@
+//
+// Wire
+// Copyright (C) 2020 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class AssetDownloadWorkIndexTests: ZMBaseManagedObjectTest {
+
+    private func createUser(previewAssetIdentifier: String?, completeAssetIdentifier: String?) -> ZMUser {
+        let user = ZMUser.insertNewObject(in: uiMOC)
+        user.remoteIdentifier = UUID()
+        user.previewProfileAssetIdentifier = previewAssetIdentifier
+        user.completeProfileAssetIdentifier = completeAssetIdentifier
+        return user
+    }
+
+    func testThatItListsUsersUntilTheirImagesAreStored() {
+        // given
+        let user = createUser(previewAssetIdentifier: "preview", completeAssetIdentifier: "complete")
+        _ = createUser(previewAssetIdentifier: nil, completeAssetIdentifier: "not+valid+id")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [user])
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .complete, in: uiMOC), [user])
+
+        // when
+        user.setImage(data: Data("preview".utf8), size: .preview)
+
+        // then
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [])
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .complete, in: uiMOC), [user])
+        XCTAssertFalse(ZMUser.previewImageDownloadFilter.evaluate(with: user))
+        XCTAssertTrue(ZMUser.completeImageDownloadFilter.evaluate(with: user))
+    }
+
+    func testThatItListsUsersAgainWhenTheirAssetIdentifierChanges() {
+        // given
+        let user = createUser(previewAssetIdentifier: "preview", completeAssetIdentifier: nil)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        user.setImage(data: Data("preview".utf8), size: .preview)
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [])
+
+        // when
+        user.previewProfileAssetIdentifier = "new-preview"
+
+        // then
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [user])
+    }
+
+    func testThatItListsUsersAgainWhenTheCacheDropsTheirImages() {
+        // given
+        let user = createUser(previewAssetIdentifier: "preview", completeAssetIdentifier: "complete")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        user.setImage(data: Data("preview".utf8), size: .preview)
+        user.setImage(data: Data("complete".utf8), size: .complete)
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .complete, in: uiMOC), [])
+
+        // when
+        uiMOC.zm_userImageCache.removeAllUserImages(user)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [user])
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .complete, in: uiMOC), [user])
+    }
+
+    func testThatItListsUsersWhichAreNotSavedYet() {
+        // when
+        let user = createUser(previewAssetIdentifier: "preview", completeAssetIdentifier: nil)
+
+        // then
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [user])
+        XCTAssertTrue(ZMUser.previewImageDownloadFilter.evaluate(with: user))
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(ZMUser.usersWithPendingImageDownload(size: .preview, in: uiMOC), [user])
+    }
+
+    func testThatItListsTeamsUntilTheirLogoIsStored() {
+        // given
+        let team = Team.insertNewObject(in: uiMOC)
+        team.remoteIdentifier = UUID()
+        team.pictureAssetId = "logo"
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(Team.teamsWithPendingLogoDownload(in: uiMOC), [team])
+        XCTAssertTrue(Team.imageDownloadFilter.evaluate(with: team))
+
+        // when
+        team.imageData = Data("logo".utf8)
+
+        // then
+        XCTAssertEqual(Team.teamsWithPendingLogoDownload(in: uiMOC), [])
+        XCTAssertFalse(Team.imageDownloadFilter.evaluate(with: team))
+
+        // when
+        team.pictureAssetId = "new-logo"
+
+        // then
+        XCTAssertEqual(Team.teamsWithPendingLogoDownload(in: uiMOC), [team])
+    }
+
+}
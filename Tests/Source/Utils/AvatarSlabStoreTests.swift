@@ -0,0 +1,155 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class AvatarSlabStoreTests: XCTestCase {
+
+    var fileURL: URL!
+    var sut: AvatarSlabStore!
+
+    override func setUp() {
+        super.setUp()
+        fileURL = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString)
+            .appendingPathComponent("avatars.slab")
+        sut = AvatarSlabStore(fileURL: fileURL, byteLimit: 10_000, memoryCostLimit: 1_000)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: fileURL.deletingLastPathComponent())
+        sut = nil
+        fileURL = nil
+        super.tearDown()
+    }
+
+    private func reopen() {
+        sut = AvatarSlabStore(fileURL: fileURL, byteLimit: 10_000, memoryCostLimit: 1_000)
+    }
+
+    func testThatItStoresAndReadsBackData() {
+        // when
+        sut.set(Data("foo".utf8), forKey: "a")
+        sut.set(Data("bar".utf8), forKey: "b")
+
+        // then
+        XCTAssertEqual(sut.data(forKey: "a"), Data("foo".utf8))
+        XCTAssertEqual(sut.data(forKey: "b"), Data("bar".utf8))
+        XCTAssertNil(sut.data(forKey: "c"))
+    }
+
+    func testThatItRebuildsTheIndexFromTheSlab() {
+        // given
+        sut.set(Data("foo".utf8), forKey: "a")
+        sut.set(Data("bar".utf8), forKey: "b")
+        sut.set(Data("baz".utf8), forKey: "a")
+        sut.removeData(forKey: "b")
+
+        // when
+        reopen()
+
+        // then
+        XCTAssertEqual(sut.data(forKey: "a"), Data("baz".utf8))
+        XCTAssertFalse(sut.contains(key: "b"))
+        XCTAssertNil(sut.data(forKey: "b"))
+    }
+
+    func testThatItIgnoresATruncatedRecord() throws {
+        // given
+        sut.set(Data("foo".utf8), forKey: "a")
+        sut.set(Data(repeating: 1, count: 100), forKey: "b")
+        let handle = try XCTUnwrap(FileHandle(forWritingAtPath: fileURL.path))
+        handle.truncateFile(atOffset: handle.seekToEndOfFile() - 10)
+        handle.closeFile()
+
+        // when
+        reopen()
+        sut.set(Data("bar".utf8), forKey: "c")
+        reopen()
+
+        // then
+        XCTAssertEqual(sut.data(forKey: "a"), Data("foo".utf8))
+        XCTAssertNil(sut.data(forKey: "b"))
+        XCTAssertEqual(sut.data(forKey: "c"), Data("bar".utf8))
+    }
+
+    func testThatPrefetchLoadsAllImagesIntoMemory() {
+        // given
+        let keys = (0..<10).map { "key-\($0)" }
+        keys.forEach { sut.set(Data($0.utf8), forKey: $0) }
+        reopen()
+
+        // when
+        let prefetched = expectation(description: "prefetched")
+        sut.prefetch(keys: keys) { prefetched.fulfill() }
+        wait(for: [prefetched], timeout: 0.5)
+        try? FileManager.default.removeItem(at: fileURL)
+
+        // then
+        keys.forEach { XCTAssertEqual(sut.data(forKey: $0), Data($0.utf8)) }
+    }
+
+    func testThatItKeepsTheNewestImagesWhenCompacting() throws {
+        // given
+        let image = Data(repeating: 1, count: 1_000)
+
+        // when
+        (0..<20).forEach { sut.set(image, forKey: "key-\($0)") }
+        sut.queue.sync {}
+        reopen()
+
+        // then
+        let attributes = try FileManager.default.attributesOfItem(atPath: fileURL.path)
+        XCTAssertLessThanOrEqual((attributes[.size] as? NSNumber)?.intValue ?? .max, 10_000)
+        XCTAssertEqual(sut.data(forKey: "key-19"), image)
+        XCTAssertNil(sut.data(forKey: "key-0"))
+    }
+
+    func testThatItReportsTheImagesDroppedWhenCompacting() {
+        // given
+        let image = Data(repeating: 1, count: 1_000)
+        var evictedKeys: Set<String> = []
+        sut.addEvictionHandler(for: self) { evictedKeys.formUnion($0) }
+
+        // when
+        (0..<20).forEach { sut.set(image, forKey: "key-\($0)") }
+        sut.queue.sync {}
+
+        // then
+        XCTAssertTrue(evictedKeys.contains("key-0"))
+        XCTAssertFalse(evictedKeys.contains("key-19"))
+        evictedKeys.forEach { XCTAssertFalse(sut.contains(key: $0)) }
+    }
+
+    func testThatStoresAreSharedByFileURL() {
+        // given
+        let store1 = AvatarSlabStore.store(for: fileURL, byteLimit: 10_000, memoryCostLimit: 1_000)
+        let store2 = AvatarSlabStore.store(for: fileURL, byteLimit: 10_000, memoryCostLimit: 1_000)
+
+        // when
+        store1.set(Data("foo".utf8), forKey: "a")
+        store2.set(Data("bar".utf8), forKey: "b")
+
+        // then
+        XCTAssertTrue(store1 === store2)
+        XCTAssertEqual(store1.data(forKey: "a"), Data("foo".utf8))
+        XCTAssertEqual(store1.data(forKey: "b"), Data("bar".utf8))
+    }
+
+}
@@ -0,0 +1,99 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class InstrumentationTests: ZMBaseManagedObjectTest {
+
+    var sut: InstrumentationRecorder!
+
+    override func setUp() {
+        super.setUp()
+        sut = InstrumentationRecorder()
+        Instrumentation.sink = sut
+    }
+
+    override func tearDown() {
+        Instrumentation.sink = nil
+        sut = nil
+        super.tearDown()
+    }
+
+    func testThatItCountsFetchesAndRowsPerEntity() {
+        // given
+        ZMUser.insertNewObject(in: uiMOC)
+        ZMUser.insertNewObject(in: uiMOC)
+        ZMConversation.insertNewObject(in: uiMOC)
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        sut.reset()
+
+        // when
+        _ = uiMOC.fetchOrAssert(request: NSFetchRequest<ZMUser>(entityName: ZMUser.entityName()))
+        _ = uiMOC.fetchOrAssert(request: NSFetchRequest<ZMConversation>(entityName: ZMConversation.entityName()))
+
+        // then
+        XCTAssertEqual(sut.count(of: .fetches), 2)
+        XCTAssertEqual(sut.count(of: .fetches, entity: ZMUser.entityName()), 1)
+        XCTAssertEqual(sut.count(of: .rowsReturned, entity: ZMUser.entityName()), 3) // including the self user
+        XCTAssertEqual(sut.count(of: .rowsReturned, entity: ZMConversation.entityName()), 1)
+        XCTAssertEqual(sut.histogram(of: .fetch).count, 2)
+    }
+
+    func testThatItRecordsSaves() {
+        // given
+        ZMConversation.insertNewObject(in: uiMOC)
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(sut.histogram(of: .save).count, 1)
+    }
+
+    func testThatItRecordsNothingWhenDisabled() {
+        // given
+        Instrumentation.sink = nil
+        ZMConversation.insertNewObject(in: uiMOC)
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        _ = uiMOC.fetchOrAssert(request: NSFetchRequest<ZMConversation>(entityName: ZMConversation.entityName()))
+
+        // then
+        XCTAssertEqual(sut.count(of: .fetches), 0)
+        XCTAssertEqual(sut.histogram(of: .save).count, 0)
+    }
+
+    func testThatHistogramPercentilesAreUpperBounds() {
+        // given
+        let durations: [TimeInterval] = [0.000_01, 0.000_02, 0.001, 0.002, 0.5]
+
+        // when
+        durations.forEach { sut.record(.mergeChanges, entity: nil, duration: $0) }
+
+        // then
+        let histogram = sut.histogram(of: .mergeChanges)
+        XCTAssertEqual(histogram.count, durations.count)
+        XCTAssertEqual(histogram.maximum, 0.5)
+        XCTAssertGreaterThanOrEqual(histogram.percentile(0.5), 0.001)
+        XCTAssertLessThan(histogram.percentile(0.5), 0.5)
+        XCTAssertEqual(histogram.percentile(1), 0.5)
+    }
+
+}
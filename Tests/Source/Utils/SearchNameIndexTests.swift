@@ -0,0 +1,207 @@
+//
+// Wire
+// Copyright (C) 2021 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+@testable import WireDataModel
+
+final class SearchNameIndexTests: ModelObjectsTests {
+
+    func testThatItMatchesUsersByWordPrefix() {
+        // given
+        let user1 = ZMUser.insert(in: uiMOC, name: "Some body", handle: "ab")
+        let user2 = ZMUser.insert(in: uiMOC, name: "No body", handle: "yes-b")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // when
+        let sut = uiMOC.searchNameIndex
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "bo", in: [.userName]), [user1.objectID, user2.objectID])
+        XCTAssertEqual(sut.objectIDs(matching: "so bo", in: [.userName]), [user1.objectID])
+        XCTAssertEqual(sut.objectIDs(matching: "ody", in: [.userName]), [])
+        XCTAssertEqual(sut.objectIDs(withTokenPrefix: "ye", in: .userHandle), [user2.objectID])
+    }
+
+    func testThatItMatchesAtWordBoundariesInsideAWord() {
+        // given
+        let user = ZMUser.insert(in: uiMOC, name: "Shaquille O'Neil")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let all = NSArray(array: [user])
+
+        // when
+        let sut = uiMOC.searchNameIndex
+
+        // then
+        for query in ["neil", "o'ne", "o"] {
+            XCTAssertEqual(sut.objectIDs(matching: query, in: [.userName]), [user.objectID], "Mismatch for query: \(query)")
+            XCTAssertEqual(all.filtered(using: ZMUser.predicateForAllUsers(withSearch: query)).count, 1, "Mismatch for query: \(query)")
+        }
+        XCTAssertEqual(sut.objectIDs(matching: "eil", in: [.userName]), [])
+    }
+
+    func testThatItIndexesUsersInsertedAfterItWasBuilt() {
+        // given
+        let sut = uiMOC.searchNameIndex
+
+        // when
+        let user = ZMUser.insert(in: uiMOC, name: "Šőmė body")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "some", in: [.userName]), [user.objectID])
+    }
+
+    func testThatItUpdatesTheIndexWhenAUserIsRenamed() {
+        // given
+        let user = ZMUser.insert(in: uiMOC, name: "Some body")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let sut = uiMOC.searchNameIndex
+
+        // when
+        user.name = "Other person"
+        uiMOC.processPendingChanges()
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "some", in: [.userName]), [])
+        XCTAssertEqual(sut.objectIDs(matching: "pers", in: [.userName]), [user.objectID])
+    }
+
+    func testThatItRemovesDeletedUsers() {
+        // given
+        let user = ZMUser.insert(in: uiMOC, name: "Some body")
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let sut = uiMOC.searchNameIndex
+
+        // when
+        uiMOC.delete(user)
+        uiMOC.processPendingChanges()
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "some", in: [.userName]), [])
+    }
+
+    func testThatItIndexesUsersSavedByAnotherContext() {
+        // given
+        let sut = uiMOC.searchNameIndex
+        var objectID: NSManagedObjectID!
+
+        // when
+        syncMOC.performGroupedBlockAndWait {
+            let user = ZMUser.insert(in: self.syncMOC, name: "Some body")
+            XCTAssertTrue(self.syncMOC.saveOrRollback())
+            objectID = user.objectID
+        }
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "some", in: [.userName]), [objectID])
+        XCTAssertNil(uiMOC.registeredObject(for: objectID))
+
+        // when
+        syncMOC.performGroupedBlockAndWait {
+            let user = self.syncMOC.object(with: objectID) as! ZMUser
+            user.name = "Other person"
+            XCTAssertTrue(self.syncMOC.saveOrRollback())
+        }
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "some", in: [.userName]), [])
+        XCTAssertEqual(sut.objectIDs(matching: "pers", in: [.userName]), [objectID])
+    }
+
+    func testThatItAppliesTheChangesOfASaveInOneBatch() {
+        // given
+        let sut = uiMOC.searchNameIndex
+        let users = (0..<10).map { ZMUser.insert(in: uiMOC, name: "User \(9 - $0) Name") }
+
+        // when
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // then
+        XCTAssertEqual(sut.objectIDs(matching: "name", in: [.userName]), Set(users.map(\.objectID)))
+        XCTAssertEqual(sut.objectIDs(matching: "7", in: [.userName]), [users[2].objectID])
+    }
+
+    func testThatIndexedUserPredicateMatchesRegularExpressionPredicate() {
+        // given
+        let users = [
+            ZMUser.insert(in: uiMOC, name: "Some body", handle: "ab"),
+            ZMUser.insert(in: uiMOC, name: "No body", handle: "no-b"),
+            ZMUser.insert(in: uiMOC, name: "Yes body", handle: "yes-b", connectionStatus: .pending),
+            ZMUser.insert(in: uiMOC, name: "Šőmė one", handle: "hand")
+        ]
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let all = NSArray(array: users)
+
+        for query in ["body", "some", "so bo", "@ab", "ye", "nothing"] {
+            // when
+            let expected = all.filtered(using: ZMUser.predicateForConnectedUsers(withSearch: query)) as! [ZMUser]
+            let indexed = all.filtered(using: ZMUser.predicateForUsers(withSearch: query,
+                                                                        connectionStatuses: [ZMConnectionStatus.accepted.rawValue],
+                                                                        in: uiMOC)) as! [ZMUser]
+
+            // then
+            XCTAssertEqual(Set(indexed), Set(expected), "Mismatch for query: \(query)")
+        }
+    }
+
+    func testThatIndexedConversationPredicateMatchesConversationName() {
+        // given
+        let selfUser = ZMUser.selfUser(in: uiMOC)
+        let otherUser = ZMUser.insert(in: uiMOC, name: "Other user")
+        let conversation1 = ZMConversation.insertGroupConversation(moc: uiMOC, participants: [otherUser], name: "Wire Office")!
+        let conversation2 = ZMConversation.insertGroupConversation(moc: uiMOC, participants: [otherUser], name: "Lunch")!
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // when
+        let predicate = ZMConversation.predicate(forSearchQuery: "off", selfUser: selfUser, in: uiMOC)
+
+        // then
+        XCTAssertTrue(predicate.evaluate(with: conversation1))
+        XCTAssertFalse(predicate.evaluate(with: conversation2))
+    }
+
+    func testThatIndexedUserPredicateFallsBackToRegularExpressions_WhenThereAreTooManyMatches() {
+        // given
+        let users = (0...SearchNameIndex.maximumPredicateMatchCount).map { ZMUser.insert(in: uiMOC, name: "User \($0)") }
+        XCTAssertTrue(uiMOC.saveOrRollback())
+
+        // when
+        let predicate = ZMUser.predicateForUsers(withSearch: "user", connectionStatuses: nil, in: uiMOC)
+
+        // then
+        XCTAssertFalse(predicate.predicateFormat.contains(" IN "))
+        XCTAssertTrue(users.allSatisfy { predicate.evaluate(with: $0) })
+    }
+
+    func testPerformanceOfQueryingIndex() {
+        // given
+        for index in 0..<5_000 {
+            ZMUser.insert(in: uiMOC, name: "User \(index) Name\(index % 100)")
+        }
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        let sut = uiMOC.searchNameIndex
+
+        measure {
+            // when
+            _ = sut.objectIDs(matching: "name4 us", in: [.userName])
+        }
+    }
+
+}